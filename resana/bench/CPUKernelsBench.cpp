@@ -0,0 +1,109 @@
+#include "rspch.h"
+#include "system/cpu/CPUKernels.h"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+/*
+ * Times one sample's worth of kernel work (loads, states and summary) for
+ * every instruction set the processor can run, from a laptop to the largest
+ * servers. Counters are synthetic, advancing like a 10ms tick of mixed load.
+ */
+
+using namespace RESANA;
+
+namespace
+{
+	constexpr size_t CORE_COUNTS[] = { 8, 64, 256, 1024 };
+	constexpr int WARMUP_TICKS = 1000;
+	constexpr int MIN_TICKS = 20000;
+
+	struct Sample
+	{
+		std::array<std::vector<uint64_t>, CpuField_Count> Fields{};
+
+		CoreCounters GetCounters() const
+		{
+			CoreCounters counters;
+			for (int field = 0; field < CpuField_Count; field++) {
+				counters.Fields[field] = Fields[field].data();
+			}
+			return counters;
+		}
+	};
+
+	double TimeTicks(const size_t cores)
+	{
+		std::mt19937_64 random(cores);
+		std::uniform_int_distribution<uint64_t> start(0, 1ull << 40);
+		std::uniform_int_distribution<uint64_t> advance(0, 10);
+
+		Sample last, current;
+		for (int field = 0; field < CpuField_Count; field++) {
+			last.Fields[field].resize(cores);
+			current.Fields[field].resize(cores);
+			for (size_t core = 0; core < cores; core++) {
+				last.Fields[field][core] = start(random);
+				current.Fields[field][core] = last.Fields[field][core] + advance(random);
+			}
+		}
+
+		std::vector<double> loads(cores);
+		std::array<std::vector<double>, CpuState_Count> stateArrays{};
+		CoreStates states;
+		for (int state = 0; state < CpuState_Count; state++) {
+			stateArrays[state].resize(cores);
+			states.States[state] = stateArrays[state].data();
+		}
+
+		const CoreCounters lastCounters = last.GetCounters();
+		const CoreCounters currentCounters = current.GetCounters();
+		double sink = 0.0;
+		const auto tick = [&] {
+			CPUKernels::ComputeLoads(lastCounters, currentCounters, cores, loads.data());
+			CPUKernels::ComputeStates(lastCounters, currentCounters, cores, states);
+			sink += CPUKernels::Summarize(loads.data(), cores).Average;
+		};
+
+		for (int i = 0; i < WARMUP_TICKS; i++) {
+			tick();
+		}
+
+		const int ticks = std::max<int>(MIN_TICKS, (int)(MIN_TICKS * 64 / cores));
+		const auto begin = std::chrono::steady_clock::now();
+		for (int i = 0; i < ticks; i++) {
+			tick();
+		}
+		const auto elapsed = std::chrono::steady_clock::now() - begin;
+
+		// Keeps the loop from being optimised away
+		if (sink < 0.0) {
+			std::printf("%f\n", sink);
+		}
+		return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / ticks;
+	}
+}
+
+int main()
+{
+	const std::vector<const char*> sets = CPUKernels::GetInstructionSets();
+
+	std::printf("%8s", "cores");
+	for (const char* set : sets) {
+		std::printf("%12s", set);
+	}
+	std::printf("    (ns per tick)\n");
+
+	for (const size_t cores : CORE_COUNTS) {
+		std::printf("%8zu", cores);
+		for (const char* set : sets) {
+			CPUKernels::SetInstructionSet(set);
+			std::printf("%12.0f", TimeTicks(cores));
+		}
+		std::printf("\n");
+	}
+	return 0;
+}
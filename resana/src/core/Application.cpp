@@ -5,6 +5,7 @@
 #include "Core.h"
 #include "Log.h"
 
+#include "system/SelfProfiler.h"
 #include "system/ThreadPool.h"
 
 namespace RESANA {
@@ -49,9 +50,12 @@ namespace RESANA {
 	void Application::Run()
 	{
 		Timestep ts;
+		SelfProfiler::NameThread("Main");
 
 		while (mRunning)
 		{
+			SelfProfiler::Scope scope(Subsystem_UI);
+
 			// Check if window has been closed
 			mRunning = !glfwWindowShouldClose((GLFWwindow*)mWindow->GetNativeWindow());
 
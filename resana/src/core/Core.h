@@ -1,9 +1,17 @@
 #pragma once
 
+#if defined(_WIN32)
+#define RS_PLATFORM_WINDOWS
+#elif defined(__linux__)
+#define RS_PLATFORM_LINUX
+#endif
+
 #if defined(__clang__)
 #define DEBUG_BREAK __builtin_debugtrap()
 #elif defined(_MSC_VER)
 #define DEBUG_BREAK __debugbreak()
+#elif defined(__GNUC__)
+#define DEBUG_BREAK __builtin_trap()
 #endif
 
 #if defined(RS_ENABLE_ASSERTS)
@@ -1,7 +1,6 @@
 #pragma once
 
 #include <string>
-#include <tchar.h>
 
 namespace RESANA {
 
@@ -0,0 +1,167 @@
+#include "rspch.h"
+#include "MetricHistory.h"
+
+namespace RESANA {
+
+	namespace
+	{
+		uint8_t ToHalfPercent(const float value)
+		{
+			return (uint8_t)std::lround(std::clamp(value, 0.0f, 100.0f) * 2.0f);
+		}
+	}
+
+	MetricHistory::MetricHistory(const size_t series, const HistoryPrecision precision)
+		: mPrecision(precision)
+	{
+		Resize(series);
+	}
+
+	void MetricHistory::Resize(const size_t series)
+	{
+		std::scoped_lock lock(mMutex);
+		mSeries = series;
+		for (int tier = 0; tier < HistoryTier_Count; tier++)
+		{
+			auto& ring = mRings[tier];
+			const size_t size = TIERS[tier].Capacity * series;
+			ring.Points.assign(mPrecision == HistoryPrecision_Full ? size : 0, HistoryPoint{});
+			ring.Percents.assign(mPrecision == HistoryPrecision_Percent ? size : 0, PercentPoint{});
+			ring.Newest = -1;
+		}
+	}
+
+	size_t MetricHistory::GetSeriesCount() const
+	{
+		std::scoped_lock lock(mMutex);
+		return mSeries;
+	}
+
+	void MetricHistory::Append(const Clock::time_point time, const float* values)
+	{
+		const int64_t seconds = std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+
+		std::scoped_lock lock(mMutex);
+		for (int tier = 0; tier < HistoryTier_Count; tier++)
+		{
+			auto& ring = mRings[tier];
+			const int64_t bucket = seconds / TIERS[tier].Period;
+			if (bucket < ring.Newest) { continue; } // Late for a bucket already closed
+			Advance(ring, TIERS[tier], bucket);
+
+			const size_t offset = (size_t)(bucket % TIERS[tier].Capacity) * mSeries;
+			if (mPrecision == HistoryPrecision_Percent)
+			{
+				PercentPoint* points = &ring.Percents[offset];
+				for (size_t series = 0; series < mSeries; series++)
+				{
+					if (std::isnan(values[series])) { continue; }
+
+					auto& point = points[series];
+					const uint8_t value = ToHalfPercent(values[series]);
+					if (point.Samples == 0)
+					{
+						point = { value, value, value, value, 1 };
+						continue;
+					}
+					point.Min = std::min(point.Min, value);
+					point.Max = std::max(point.Max, value);
+					point.Last = value;
+					if (point.Samples < UINT8_MAX)
+					{
+						point.Sum += value;
+						point.Samples++;
+					}
+				}
+				continue;
+			}
+
+			// The open bucket is updated in place, its average as a running mean
+			HistoryPoint* points = &ring.Points[offset];
+			for (size_t series = 0; series < mSeries; series++)
+			{
+				const float value = values[series];
+				if (std::isnan(value)) { continue; }
+
+				auto& point = points[series];
+				if (point.Samples++ == 0)
+				{
+					point = { value, value, value, value, 1 };
+					continue;
+				}
+				point.Min = std::min(point.Min, value);
+				point.Max = std::max(point.Max, value);
+				point.Average += (value - point.Average) / (float)point.Samples;
+				point.Last = value;
+			}
+		}
+	}
+
+	void MetricHistory::Advance(Ring& ring, const Tier& tier, const int64_t bucket)
+	{
+		if (bucket == ring.Newest) { return; }
+
+		// Buckets skipped since the last sample become gaps; past a whole ring, every bucket is stale
+		const int64_t first = ring.Newest < 0 ? bucket : std::max(ring.Newest + 1, bucket - (int64_t)tier.Capacity + 1);
+		for (int64_t stale = first; stale <= bucket; stale++)
+		{
+			const size_t offset = (size_t)(stale % tier.Capacity) * mSeries;
+			if (mPrecision == HistoryPrecision_Percent) {
+				std::fill_n(ring.Percents.begin() + (ptrdiff_t)offset, mSeries, PercentPoint{});
+			} else {
+				std::fill_n(ring.Points.begin() + (ptrdiff_t)offset, mSeries, HistoryPoint{});
+			}
+		}
+		ring.Newest = bucket;
+	}
+
+	HistoryPoint MetricHistory::GetPoint(const Ring& ring, const size_t index) const
+	{
+		if (mPrecision == HistoryPrecision_Full) {
+			return ring.Points[index];
+		}
+
+		const auto& point = ring.Percents[index];
+		if (!point.Samples) { return {}; }
+		return { point.Min / 2.0f, point.Max / 2.0f, (float)point.Sum / point.Samples / 2.0f, point.Last / 2.0f, point.Samples };
+	}
+
+	void MetricHistory::Read(const HistoryTier tier, const size_t series, size_t count, std::vector<HistoryPoint>& points) const
+	{
+		points.clear();
+
+		std::scoped_lock lock(mMutex);
+		const auto& ring = mRings[tier];
+		if (ring.Newest < 0 || series >= mSeries) { return; }
+
+		// Buckets before the first sample hold nothing worth returning
+		const uint32_t capacity = TIERS[tier].Capacity;
+		count = std::min({ count, (size_t)capacity, (size_t)(ring.Newest + 1) });
+		points.resize(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			const int64_t bucket = ring.Newest - (int64_t)(count - 1 - i);
+			points[i] = GetPoint(ring, (size_t)(bucket % capacity) * mSeries + series);
+		}
+	}
+
+	HistoryPoint MetricHistory::GetLatest(const HistoryTier tier, const size_t series) const
+	{
+		std::scoped_lock lock(mMutex);
+		const auto& ring = mRings[tier];
+		if (ring.Newest < 0 || series >= mSeries) { return {}; }
+		return GetPoint(ring, (size_t)(ring.Newest % TIERS[tier].Capacity) * mSeries + series);
+	}
+
+	HistoryTier MetricHistory::GetTier(const std::chrono::seconds span)
+	{
+		for (int tier = 0; tier < HistoryTier_Count; tier++)
+		{
+			if (span.count() <= (int64_t)TIERS[tier].Period * TIERS[tier].Capacity) {
+				return (HistoryTier)tier;
+			}
+		}
+		return (HistoryTier)(HistoryTier_Count - 1);
+	}
+
+}
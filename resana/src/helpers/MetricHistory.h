@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace RESANA {
+
+	// One bucket of a tier; a bucket without samples is a gap
+	struct HistoryPoint
+	{
+		float Min{};
+		float Max{};
+		float Average{};
+		float Last{};
+		uint32_t Samples{};
+	};
+
+	enum HistoryTier
+	{
+		HistoryTier_Second = 0, // 1 s buckets over 10 minutes
+		HistoryTier_TenSeconds, // 10 s buckets over 6 hours
+		HistoryTier_Minute,     // 1 min buckets over 7 days
+		HistoryTier_Count
+	};
+
+	enum HistoryPrecision
+	{
+		HistoryPrecision_Full = 0, // Floats, 20 bytes a bucket
+		HistoryPrecision_Percent,  // 0-100 in half-percent steps, 6 bytes a bucket
+	};
+
+	/*
+	 * Fixed-size history of one or more series sampled together, such as the
+	 * load of every core. Each tier is a ring of buckets allocated up front,
+	 * about 250 KB per series in all, or 77 KB at percent precision, and every
+	 * sample is folded into the open bucket of each tier as it arrives, so
+	 * appending and locating a range are O(1) and nothing grows while the
+	 * program runs. Samples may come at any interval; buckets nothing fell into
+	 * are left as gaps.
+	 */
+	class MetricHistory {
+	public:
+		typedef std::chrono::steady_clock Clock;
+
+		struct Tier
+		{
+			uint32_t Period;   // Seconds per bucket
+			uint32_t Capacity; // Buckets
+		};
+		static constexpr Tier TIERS[HistoryTier_Count] = { { 1, 600 }, { 10, 2160 }, { 60, 10080 } };
+
+		explicit MetricHistory(size_t series = 1, HistoryPrecision precision = HistoryPrecision_Full);
+
+		// Clears the history
+		void Resize(size_t series);
+		[[nodiscard]] size_t GetSeriesCount() const;
+
+		// One value per series; NaN leaves that series out of the sample
+		void Append(Clock::time_point time, const float* values);
+		void Append(Clock::time_point time, float value) { Append(time, &value); }
+
+		// The last count buckets of a series up to the newest, oldest first
+		void Read(HistoryTier tier, size_t series, size_t count, std::vector<HistoryPoint>& points) const;
+		[[nodiscard]] HistoryPoint GetLatest(HistoryTier tier, size_t series) const;
+
+		// The finest tier that covers the span
+		static HistoryTier GetTier(std::chrono::seconds span);
+
+	private:
+		// A bucket at percent precision, in half-percent steps; Sum stops growing
+		// once Samples saturates, so such a bucket averages its first 255 samples
+		struct PercentPoint
+		{
+			uint16_t Sum{};
+			uint8_t Min{};
+			uint8_t Max{};
+			uint8_t Last{};
+			uint8_t Samples{};
+		};
+
+		struct Ring
+		{
+			// Bucket-major: all series of a bucket are adjacent. Only the one of the precision is used
+			std::vector<HistoryPoint> Points{};
+			std::vector<PercentPoint> Percents{};
+			int64_t Newest = -1; // Bucket number since the clock's epoch
+		};
+
+		void Advance(Ring& ring, const Tier& tier, int64_t bucket);
+		[[nodiscard]] HistoryPoint GetPoint(const Ring& ring, size_t index) const;
+
+	private:
+		mutable std::mutex mMutex{};
+		const HistoryPrecision mPrecision;
+		size_t mSeries{};
+		Ring mRings[HistoryTier_Count]{};
+	};
+
+}
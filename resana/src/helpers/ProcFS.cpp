@@ -0,0 +1,208 @@
+#include "rspch.h"
+#include "ProcFS.h"
+
+#include "core/Core.h"
+
+#if defined(RS_PLATFORM_LINUX)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace RESANA {
+
+	long ProcFS::ReadFile(const char* path, char* buffer, size_t size)
+	{
+#if defined(RS_PLATFORM_LINUX)
+		const int fd = open(path, O_RDONLY | O_CLOEXEC);
+		if (fd < 0) { return -1; }
+
+		const long length = ReadFile(fd, buffer, size);
+		close(fd);
+		return length;
+#else
+		if (size) { buffer[0] = '\0'; }
+		return -1;
+#endif
+	}
+
+	long ProcFS::ReadFile(int fd, char* buffer, size_t size)
+	{
+		if (size == 0) { return -1; }
+
+#if defined(RS_PLATFORM_LINUX)
+		// pread() from offset 0 lets cached descriptors be re-read every tick
+		size_t length = 0;
+		while (length < size - 1)
+		{
+			const ssize_t count = pread(fd, buffer + length, size - 1 - length, (off_t)length);
+			if (count < 0)
+			{
+				if (errno == EINTR) { continue; }
+				buffer[0] = '\0';
+				return -1;
+			}
+			if (count == 0) { break; }
+			length += (size_t)count;
+		}
+
+		buffer[length] = '\0';
+		return (long)length;
+#else
+		buffer[0] = '\0';
+		return -1;
+#endif
+	}
+
+	long ProcFS::ReadFile(const char* path, std::vector<char>& buffer)
+	{
+#if defined(RS_PLATFORM_LINUX)
+		const int fd = open(path, O_RDONLY | O_CLOEXEC);
+		if (fd < 0) { return -1; }
+
+		if (buffer.size() < 4096) { buffer.resize(4096); }
+
+		// Pseudo files report a size of 0, so read until EOF and grow on demand
+		size_t length = 0;
+		while (true)
+		{
+			if (length == buffer.size() - 1) { buffer.resize(buffer.size() * 2); }
+
+			const ssize_t count = read(fd, buffer.data() + length, buffer.size() - 1 - length);
+			if (count < 0)
+			{
+				if (errno == EINTR) { continue; }
+				close(fd);
+				buffer[0] = '\0';
+				return -1;
+			}
+			if (count == 0) { break; }
+			length += (size_t)count;
+		}
+
+		close(fd);
+		buffer[length] = '\0';
+		return (long)length;
+#else
+		if (!buffer.empty()) { buffer[0] = '\0'; }
+		return -1;
+#endif
+	}
+
+	const char* ProcFS::SkipSpaces(const char* p)
+	{
+		while (*p == ' ' || *p == '\t') { ++p; }
+		return p;
+	}
+
+	const char* ProcFS::SkipFields(const char* p, int count)
+	{
+		p = SkipSpaces(p);
+		while (count-- > 0 && *p && *p != '\n')
+		{
+			while (*p && *p != ' ' && *p != '\t' && *p != '\n') { ++p; }
+			p = SkipSpaces(p);
+		}
+
+		return p;
+	}
+
+	const char* ProcFS::NextLine(const char* p)
+	{
+		while (*p && *p != '\n') { ++p; }
+		return *p ? p + 1 : p;
+	}
+
+	const char* ProcFS::ParseUInt64(const char* p, uint64_t& value)
+	{
+		p = SkipSpaces(p);
+		value = 0;
+		while (*p >= '0' && *p <= '9')
+		{
+			value = value * 10 + (uint64_t)(*p - '0');
+			++p;
+		}
+
+		return p;
+	}
+
+	const char* ProcFS::ParseInt64(const char* p, int64_t& value)
+	{
+		p = SkipSpaces(p);
+		const bool negative = (*p == '-');
+		if (negative) { ++p; }
+
+		uint64_t magnitude;
+		p = ParseUInt64(p, magnitude);
+		value = negative ? -(int64_t)magnitude : (int64_t)magnitude;
+		return p;
+	}
+
+	const char* ProcFS::SkipComm(const char* p)
+	{
+		// The command name may itself contain spaces and parentheses
+		const char* end = std::strrchr(p, ')');
+		return end ? SkipSpaces(end + 1) : p;
+	}
+
+	void ProcFS::ParseCpuList(const char* p, std::vector<uint32_t>& cpus)
+	{
+		while (*p >= '0' && *p <= '9')
+		{
+			uint64_t first = 0, last = 0;
+			p = ParseUInt64(p, first);
+			last = first;
+			if (*p == '-') {
+				p = ParseUInt64(p + 1, last);
+			}
+			for (uint64_t cpu = first; cpu <= last; cpu++) {
+				cpus.push_back((uint32_t)cpu);
+			}
+			if (*p == ',') { p++; }
+		}
+	}
+
+	bool ProcFS::IsNumeric(const char* name)
+	{
+		if (!name || !*name) { return false; }
+		for (; *name; ++name)
+		{
+			if (*name < '0' || *name > '9') { return false; }
+		}
+
+		return true;
+	}
+
+	uint64_t ProcFS::Checksum(const char* data, size_t length)
+	{
+		// FNV-1a, plenty to tell whether a mapping list changed
+		uint64_t hash = 14695981039346656037ull;
+		for (size_t i = 0; i < length; ++i)
+		{
+			hash ^= (uint8_t)data[i];
+			hash *= 1099511628211ull;
+		}
+
+		return hash;
+	}
+
+	uint64_t ProcFS::GetClockTicks()
+	{
+#if defined(RS_PLATFORM_LINUX)
+		static const uint64_t sTicks = []
+		{
+			const long ticks = sysconf(_SC_CLK_TCK);
+			return ticks > 0 ? (uint64_t)ticks : 100;
+		}();
+		return sTicks;
+#else
+		return 100;
+#endif
+	}
+
+	uint64_t ProcFS::TicksTo100ns(uint64_t ticks)
+	{
+		return ticks * (10000000 / GetClockTicks());
+	}
+
+}
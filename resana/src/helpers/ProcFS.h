@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace RESANA {
+
+	/*
+	 * Small allocation-free helpers for the Linux /proc and /sys pseudo files.
+	 * Files are read with a single read() into a caller-owned buffer and parsed
+	 * in place, so a collector can reuse one buffer for every tick.
+	 */
+	class ProcFS {
+	public:
+		// Returns the number of bytes read (buffer is NUL-terminated), or -1 on error
+		static long ReadFile(const char* path, char* buffer, size_t size);
+		static long ReadFile(int fd, char* buffer, size_t size);
+
+		// Grows the buffer as needed, for files without a size bound (maps, smaps)
+		static long ReadFile(const char* path, std::vector<char>& buffer);
+
+		static const char* SkipSpaces(const char* p);
+		static const char* SkipFields(const char* p, int count);
+		static const char* NextLine(const char* p);
+		static const char* ParseUInt64(const char* p, uint64_t& value);
+		static const char* ParseInt64(const char* p, int64_t& value);
+
+		// Skips past "pid (comm)" in a stat line; returns the field following it
+		static const char* SkipComm(const char* p);
+
+		// Appends the CPUs of a list such as "0-3,8-11", as in /sys/devices/system/cpu/online
+		static void ParseCpuList(const char* p, std::vector<uint32_t>& cpus);
+
+		static bool IsNumeric(const char* name);
+		static uint64_t Checksum(const char* data, size_t length);
+		static uint64_t GetClockTicks();
+
+		// Converts clock ticks (USER_HZ) to the 100ns units used elsewhere
+		static uint64_t TicksTo100ns(uint64_t ticks);
+	};
+
+}
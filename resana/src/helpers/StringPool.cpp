@@ -0,0 +1,197 @@
+#include "StringPool.h"
+#include "rspch.h"
+
+#include <cctype>
+
+namespace RESANA {
+
+	StringPool StringPool::sInstance;
+
+	static constexpr uint8_t FREE_ID = 0xff; // In mIdlePasses
+
+	StringPool::StringPool()
+	{
+		Intern({}); // Reserve id 0 for the empty string
+	}
+
+	StringPool::Id StringPool::Intern(const std::string_view str)
+	{
+		{
+			std::shared_lock lock(mMutex);
+			if (const auto it = mIds.find(str); it != mIds.end())
+			{
+				return it->second;
+			}
+		}
+
+		std::unique_lock lock(mMutex);
+		if (const auto it = mIds.find(str); it != mIds.end())
+		{
+			return it->second; // Interned by another thread in the meantime
+		}
+
+		// Ids dropped by Compact are handed out again before new ones
+		const bool reused = !mFreeIds.empty();
+		const Id id = reused ? mFreeIds.back() : mCount.load(std::memory_order_relaxed);
+		const uint32_t chunkIndex = id >> CHUNK_BITS;
+		if (chunkIndex >= MAX_CHUNKS)
+		{
+			return Empty; // Out of ids; should never happen in practice
+		}
+
+		Entry* chunk = mChunks[chunkIndex].load(std::memory_order_relaxed);
+		if (!chunk)
+		{
+			chunk = new Entry[CHUNK_SIZE];
+			mChunks[chunkIndex].store(chunk, std::memory_order_release);
+		}
+
+		uint32_t block;
+		const char* data = Store(str, block);
+		chunk[id & (CHUNK_SIZE - 1)] = { data, (uint32_t)str.size(), block };
+		mIds.emplace(std::string_view(data, str.size()), id);
+
+		if (reused)
+		{
+			mFreeIds.pop_back();
+		}
+		else
+		{
+			mIdlePasses.resize(id + 1);
+			mCount.store(id + 1, std::memory_order_release);
+		}
+		mIdlePasses[id] = 0;
+		return id;
+	}
+
+	std::string_view StringPool::View(const Id id) const
+	{
+		if (id >= mCount.load(std::memory_order_acquire))
+		{
+			return std::string_view("", 0); // Keeps CStr() NUL-terminated
+		}
+
+		const Entry* chunk = mChunks[id >> CHUNK_BITS].load(std::memory_order_acquire);
+		const Entry& entry = chunk[id & (CHUNK_SIZE - 1)];
+		return { entry.Data, entry.Length };
+	}
+
+	size_t StringPool::GetMemoryUsage() const
+	{
+		std::shared_lock lock(mMutex);
+		return mBytes + mIds.size() * (sizeof(std::string_view) + sizeof(Id)) + Size() * (sizeof(Entry) + sizeof(uint8_t));
+	}
+
+	StringPool::LiveSet StringPool::BeginCompact() const
+	{
+		LiveSet live;
+		live.mBits.resize(Size());
+		live.Mark(Empty);
+		return live;
+	}
+
+	size_t StringPool::Compact(const LiveSet& live)
+	{
+		std::unique_lock lock(mMutex);
+
+		// Ids interned since BeginCompact are past the end of the set and left alone
+		const Id count = (Id)std::min<size_t>(live.mBits.size(), Size());
+		size_t dropped = 0;
+		for (Id id = Empty + 1; id < count; id++)
+		{
+			uint8_t& idle = mIdlePasses[id];
+			if (idle == FREE_ID)
+			{
+				continue;
+			}
+			if (live.mBits[id])
+			{
+				idle = 0;
+				continue;
+			}
+			if (++idle < GRACE_PASSES)
+			{
+				continue;
+			}
+
+			Entry& entry = mChunks[id >> CHUNK_BITS].load(std::memory_order_relaxed)[id & (CHUNK_SIZE - 1)];
+			mIds.erase(std::string_view(entry.Data, entry.Length));
+
+			Block& block = mBlocks[entry.Block];
+			if (--block.Strings == 0 && entry.Block != mBlock)
+			{
+				mBytes -= block.Size;
+				block.Data.reset();
+			}
+
+			entry = { "", 0, 0 };
+			idle = FREE_ID;
+			mFreeIds.push_back(id);
+			dropped++;
+		}
+
+		if (dropped)
+		{
+			mGeneration.fetch_add(1, std::memory_order_release);
+		}
+		return dropped;
+	}
+
+	int StringPool::CompareNoCase(const std::string_view lhs, const std::string_view rhs)
+	{
+		const size_t length = std::min(lhs.size(), rhs.size());
+		for (size_t i = 0; i < length; i++)
+		{
+			const int a = std::tolower((unsigned char)lhs[i]);
+			const int b = std::tolower((unsigned char)rhs[i]);
+			if (a != b)
+			{
+				return a - b;
+			}
+		}
+		return (lhs.size() < rhs.size()) ? -1 : (lhs.size() > rhs.size()) ? 1 : 0;
+	}
+
+	const char* StringPool::Store(const std::string_view str, uint32_t& block)
+	{
+		// Strings are packed NUL-terminated into large blocks; anything too big
+		// for a block gets one of its own.
+		const size_t size = str.size() + 1;
+		char* data;
+		if (size > BLOCK_SIZE / 4)
+		{
+			block = (uint32_t)mBlocks.size();
+			data = mBlocks.emplace_back(Block{ std::unique_ptr<char[]>(new char[size]), size }).Data.get();
+			mBytes += size;
+		}
+		else
+		{
+			if (mBlockUsed + size > BLOCK_SIZE)
+			{
+				// The block being left may have had all its strings dropped already
+				if (!mBlocks.empty() && mBlocks[mBlock].Strings == 0)
+				{
+					mBytes -= mBlocks[mBlock].Size;
+					mBlocks[mBlock].Data.reset();
+				}
+
+				mBlock = (uint32_t)mBlocks.size();
+				mBlocks.emplace_back(Block{ std::unique_ptr<char[]>(new char[BLOCK_SIZE]), BLOCK_SIZE });
+				mBlockUsed = 0;
+				mBytes += BLOCK_SIZE;
+			}
+			block = mBlock;
+			data = mBlocks[mBlock].Data.get() + mBlockUsed;
+			mBlockUsed += size;
+		}
+		mBlocks[block].Strings++;
+
+		if (!str.empty())
+		{
+			std::memcpy(data, str.data(), str.size());
+		}
+		data[str.size()] = '\0';
+		return data;
+	}
+
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace RESANA {
+
+	/*
+	 * Global, append-mostly intern pool. Each distinct string is stored once and
+	 * handed out as a 32-bit id, so process snapshots copy and compare integers
+	 * instead of heap strings. Storage never moves, and looking one up by id
+	 * takes no lock.
+	 *
+	 * Strings are reclaimed by Compact: the owner of the live ids marks every id
+	 * it still holds, and a string that went unmarked for GRACE_PASSES passes in
+	 * a row is dropped and its id reused. The grace period keeps views and ids
+	 * copied into snapshots valid for as long as those are shown. Storage blocks
+	 * are freed once none of their strings is live.
+	 */
+	class StringPool {
+	public:
+		typedef uint32_t Id;
+		static constexpr Id Empty = 0; // Always the empty string
+
+		// Ids found in use during a Compact pass
+		class LiveSet {
+		public:
+			void Mark(Id id)
+			{
+				if (id < mBits.size()) { mBits[id] = true; }
+			}
+
+		private:
+			friend class StringPool;
+			std::vector<bool> mBits{};
+		};
+
+		static StringPool& Get() { return sInstance; }
+
+		Id Intern(std::string_view str);
+
+		[[nodiscard]] std::string_view View(Id id) const;
+		[[nodiscard]] const char* CStr(Id id) const { return View(id).data(); }
+		[[nodiscard]] size_t Size() const { return mCount.load(std::memory_order_acquire); } // Highest id + 1
+		[[nodiscard]] size_t GetMemoryUsage() const;
+
+		// Bumped whenever ids are dropped, so caches keyed by id know to start over
+		[[nodiscard]] uint32_t GetGeneration() const { return mGeneration.load(std::memory_order_acquire); }
+
+		[[nodiscard]] LiveSet BeginCompact() const;
+		// Returns the number of strings dropped
+		size_t Compact(const LiveSet& live);
+
+		// Case-insensitive ordering without allocating
+		static int CompareNoCase(std::string_view lhs, std::string_view rhs);
+
+	private:
+		StringPool();
+
+		const char* Store(std::string_view str, uint32_t& block);
+
+	private:
+		struct Entry {
+			const char* Data;
+			uint32_t Length;
+			uint32_t Block; // Index into mBlocks
+		};
+
+		struct Block {
+			std::unique_ptr<char[]> Data{};
+			size_t Size{};
+			uint32_t Strings{}; // Live strings stored in the block
+		};
+
+		static constexpr uint32_t CHUNK_BITS = 12;
+		static constexpr uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+		static constexpr uint32_t MAX_CHUNKS = 4096; // 16M strings
+		static constexpr size_t BLOCK_SIZE = 64 * 1024;
+		static constexpr uint8_t GRACE_PASSES = 3;
+
+		// Entries live in fixed chunks published with release stores, so readers
+		// never race with a growing container.
+		std::array<std::atomic<Entry*>, MAX_CHUNKS> mChunks{};
+		std::atomic<uint32_t> mCount{ 0 };
+
+		mutable std::shared_mutex mMutex{};
+		std::unordered_map<std::string_view, Id> mIds{};
+		std::vector<Block> mBlocks{};        // Freed blocks keep their slot, so indices stay valid
+		std::vector<uint8_t> mIdlePasses{};  // By id, passes since the string was last marked
+		std::vector<Id> mFreeIds{};
+		uint32_t mBlock = 0;                 // The block being filled
+		size_t mBlockUsed = BLOCK_SIZE;
+		size_t mBytes = 0;
+		std::atomic<uint32_t> mGeneration{ 0 };
+
+		static StringPool sInstance;
+	};
+
+}
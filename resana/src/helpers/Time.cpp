@@ -18,22 +18,22 @@ namespace RESANA {
 
 	float Time::GetTimeSeconds() {
 		return (float)((double)std::chrono::duration_cast<std::chrono::nanoseconds>(
-			std::chrono::high_resolution_clock::now() - mTimeStarted).count() * 1E-9);
+			std::chrono::steady_clock::now() - mTimeStarted).count() * 1E-9);
 	};
 
 	float Time::GetTimeMilliseconds() {
 		return (float)((double)std::chrono::duration_cast<std::chrono::nanoseconds>(
-			std::chrono::high_resolution_clock::now() - mTimeStarted).count() * 1E-3);
+			std::chrono::steady_clock::now() - mTimeStarted).count() * 1E-3);
 	};
 
 	float Time::GetTimeNanoseconds() {
 		return (float)((double)std::chrono::duration_cast<std::chrono::nanoseconds>(
-			std::chrono::high_resolution_clock::now() - mTimeStarted).count() * 1E-6);
+			std::chrono::steady_clock::now() - mTimeStarted).count() * 1E-6);
 	};
 
 	long long Time::GetTime() {
 		return std::chrono::duration_cast<std::chrono::milliseconds>(
-			std::chrono::high_resolution_clock::now() - mTimeStarted).count();
+			std::chrono::steady_clock::now() - mTimeStarted).count();
 	}
 
 	std::string Time::GetTimeFormatted() {
@@ -156,22 +156,22 @@ namespace RESANA {
 
 		sElapsedTime.clear();
 		if (GetHours() > 0) {
-			_itoa_s((int)GetHours(), hour, 10);
+			snprintf(hour, sizeof(hour), "%d", (int)GetHours());
 			sElapsedTime = *hour;
 			sElapsedTime += "h ";
 		}
 		if (GetMinutes() > 0 || GetHours() > 0) {
-			_itoa_s((int)GetMinutes(), min, 10);
+			snprintf(min, sizeof(min), "%d", (int)GetMinutes());
 			sElapsedTime += *min;
 			sElapsedTime += "m ";
 		}
 		if (GetSeconds() > 0 || GetMinutes() > 0) {
-			_itoa_s((int)GetSeconds(), sec, 10);
+			snprintf(sec, sizeof(sec), "%d", (int)GetSeconds());
 			sElapsedTime += *sec;
 			sElapsedTime += "s ";
 		}
 
-		_itoa_s((long)GetMilliseconds(), ms, 10);
+		snprintf(ms, sizeof(ms), "%ld", (long)GetMilliseconds());
 		sElapsedTime += *ms;
 		sElapsedTime += "ms";
 	}
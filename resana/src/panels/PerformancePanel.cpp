@@ -6,6 +6,31 @@
 namespace RESANA
 {
 
+	namespace
+	{
+		// Indexed by CpuState; idle is left undrawn
+		constexpr const char* STATE_NAMES[CpuState_Count] = {
+			"user", "nice", "system", "irq", "softirq", "iowait", "steal", "guest", "idle"
+		};
+		constexpr ImU32 STATE_COLORS[CpuState_Count] = {
+			IM_COL32(66, 150, 250, 255), IM_COL32(110, 190, 250, 255), IM_COL32(230, 90, 70, 255),
+			IM_COL32(240, 160, 60, 255), IM_COL32(240, 210, 80, 255), IM_COL32(170, 110, 220, 255),
+			IM_COL32(250, 70, 160, 255), IM_COL32(90, 200, 120, 255), IM_COL32(0, 0, 0, 0)
+		};
+
+		constexpr float STATE_BAR_WIDTH = 120.0f;
+		constexpr float HISTORY_HEIGHT = 80.0f;
+
+		struct HistoryRange
+		{
+			const char* Label;
+			uint32_t Seconds;
+		};
+		constexpr HistoryRange HISTORY_RANGES[] = {
+			{ "2 minutes", 120 }, { "10 minutes", 600 }, { "1 hour", 3600 }, { "6 hours", 21600 }, { "1 day", 86400 }, { "7 days", 604800 }
+		};
+	}
+
 	PerformancePanel::PerformancePanel()
 	{
 	}
@@ -29,6 +54,9 @@ namespace RESANA
 		mMemoryInfo = nullptr;
 		CPUPerformance::Shutdown();
 		mCPUInfo = nullptr;
+		PressureCollector::Shutdown();
+		SchedulerCollector::Shutdown();
+		PerfCounterCollector::Shutdown();
 	}
 
 	void PerformancePanel::OnUpdate(Timestep ts)
@@ -53,8 +81,21 @@ namespace RESANA
 			{
 				UpdateMemoryPanel();
 				UpdateCpuPanel();
+				PressureCollector::Run();
+				SchedulerCollector::Run();
 
+				if (CPUPerformance::Get()->GetTopology().IsAvailable()) {
+					ImGui::Checkbox("Group cores by topology", &mShowTopology);
+				}
 				ShowCPUTable();
+				if (mShowTopology) {
+					ShowCPUTopology();
+				}
+				ShowHistory();
+				ShowPressure();
+				ShowScheduler();
+				ShowPerfCounters();
+				ShowOverhead();
 				ImGui::TextUnformatted("Memory");
 				ShowPhysicalMemoryTable();
 				ShowVirtualMemoryTable();
@@ -64,7 +105,7 @@ namespace RESANA
 		}
 		else
 		{
-			ClosePanels();
+			HidePanels();
 		}
 	}
 
@@ -88,16 +129,16 @@ namespace RESANA
 		ImGui::Text("Used by process");
 		ImGui::TableNextColumn();
 
-		const auto totalMem = mMemoryInfo->GetTotalPhys() / BYTES_PER_MB;
-		const auto usedMem = mMemoryInfo->GetUsedPhys() / BYTES_PER_MB;
+		const unsigned long long totalMem = mMemoryInfo->GetTotalPhys() / BYTES_PER_MB;
+		const unsigned long long usedMem = mMemoryInfo->GetUsedPhys() / BYTES_PER_MB;
 		const float usedPercent = (float)usedMem / (float)totalMem * 100.0f;
-		const auto availMem = mMemoryInfo->GetAvailPhys() / BYTES_PER_MB;
-		const auto procMem = mMemoryInfo->GetCurrProcUsagePhys() / BYTES_PER_MB;
+		const unsigned long long availMem = mMemoryInfo->GetAvailPhys() / BYTES_PER_MB;
+		const unsigned long long procMem = mMemoryInfo->GetCurrProcUsagePhys() / BYTES_PER_MB;
 
 		ImGui::Text("%llu.%llu GB", totalMem / 1000, totalMem % 10);
 		ImGui::Text("%llu.%llu GB (%.1f%%)", usedMem / 1000, usedMem % 10, usedPercent);
 		ImGui::Text("%llu.%llu GB", availMem / 1000, availMem % 10);
-		ImGui::Text("%lu MB", procMem);
+		ImGui::Text("%llu MB", procMem);
 		ImGui::EndTable();
 	}
 
@@ -115,16 +156,16 @@ namespace RESANA
 		ImGui::Text("Used by process");
 		ImGui::TableNextColumn();
 
-		const auto totalMem = mMemoryInfo->GetTotalVirtual() / BYTES_PER_MB;
-		const auto usedMem = mMemoryInfo->GetUsedVirtual() / BYTES_PER_MB;
+		const unsigned long long totalMem = mMemoryInfo->GetTotalVirtual() / BYTES_PER_MB;
+		const unsigned long long usedMem = mMemoryInfo->GetUsedVirtual() / BYTES_PER_MB;
 		const float usedPercent = (float)usedMem / (float)totalMem * 100.0f;
-		const auto availMem = mMemoryInfo->GetAvailVirtual() / BYTES_PER_MB;
-		const auto procMem = mMemoryInfo->GetCurrProcUsageVirtual() / BYTES_PER_MB;
+		const unsigned long long availMem = mMemoryInfo->GetAvailVirtual() / BYTES_PER_MB;
+		const unsigned long long procMem = mMemoryInfo->GetCurrProcUsageVirtual() / BYTES_PER_MB;
 
 		ImGui::Text("%llu.%llu GB", totalMem / 1000, totalMem % 10);
 		ImGui::Text("%llu.%llu GB (%.1f%%)", usedMem / 1000, usedMem % 10, usedPercent);
 		ImGui::Text("%llu.%llu GB", availMem / 1000, availMem % 10);
-		ImGui::Text("%lu MB", procMem);
+		ImGui::Text("%llu MB", procMem);
 		ImGui::EndTable();
 	}
 
@@ -141,23 +182,41 @@ namespace RESANA
 		{
 			std::scoped_lock slock(data->GetMutex());
 
-			for (const auto& p : data->GetProcessors()) {
-				ImGui::Text("cpu %s", p->szName);
+			const auto& processors = data->GetProcessors();
+			if (mShowTopology)
+			{
+				mTopologyCores = processors;
+				mCPUInfo->GetTopology().Aggregate(mTopologyCores, mTopologyLoad);
+			}
+			else
+			{
+				for (size_t i = 0; i < processors.size(); i++) {
+					if (processors[i].Online) {
+						ImGui::Text("cpu %zu", i);
+					}
+				}
 			}
 
 			ImGui::Text("Total");
+			ImGui::Text("Core range");
 			ImGui::Text("Used by process");
 			ImGui::TableNextColumn();
 
 			// Display values for all logical processors
-			for (const auto& p : data->GetProcessors()) {
-				ImGui::Text("%.1f%%", p->FmtValue.doubleValue);
+			for (const auto& p : processors) {
+				if (p.Online && !mShowTopology) {
+					ShowCoreValues(p);
+				}
 			}
 
 			// Display current CPU load and load in use by process
 			const double currLoad = mCPUInfo->GetAverageLoad();
 			const double procLoad = mCPUInfo->GetCurrentProcessLoad();
+			const auto& summary = data->GetCoreSummary();
 			ImGui::Text("%.1f%%", currLoad);
+			ImGui::SameLine(0.0f, 16.0f);
+			ShowStateBar(data->GetTotalStates(), STATE_BAR_WIDTH);
+			ImGui::Text("%.1f%% - %.1f%% (avg %.1f%%)", summary.Min, summary.Max, summary.Average);
 			ImGui::Text("%.1f%%", procLoad);
 
 			mCPUInfo->ReleaseData();
@@ -166,6 +225,616 @@ namespace RESANA
 		ImGui::EndTable();
 	}
 
+	void PerformancePanel::ShowCoreValues(const CoreLoad& core)
+	{
+		ImGui::Text("%.1f%%", core.Load);
+		ImGui::SameLine(0.0f, 16.0f);
+		ShowStateBar(core.States, STATE_BAR_WIDTH);
+		if (core.Frequency)
+		{
+			ImGui::SameLine(0.0f, 16.0f);
+			ImGui::TextDisabled("%.2f GHz", core.Frequency / 1000.0f);
+			if (core.MaxFrequency && ImGui::IsItemHovered()) {
+				ImGui::SetTooltip("Maximum %.2f GHz", core.MaxFrequency / 1000.0f);
+			}
+		}
+		if (core.Throttles > 0)
+		{
+			ImGui::SameLine(0.0f, 16.0f);
+			ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.2f, 1.0f), "throttled x%lld", (long long)core.Throttles);
+		}
+	}
+
+	void PerformancePanel::ShowStateBar(const StateShares& states, const float width)
+	{
+		const ImVec2 start = ImGui::GetCursorScreenPos();
+		const ImVec2 end(start.x + width, start.y + ImGui::GetTextLineHeight());
+		ImGui::Dummy(ImVec2(width, end.y - start.y));
+
+		// Busy states stacked from the left, over a background that stands for idle
+		auto* drawList = ImGui::GetWindowDrawList();
+		drawList->AddRectFilled(start, end, ImGui::GetColorU32(ImGuiCol_FrameBg));
+		float x = start.x;
+		for (int state = 0; state < CpuState_Idle && x < end.x; state++)
+		{
+			const float right = std::min(x + width * std::max(states[state], 0.0f) / 100.0f, end.x);
+			drawList->AddRectFilled(ImVec2(x, start.y), ImVec2(right, end.y), STATE_COLORS[state]);
+			x = right;
+		}
+
+		if (ImGui::IsItemHovered()) {
+			ShowStateTooltip(states);
+		}
+	}
+
+	void PerformancePanel::ShowStateTooltip(const StateShares& states)
+	{
+		ImGui::BeginTooltip();
+		for (int state = 0; state < CpuState_Count; state++)
+		{
+			if (states[state] < 0.05f && state != CpuState_Idle) { continue; }
+			ImGui::TextColored(ImGui::ColorConvertU32ToFloat4(state == CpuState_Idle ? ImGui::GetColorU32(ImGuiCol_Text) : STATE_COLORS[state]),
+				"%-8s %5.1f%%", STATE_NAMES[state], states[state]);
+		}
+		ImGui::EndTooltip();
+	}
+
+	void PerformancePanel::ShowHistory()
+	{
+		ImGui::TextUnformatted("History");
+		ImGui::SameLine();
+		ImGui::SetNextItemWidth(120.0f);
+		if (ImGui::BeginCombo("##History range", HISTORY_RANGES[mHistoryRange].Label))
+		{
+			for (int range = 0; range < IM_ARRAYSIZE(HISTORY_RANGES); range++) {
+				if (ImGui::Selectable(HISTORY_RANGES[range].Label, range == mHistoryRange)) {
+					mHistoryRange = range;
+				}
+			}
+			ImGui::EndCombo();
+		}
+
+		char overlay[64];
+		const float width = ImGui::GetContentRegionAvail().x;
+		const auto columns = (size_t)std::max(width, 1.0f);
+
+		mCPUInfo = CPUPerformance::Get();
+		float peak = ReadHistory(mCPUInfo->GetLoadHistory(), 0, columns, mPlotValues);
+		if (!mPlotValues.empty())
+		{
+			snprintf(overlay, sizeof(overlay), "CPU %.1f%% (peak %.1f%%)", mPlotValues.back(), peak);
+			ImGui::PlotLines("##CPU history", mPlotValues.data(), (int)mPlotValues.size(), 0, overlay, 0.0f, 100.0f, ImVec2(width, HISTORY_HEIGHT));
+		}
+		ShowCPUStates();
+
+		const auto& coreHistory = mCPUInfo->GetCoreHistory();
+		if (coreHistory.GetSeriesCount() && ImGui::TreeNode("Per core"))
+		{
+			for (size_t core = 0; core < coreHistory.GetSeriesCount(); core++)
+			{
+				// Cores that were offline over the whole range have nothing to show
+				peak = ReadHistory(coreHistory, core, columns, mPlotValues);
+				if (mPlotValues.empty()) { continue; }
+
+				snprintf(overlay, sizeof(overlay), "cpu %zu  %.1f%% (peak %.1f%%)", core, mPlotValues.back(), peak);
+				ImGui::PushID((int)core);
+				ImGui::PlotLines("##Core history", mPlotValues.data(), (int)mPlotValues.size(), 0, overlay, 0.0f, 100.0f, ImVec2(width, HISTORY_HEIGHT / 2.0f));
+				ImGui::PopID();
+			}
+			ImGui::TreePop();
+		}
+
+		// Scaled to the totals, which only change when memory or the page file is resized
+		const float totals[MemoryHistory_Count] = {
+			(float)(mMemoryInfo->GetTotalPhys() / BYTES_PER_MB), (float)(mMemoryInfo->GetTotalVirtual() / BYTES_PER_MB)
+		};
+		const char* labels[MemoryHistory_Count] = { "Physical", "Commit" };
+		for (int series = 0; series < MemoryHistory_Count; series++)
+		{
+			peak = ReadHistory(mMemoryInfo->GetHistory(), series, columns, mPlotValues);
+			if (mPlotValues.empty()) { continue; }
+
+			snprintf(overlay, sizeof(overlay), "%s %.0f MB (peak %.0f MB)", labels[series], mPlotValues.back(), peak);
+			ImGui::PushID(series);
+			ImGui::PlotLines("##Memory history", mPlotValues.data(), (int)mPlotValues.size(), 0, overlay, 0.0f, totals[series], ImVec2(width, HISTORY_HEIGHT));
+			ImGui::PopID();
+		}
+	}
+
+	void PerformancePanel::ShowCPUStates()
+	{
+		// Two pixels per column, so the stacked bars stay readable
+		const float width = ImGui::GetContentRegionAvail().x;
+		const auto columns = (size_t)std::max(width / 2.0f, 1.0f);
+
+		const auto& history = mCPUInfo->GetStateHistory();
+		float peaks[CpuState_Idle];
+		for (int state = 0; state < CpuState_Idle; state++) {
+			peaks[state] = ReadHistory(history, state, columns, mStateValues[state]);
+		}
+
+		// Every state is appended together, so they all have the same number of columns
+		const size_t count = mStateValues[0].size();
+		if (!count) { return; }
+
+		// Busy states stacked from the bottom of each column, newest on the right
+		const ImVec2 start = ImGui::GetCursorScreenPos();
+		const ImVec2 end(start.x + width, start.y + HISTORY_HEIGHT);
+		ImGui::Dummy(ImVec2(width, HISTORY_HEIGHT));
+
+		auto* drawList = ImGui::GetWindowDrawList();
+		drawList->AddRectFilled(start, end, ImGui::GetColorU32(ImGuiCol_FrameBg));
+		const float column = width / (float)count;
+		for (size_t i = 0; i < count; i++)
+		{
+			const float left = start.x + column * (float)i;
+			float bottom = end.y;
+			for (int state = 0; state < CpuState_Idle && bottom > start.y; state++)
+			{
+				const float top = std::max(bottom - HISTORY_HEIGHT * std::max(mStateValues[state][i], 0.0f) / 100.0f, start.y);
+				drawList->AddRectFilled(ImVec2(left, top), ImVec2(left + column, bottom), STATE_COLORS[state]);
+				bottom = top;
+			}
+		}
+
+		if (ImGui::IsItemHovered())
+		{
+			const float offset = ImGui::GetIO().MousePos.x - start.x;
+			const size_t hovered = std::min((size_t)std::max(offset / column, 0.0f), count - 1);
+
+			StateShares shares{};
+			float busy = 0.0f;
+			for (int state = 0; state < CpuState_Idle; state++)
+			{
+				shares[state] = mStateValues[state][hovered];
+				busy += shares[state];
+			}
+			shares[CpuState_Idle] = std::max(100.0f - busy, 0.0f);
+			ShowStateTooltip(shares);
+		}
+
+		// Legend with the latest share and the peak over the range, so a burst of steal or iowait stands out
+		for (int state = 0; state < CpuState_Idle; state++)
+		{
+			if (state > 0) { ImGui::SameLine(0.0f, 16.0f); }
+			ImGui::TextColored(ImGui::ColorConvertU32ToFloat4(STATE_COLORS[state]), "%s %.1f%%", STATE_NAMES[state], mStateValues[state].back());
+			if (ImGui::IsItemHovered()) {
+				ImGui::SetTooltip("Peak %.1f%%", peaks[state]);
+			}
+		}
+	}
+
+	void PerformancePanel::ShowPressure()
+	{
+		const auto* collector = PressureCollector::Get();
+		if (!collector->IsAvailable()) { return; }
+
+		const char* names[PressureResource_Count] = { "CPU", "Memory", "IO" };
+		const PressureSet stats = collector->GetStats();
+		if (ImGui::BeginTable("##Pressure", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable))
+		{
+			ImGui::TableSetupColumn("Pressure");
+			ImGui::TableSetupColumn("10 s");
+			ImGui::TableSetupColumn("60 s");
+			ImGui::TableSetupColumn("300 s");
+			ImGui::TableSetupColumn("Now");
+			ImGui::TableHeadersRow();
+
+			for (int resource = 0; resource < PressureResource_Count; resource++)
+			{
+				const auto& pressure = stats[resource];
+				if (!pressure.Available) { continue; }
+
+				for (const bool full : { false, true })
+				{
+					if (full && !pressure.HasFull) { continue; }
+
+					const auto& line = full ? pressure.Full : pressure.Some;
+					ImGui::TableNextColumn();
+					ImGui::Text("%s %s", names[resource], full ? "full" : "some");
+					ImGui::TableNextColumn();
+					ImGui::Text("%.2f%%", line.Avg10);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.2f%%", line.Avg60);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.2f%%", line.Avg300);
+					ImGui::TableNextColumn();
+					ImGui::Text("%.1f%%", line.Stalled);
+				}
+			}
+			ImGui::EndTable();
+		}
+
+		// Sampled every 250 ms; the peak keeps stalls that the averages smooth away
+		char overlay[64];
+		const float width = ImGui::GetContentRegionAvail().x;
+		for (int resource = 0; resource < PressureResource_Count; resource++)
+		{
+			const float peak = ReadHistory(collector->GetHistory(), PressureCollector::GetSeries((PressureResource)resource, false), (size_t)std::max(width, 1.0f), mPlotValues);
+			if (mPlotValues.empty()) { continue; }
+
+			snprintf(overlay, sizeof(overlay), "%s some %.1f%% (peak %.1f%%)", names[resource], mPlotValues.back(), peak);
+			ImGui::PushID(resource);
+			ImGui::PlotLines("##Pressure history", mPlotValues.data(), (int)mPlotValues.size(), 0, overlay, 0.0f, 100.0f, ImVec2(width, HISTORY_HEIGHT / 2.0f));
+			ImGui::PopID();
+		}
+	}
+
+	void PerformancePanel::ShowScheduler()
+	{
+		auto* collector = SchedulerCollector::Get();
+		if (!collector->IsAvailable()) { return; }
+
+		const SchedulerStats stats = collector->GetStats();
+		if (!stats.Available) { return; }
+
+		if (ImGui::BeginTable("##Scheduler", 2, ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable))
+		{
+			ImGui::TableSetupColumn("Scheduler");
+			ImGui::TableSetupColumn("##values");
+			ImGui::TableHeadersRow();
+
+			ImGui::TableNextColumn();
+			ImGui::Text("Context switches");
+			ImGui::Text("Interrupts");
+			ImGui::Text("Forks");
+			ImGui::Text("Running / blocked on I/O");
+			ImGui::Text("Load average");
+			ImGui::TableNextColumn();
+			ImGui::Text("%.0f/s", stats.ContextSwitches);
+			ImGui::Text("%.0f/s", stats.Interrupts);
+			ImGui::Text("%.1f/s", stats.Forks);
+			ImGui::Text("%u / %u of %u threads", stats.Running, stats.Blocked, stats.Threads);
+			ImGui::Text("%.2f  %.2f  %.2f", stats.LoadAverage[0], stats.LoadAverage[1], stats.LoadAverage[2]);
+			ImGui::EndTable();
+		}
+
+		// Rates have no fixed scale, so each graph is scaled to its peak over the range
+		const char* names[SchedulerSeries_Count] = { "Context switches", "Interrupts", "Running", "Blocked" };
+		char overlay[64];
+		const float width = ImGui::GetContentRegionAvail().x;
+		for (int series = 0; series < SchedulerSeries_Count; series++)
+		{
+			const float peak = ReadHistory(collector->GetHistory(), series, (size_t)std::max(width, 1.0f), mPlotValues);
+			if (mPlotValues.empty()) { continue; }
+
+			snprintf(overlay, sizeof(overlay), "%s %.0f (peak %.0f)", names[series], mPlotValues.back(), peak);
+			ImGui::PushID(series);
+			ImGui::PlotLines("##Scheduler history", mPlotValues.data(), (int)mPlotValues.size(), 0, overlay, 0.0f, std::max(peak, 1.0f), ImVec2(width, HISTORY_HEIGHT / 2.0f));
+			ImGui::PopID();
+		}
+
+		const size_t cpus = collector->GetCpuSoftirqs(mSoftirqRates);
+		if (!cpus || !ImGui::TreeNode("Softirqs per CPU")) { return; }
+
+		if (ImGui::BeginTable("##Softirqs", SoftirqType_Count + 1, ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_SizingFixedFit))
+		{
+			ImGui::TableSetupColumn("CPU");
+			for (int type = 0; type < SoftirqType_Count; type++) {
+				ImGui::TableSetupColumn(SchedulerCollector::GetName((SoftirqType)type));
+			}
+			ImGui::TableHeadersRow();
+
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted("Total");
+			for (const double rate : stats.Softirqs)
+			{
+				ImGui::TableNextColumn();
+				ImGui::Text("%.0f", rate);
+			}
+
+			// A core taking most of a softirq's load is where a storm is pinned
+			for (size_t cpu = 0; cpu < cpus; cpu++)
+			{
+				ImGui::TableNextColumn();
+				ImGui::Text("cpu %zu", cpu);
+				for (int type = 0; type < SoftirqType_Count; type++)
+				{
+					const double rate = mSoftirqRates[cpu * SoftirqType_Count + type];
+					ImGui::TableNextColumn();
+					if (cpus > 1 && rate > 0.0 && rate >= stats.Softirqs[type] * 0.5) {
+						ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "%.0f", rate);
+					} else {
+						ImGui::Text("%.0f", rate);
+					}
+				}
+			}
+			ImGui::EndTable();
+		}
+
+		ImGui::TreePop();
+	}
+
+	void PerformancePanel::ShowPerfCounters()
+	{
+		// Per-core counters hold descriptors on every CPU, so they are only opened while the node is expanded
+		const bool open = ImGui::TreeNode("Performance counters");
+		PerfCounterCollector::WatchCores(open);
+		if (!open) { return; }
+		PerfCounterCollector::Run();
+
+		const auto* collector = PerfCounterCollector::Get();
+		if (!collector->IsAvailable() || !collector->HasCores())
+		{
+			// Whole-CPU counters need perf_event_paranoid of 0 or lower, or CAP_PERFMON
+			ImGui::TextDisabled(collector->IsAvailable() ? "Not permitted to count events per core" : "Performance counters are not available");
+			ImGui::TreePop();
+			return;
+		}
+		if (!collector->HasHardware()) {
+			ImGui::TextDisabled("No PMU exposed, software events only");
+		}
+		if (collector->AreCoresLimited()) {
+			ImGui::TextDisabled("Some cores are not counted, to stay within the descriptor limit");
+		}
+
+		if (!collector->GetCores(mPerfCores))
+		{
+			ImGui::TextUnformatted("Collecting counters...");
+			ImGui::TreePop();
+			return;
+		}
+
+		const bool hardware = collector->HasHardware();
+		if (ImGui::BeginTable("##PerfCounters", hardware ? 6 : 4, ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable))
+		{
+			ImGui::TableSetupColumn("CPU");
+			ImGui::TableSetupColumn("Switches/s");
+			ImGui::TableSetupColumn("Migrations/s");
+			ImGui::TableSetupColumn("Faults/s");
+			if (hardware)
+			{
+				ImGui::TableSetupColumn("GHz");
+				ImGui::TableSetupColumn("IPC");
+			}
+			ImGui::TableHeadersRow();
+
+			const auto showRate = [](const PerfRates& core, const PerfCounter counter, const char* format, const double divisor) {
+				ImGui::TableNextColumn();
+				if (core.Counted[counter]) {
+					ImGui::Text(format, core.Rates[counter] / divisor);
+				} else {
+					ImGui::TextDisabled("-");
+				}
+			};
+
+			for (size_t cpu = 0; cpu < mPerfCores.size(); cpu++)
+			{
+				const auto& core = mPerfCores[cpu];
+				if (!core.Available) { continue; }
+
+				ImGui::TableNextColumn();
+				ImGui::Text("cpu %zu", cpu);
+				showRate(core, PerfCounter_ContextSwitches, "%.0f", 1.0);
+				showRate(core, PerfCounter_Migrations, "%.0f", 1.0);
+				showRate(core, PerfCounter_PageFaults, "%.0f", 1.0);
+				if (hardware)
+				{
+					showRate(core, PerfCounter_Cycles, "%.2f", 1.0e9);
+					ImGui::TableNextColumn();
+					if (core.Counted[PerfCounter_Cycles] && core.Counted[PerfCounter_Instructions] && core.Rates[PerfCounter_Cycles] > 0.0) {
+						ImGui::Text("%.2f", core.Rates[PerfCounter_Instructions] / core.Rates[PerfCounter_Cycles]);
+					} else {
+						ImGui::TextDisabled("-");
+					}
+				}
+			}
+			ImGui::EndTable();
+		}
+
+		ImGui::TreePop();
+	}
+
+	void PerformancePanel::ShowOverhead() const
+	{
+		if (!ImGui::TreeNode("Monitor overhead")) { return; }
+
+		// Both in percent of one core; the process load also covers threads that never open a scope
+		const SelfUsage usage = SelfProfiler::GetUsage();
+		const double processLoad = mCPUInfo ? mCPUInfo->GetCurrentProcessLoad() * mCPUInfo->GetNumProcessors() : 0.0;
+		ImGui::Text("Accounted %.2f%% of a core, process %.2f%%", usage.Total, processLoad);
+
+		if (ImGui::BeginTable("##Subsystems", 2, ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable))
+		{
+			ImGui::TableSetupColumn("Subsystem");
+			ImGui::TableSetupColumn("Core %");
+			ImGui::TableHeadersRow();
+
+			for (int subsystem = 0; subsystem < Subsystem_Count; subsystem++)
+			{
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(SelfProfiler::GetName((Subsystem)subsystem));
+				ImGui::TableNextColumn();
+				ImGui::Text("%.2f%%", usage.Subsystems[subsystem]);
+			}
+			ImGui::EndTable();
+		}
+
+		if (ImGui::BeginTable("##Threads", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable))
+		{
+			ImGui::TableSetupColumn("Thread");
+			ImGui::TableSetupColumn("Core %");
+			ImGui::TableSetupColumn("Mostly");
+			ImGui::TableHeadersRow();
+
+			for (const auto& thread : usage.Threads)
+			{
+				const auto* busiest = std::max_element(std::begin(thread.Subsystems), std::end(thread.Subsystems));
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(thread.Name.c_str());
+				ImGui::TableNextColumn();
+				ImGui::Text("%.2f%%", thread.Load);
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(thread.Load > 0.0 ? SelfProfiler::GetName((Subsystem)(busiest - thread.Subsystems)) : "");
+			}
+			ImGui::EndTable();
+		}
+
+		ImGui::TreePop();
+	}
+
+	float PerformancePanel::ReadHistory(const MetricHistory& history, const size_t series, size_t columns, std::vector<float>& values)
+	{
+		const auto& range = HISTORY_RANGES[mHistoryRange];
+		const HistoryTier tier = MetricHistory::GetTier(std::chrono::seconds(range.Seconds));
+		history.Read(tier, series, range.Seconds / MetricHistory::TIERS[tier].Period, mHistoryPoints);
+
+		values.clear();
+		const size_t count = mHistoryPoints.size();
+		if (!count) { return 0.0f; }
+
+		// Buckets folded into columns by their sample-weighted average; gaps repeat the column before them
+		columns = std::min(columns, count);
+		values.resize(columns);
+		float peak = 0.0f, previous = 0.0f;
+		bool sampled = false;
+		for (size_t i = 0; i < columns; i++)
+		{
+			double sum = 0.0;
+			uint32_t samples = 0;
+			for (size_t bucket = i * count / columns; bucket < (i + 1) * count / columns; bucket++)
+			{
+				const auto& point = mHistoryPoints[bucket];
+				if (!point.Samples) { continue; }
+				sum += (double)point.Average * point.Samples;
+				samples += point.Samples;
+				peak = std::max(peak, point.Max);
+			}
+
+			values[i] = samples ? (float)(sum / samples) : previous;
+			previous = values[i];
+			sampled |= samples > 0;
+		}
+
+		if (!sampled) { values.clear(); }
+		return peak;
+	}
+
+	void PerformancePanel::ShowCPUTopology()
+	{
+		const auto& topology = CPUPerformance::Get()->GetTopology();
+		if (mTopologyLoad.Packages.empty()) { return; }
+
+		constexpr ImGuiTableFlags tableFlags = ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg;
+		if (!ImGui::BeginTable("##CPU Topology", 4, tableFlags)) { return; }
+		ImGui::TableSetupColumn("Topology", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("Load");
+		ImGui::TableSetupColumn("Busiest");
+		ImGui::TableSetupColumn("Busy");
+		ImGui::TableHeadersRow();
+
+		char label[64];
+		constexpr ImGuiTreeNodeFlags nodeFlags = ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_OpenOnArrow;
+		const auto& packages = topology.GetPackages();
+		for (size_t package = 0; package < packages.size(); package++)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			snprintf(label, sizeof(label), "Package %zu", package);
+			const bool packageOpen = ImGui::TreeNodeEx(label, nodeFlags | ImGuiTreeNodeFlags_DefaultOpen);
+			ShowTopologyRow(mTopologyLoad.Packages[package], false);
+			if (!packageOpen) { continue; }
+
+			// A cache level only when the package splits its cores between several
+			const auto& l3Domains = packages[package];
+			for (const int32_t l3 : l3Domains)
+			{
+				bool l3Open = true;
+				if (l3Domains.size() > 1)
+				{
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					snprintf(label, sizeof(label), "L3 domain %d", l3);
+					l3Open = ImGui::TreeNodeEx(label, nodeFlags | ImGuiTreeNodeFlags_DefaultOpen);
+					ShowTopologyRow(mTopologyLoad.L3Domains[l3], false);
+				}
+				if (!l3Open) { continue; }
+
+				for (const int32_t core : topology.GetL3Domains()[l3])
+				{
+					const auto& threads = topology.GetPhysicalCores()[core];
+					const auto& group = mTopologyLoad.PhysicalCores[core];
+
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					snprintf(label, sizeof(label), "Core %d", core);
+					const bool coreOpen = ImGui::TreeNodeEx(label, nodeFlags | (threads.size() > 1 ? 0 : ImGuiTreeNodeFlags_Leaf));
+
+					// Every sibling busy means they are competing for the same core
+					ShowTopologyRow(group, threads.size() > 1 && group.Busy == threads.size());
+					if (coreOpen)
+					{
+						ShowTopologyThreads(threads);
+						ImGui::TreePop();
+					}
+				}
+
+				if (l3Domains.size() > 1) { ImGui::TreePop(); }
+			}
+			ImGui::TreePop();
+		}
+
+		const auto& nodes = topology.GetNodes();
+		if (nodes.size() > 1)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			if (ImGui::TreeNodeEx("NUMA nodes", nodeFlags | ImGuiTreeNodeFlags_DefaultOpen))
+			{
+				for (size_t node = 0; node < nodes.size(); node++)
+				{
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					snprintf(label, sizeof(label), "Node %zu", node);
+					const bool nodeOpen = ImGui::TreeNodeEx(label, nodeFlags);
+					ShowTopologyRow(mTopologyLoad.Nodes[node], false);
+					if (nodeOpen)
+					{
+						ShowTopologyThreads(nodes[node]);
+						ImGui::TreePop();
+					}
+				}
+				ImGui::TreePop();
+			}
+		}
+
+		ImGui::EndTable();
+	}
+
+	void PerformancePanel::ShowTopologyRow(const TopologyGroup& group, const bool contended)
+	{
+		ImGui::TableNextColumn();
+		ImGui::Text("%.1f%%", group.Load);
+		ImGui::TableNextColumn();
+		ImGui::Text("%.1f%%", group.MaxLoad);
+		ImGui::TableNextColumn();
+		if (contended) {
+			ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.2f, 1.0f), "%u / %u", group.Busy, group.Online);
+		} else {
+			ImGui::Text("%u / %u", group.Busy, group.Online);
+		}
+	}
+
+	void PerformancePanel::ShowTopologyThreads(const std::vector<int32_t>& processors) const
+	{
+		const auto& cores = CPUPerformance::Get()->GetTopology().GetCores();
+		for (const int32_t cpu : processors)
+		{
+			if ((size_t)cpu >= mTopologyCores.size() || !mTopologyCores[cpu].Online) { continue; }
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TreeNodeEx((void*)(intptr_t)cpu, ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen, "cpu %d", cpu);
+			if (ImGui::IsItemHovered()) {
+				const auto& core = cores[cpu];
+				ImGui::SetTooltip("Package %d, die %d, core %d, thread %d\nL2 %d, L3 %d, NUMA node %d",
+					core.Package, core.Die, core.PhysicalCore, core.Thread, core.L2, core.L3, core.Node);
+			}
+			ImGui::TableNextColumn();
+			ShowCoreValues(mTopologyCores[cpu]);
+		}
+	}
+
 	void PerformancePanel::InitCpuPanel() const
 	{
 		mCPUInfo = CPUPerformance::Get();
@@ -196,10 +865,16 @@ namespace RESANA
 		mMemoryInfo->SetUpdateInterval(mUpdateInterval);
 	}
 
-	void PerformancePanel::ClosePanels()
+	void PerformancePanel::HidePanels()
 	{
-		MemoryPerformance::Stop();
-		CPUPerformance::Stop();
+		// The histories keep filling at the base rate while hidden; only drawing stops
+		MemoryPerformance::Run();
+		MemoryPerformance::Get()->SetUpdateInterval(TimeTick::Rate::Normal);
+		CPUPerformance::Run();
+		CPUPerformance::Get()->SetUpdateInterval(TimeTick::Rate::Normal);
+		PressureCollector::Run();
+		SchedulerCollector::Run();
+		PerfCounterCollector::WatchCores(false);
 	}
 
 } // RESANA
\ No newline at end of file
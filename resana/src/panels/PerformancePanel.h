@@ -3,6 +3,10 @@
 #include "Panel.h"
 #include "system/memory/MemoryPerformance.h"
 #include "system/cpu/CPUPerformance.h"
+#include "system/pressure/PressureCollector.h"
+#include "system/scheduler/SchedulerCollector.h"
+#include "system/perf/PerfCounterCollector.h"
+#include "system/SelfProfiler.h"
 
 //#include "helpers/Time.h"
 
@@ -27,17 +31,43 @@ namespace RESANA
 		void ShowPhysicalMemoryTable() const;
 		void ShowVirtualMemoryTable() const;
 		void ShowCPUTable();
+		static void ShowCoreValues(const CoreLoad& core);
+		static void ShowStateBar(const StateShares& states, float width);
+		static void ShowStateTooltip(const StateShares& states);
+		void ShowHistory();
+		void ShowCPUStates();
+		void ShowPressure();
+		void ShowScheduler();
+		void ShowPerfCounters();
+		void ShowOverhead() const;
+		float ReadHistory(const MetricHistory& history, size_t series, size_t columns, std::vector<float>& values);
+		void ShowCPUTopology();
+		static void ShowTopologyRow(const TopologyGroup& group, bool contended);
+		void ShowTopologyThreads(const std::vector<int32_t>& processors) const;
 		void InitCpuPanel() const;
 		void UpdateCpuPanel() const;
 		void InitMemoryPanel() const;
 		void UpdateMemoryPanel() const;
 
-		static void ClosePanels();
+		static void HidePanels();
 
 	private:
 		mutable MemoryPerformance* mMemoryInfo = nullptr;
 		mutable CPUPerformance* mCPUInfo = nullptr;
 		bool mPanelOpen = false;
+		bool mShowTopology = false;
+
+		// Copied under the data lock, drawn after it is released
+		std::vector<CoreLoad> mTopologyCores{};
+		TopologyLoad mTopologyLoad{};
+
+		// Scratch for the history graphs, reused between frames
+		int mHistoryRange = 0;
+		std::vector<HistoryPoint> mHistoryPoints{};
+		std::vector<float> mPlotValues{};
+		std::array<std::vector<float>, CpuState_Idle> mStateValues{};
+		std::vector<double> mSoftirqRates{};
+		std::vector<PerfRates> mPerfCores{};
 
 		uint32_t mUpdateInterval{};
 	};
@@ -0,0 +1,604 @@
+#include "ProcessFilter.h"
+#include "rspch.h"
+
+#include "ProcessPanel.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstring>
+
+namespace RESANA {
+
+//--------------------------------------------------------------
+// [SECTION] Columns
+//--------------------------------------------------------------
+
+struct FilterColumn {
+    const char* Name;
+    ProcessMenu Column;
+};
+
+// Every column of the table can be referenced, some under several names
+static const FilterColumn sFilterColumns[] = {
+    { "name", View_ProcessName },
+    { "pid", View_ProcessId },
+    { "ppid", View_ParentProcessId },
+    { "modules", View_ModuleCount },
+    { "mem", View_MemoryUsage },
+    { "memory", View_MemoryUsage },
+    { "rss", View_MemoryUsage },
+    { "threads", View_ThreadCount },
+    { "priority", View_PriorityClass },
+    { "cpu", View_CpuUsage },
+    { "cmd", View_CommandLine },
+    { "cmdline", View_CommandLine },
+    { "read", View_DiskRead },
+    { "dr", View_DiskRead },
+    { "write", View_DiskWrite },
+    { "dw", View_DiskWrite },
+    { "fds", View_FdCount },
+};
+
+static int FindColumn(const std::string_view name)
+{
+    for (const auto& column : sFilterColumns) {
+        if (name.size() == std::strlen(column.Name) && StringPool::CompareNoCase(name, column.Name) == 0) {
+            return column.Column;
+        }
+    }
+    return -1;
+}
+
+bool ProcessFilter::IsStringColumn(const int column)
+{
+    return column == View_ProcessName || column == View_CommandLine;
+}
+
+double ProcessFilter::GetNumber(const ProcessEntry* entry, const int column)
+{
+    switch (column) {
+    case View_ProcessId:
+        return (double)entry->GetProcessId();
+    case View_ParentProcessId:
+        return (double)entry->GetParentProcessId();
+    case View_ModuleCount:
+        return (double)entry->GetModuleCount();
+    case View_MemoryUsage:
+        return (double)entry->GetMemoryUsage();
+    case View_ThreadCount:
+        return (double)entry->GetThreadCount();
+    case View_PriorityClass:
+        return (double)entry->GetPriorityClass();
+    case View_CpuUsage:
+        return entry->GetCpuLoad();
+    case View_DiskRead:
+        return entry->GetIoRates().ReadBytes;
+    case View_DiskWrite:
+        return entry->GetIoRates().WriteBytes;
+    case View_FdCount:
+        return (double)entry->GetFdStats().Count;
+    default:
+        return 0.0;
+    }
+}
+
+StringPool::Id ProcessFilter::GetString(const ProcessEntry* entry, const int column)
+{
+    return (column == View_ProcessName) ? entry->GetNameId() : entry->GetCommandLineId();
+}
+
+//--------------------------------------------------------------
+// [SECTION] Parser
+//--------------------------------------------------------------
+
+struct ProcessFilter::Token {
+    enum Type {
+        End,
+        Identifier,
+        Number,
+        String,
+        Operator,
+        LeftParen,
+        RightParen,
+        Invalid,
+    };
+
+    Type Kind = End;
+    std::string_view Text {};
+    double Value {};
+};
+
+/*
+ * Recursive descent over
+ *
+ *     or         := and ( "||" and )*
+ *     and        := unary ( "&&" unary )*
+ *     unary      := "!" unary | "(" or ")" | comparison
+ *     comparison := column op value
+ *
+ * emitting instructions in postfix order.
+ */
+class ProcessFilter::Parser {
+public:
+    Parser(const std::string_view source, std::vector<Instruction>& program)
+        : mSource(source)
+        , mProgram(program)
+    {
+        Advance();
+    }
+
+    bool Parse(std::string& error)
+    {
+        if (!ParseOr()) {
+            error = mError;
+            return false;
+        }
+        if (mToken.Kind != Token::End) {
+            error = "Unexpected '" + std::string(mToken.Text) + "'";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    bool Fail(const std::string& message)
+    {
+        if (mError.empty()) {
+            mError = message;
+        }
+        return false;
+    }
+
+    bool IsKeyword(const char* keyword) const
+    {
+        return mToken.Kind == Token::Identifier && mToken.Text.size() == std::strlen(keyword)
+            && StringPool::CompareNoCase(mToken.Text, keyword) == 0;
+    }
+
+    bool IsOperator(const char* op) const
+    {
+        return mToken.Kind == Token::Operator && mToken.Text == op;
+    }
+
+    void Advance()
+    {
+        while (mPos < mSource.size() && std::isspace((unsigned char)mSource[mPos])) {
+            mPos++;
+        }
+
+        mToken = {};
+        if (mPos >= mSource.size()) {
+            return;
+        }
+
+        const size_t start = mPos;
+        const char c = mSource[mPos];
+
+        if (std::isalpha((unsigned char)c) || c == '_') {
+            // Also takes in dots and dashes so bare words like chrome.exe read as one
+            while (mPos < mSource.size() && (std::isalnum((unsigned char)mSource[mPos]) || std::strchr("_.-", mSource[mPos]))) {
+                mPos++;
+            }
+            mToken.Kind = Token::Identifier;
+        } else if (std::isdigit((unsigned char)c) || c == '.') {
+            char* end;
+            const std::string number(mSource.substr(start, 32));
+            mToken.Value = std::strtod(number.c_str(), &end);
+            mPos += (size_t)(end - number.c_str());
+
+            // Size suffixes
+            if (mPos < mSource.size()) {
+                const char* suffixes = "KMGT";
+                if (const char* suffix = std::strchr(suffixes, std::toupper((unsigned char)mSource[mPos])); suffix && *suffix) {
+                    mToken.Value *= std::pow(1024.0, (double)(suffix - suffixes + 1));
+                    mPos++;
+                }
+            }
+            mToken.Kind = Token::Number;
+            if (mPos == start) {
+                mToken.Kind = Token::Invalid; // A lone '.'
+                mPos++;
+            }
+        } else if (c == '"' || c == '\'') {
+            const size_t end = mSource.find(c, start + 1);
+            if (end == std::string_view::npos) {
+                mToken.Kind = Token::Invalid;
+                mToken.Text = mSource.substr(start);
+                mPos = mSource.size();
+                return;
+            }
+            mToken.Kind = Token::String;
+            mToken.Text = mSource.substr(start + 1, end - start - 1);
+            mPos = end + 1;
+            return;
+        } else if (c == '(' || c == ')') {
+            mToken.Kind = (c == '(') ? Token::LeftParen : Token::RightParen;
+            mPos++;
+        } else {
+            static const char* sOperators[] = { "&&", "||", ">=", "<=", "==", "!=", "!~", ">", "<", "=", "~", "!" };
+            for (const char* op : sOperators) {
+                if (mSource.compare(start, std::strlen(op), op) == 0) {
+                    mToken.Kind = Token::Operator;
+                    mPos += std::strlen(op);
+                    break;
+                }
+            }
+            if (mToken.Kind != Token::Operator) {
+                mToken.Kind = Token::Invalid;
+                mPos++;
+            }
+        }
+
+        mToken.Text = mSource.substr(start, mPos - start);
+    }
+
+    bool ParseOr()
+    {
+        if (!ParseAnd()) {
+            return false;
+        }
+        while (IsOperator("||") || IsKeyword("or")) {
+            Advance();
+            if (!ParseAnd()) {
+                return false;
+            }
+            mProgram.push_back({ OpCode::Or });
+        }
+        return true;
+    }
+
+    bool ParseAnd()
+    {
+        if (!ParseUnary()) {
+            return false;
+        }
+        while (IsOperator("&&") || IsKeyword("and")) {
+            Advance();
+            if (!ParseUnary()) {
+                return false;
+            }
+            mProgram.push_back({ OpCode::And });
+        }
+        return true;
+    }
+
+    bool ParseUnary()
+    {
+        if (IsOperator("!") || IsKeyword("not")) {
+            Advance();
+            if (!ParseUnary()) {
+                return false;
+            }
+            mProgram.push_back({ OpCode::Not });
+            return true;
+        }
+
+        if (mToken.Kind == Token::LeftParen) {
+            Advance();
+            if (!ParseOr()) {
+                return false;
+            }
+            if (mToken.Kind != Token::RightParen) {
+                return Fail("Expected ')'");
+            }
+            Advance();
+            return true;
+        }
+
+        return ParseComparison();
+    }
+
+    bool ParseComparison()
+    {
+        if (mToken.Kind != Token::Identifier) {
+            return Fail(mToken.Kind == Token::End ? "Expected a column" : "Expected a column, found '" + std::string(mToken.Text) + "'");
+        }
+
+        Instruction instruction;
+        instruction.Column = FindColumn(mToken.Text);
+        if (instruction.Column < 0) {
+            return Fail("Unknown column '" + std::string(mToken.Text) + "'");
+        }
+        Advance();
+
+        if (mToken.Kind != Token::Operator) {
+            return Fail("Expected a comparison after the column");
+        }
+        const std::string op(mToken.Text);
+        Advance();
+
+        if (IsStringColumn(instruction.Column)) {
+            // Bare words are accepted as strings: name ~ java
+            if (mToken.Kind != Token::String && mToken.Kind != Token::Identifier && mToken.Kind != Token::Number) {
+                return Fail("Expected a string after '" + op + "'");
+            }
+
+            if (op == "~") {
+                instruction.Code = OpCode::Contains;
+            } else if (op == "!~") {
+                instruction.Code = OpCode::NotContains;
+            } else if (op == "==" || op == "=") {
+                instruction.Code = OpCode::CompareString;
+                instruction.Op = CompareOp::Equal;
+            } else if (op == "!=") {
+                instruction.Code = OpCode::CompareString;
+                instruction.Op = CompareOp::NotEqual;
+            } else {
+                return Fail("'" + op + "' doesn't apply to text");
+            }
+
+            instruction.Text.resize(mToken.Text.size());
+            std::transform(mToken.Text.begin(), mToken.Text.end(), instruction.Text.begin(),
+                [](const char c) { return (char)std::tolower((unsigned char)c); });
+        } else {
+            if (mToken.Kind != Token::Number) {
+                return Fail("Expected a number after '" + op + "'");
+            }
+
+            instruction.Code = OpCode::CompareNumber;
+            instruction.Number = mToken.Value;
+            if (op == "<") {
+                instruction.Op = CompareOp::Less;
+            } else if (op == "<=") {
+                instruction.Op = CompareOp::LessEqual;
+            } else if (op == ">") {
+                instruction.Op = CompareOp::Greater;
+            } else if (op == ">=") {
+                instruction.Op = CompareOp::GreaterEqual;
+            } else if (op == "==" || op == "=") {
+                instruction.Op = CompareOp::Equal;
+            } else if (op == "!=") {
+                instruction.Op = CompareOp::NotEqual;
+            } else {
+                return Fail("'" + op + "' doesn't apply to numbers");
+            }
+        }
+        Advance();
+
+        mProgram.emplace_back(std::move(instruction));
+        return true;
+    }
+
+private:
+    std::string_view mSource;
+    size_t mPos = 0;
+    Token mToken {};
+    std::vector<Instruction>& mProgram;
+    std::string mError {};
+};
+
+bool ProcessFilter::Compile(const std::string_view expression)
+{
+    Clear();
+
+    const bool blank = std::all_of(expression.begin(), expression.end(), [](const char c) { return std::isspace((unsigned char)c); });
+    if (blank) {
+        return true; // An empty filter passes everything
+    }
+
+    Parser parser(expression, mProgram);
+    if (!parser.Parse(mError)) {
+        mProgram.clear();
+        return false;
+    }
+
+    // Work out the mask stack depth and the columns to gather
+    size_t depth = 0;
+    for (const auto& instruction : mProgram) {
+        switch (instruction.Code) {
+        case OpCode::And:
+        case OpCode::Or:
+            depth--;
+            break;
+        case OpCode::Not:
+            break;
+        default:
+            depth++;
+            mStackDepth = std::max(mStackDepth, depth);
+            if (std::find(mColumns.begin(), mColumns.end(), instruction.Column) == mColumns.end()) {
+                mColumns.emplace_back(instruction.Column);
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+void ProcessFilter::Clear()
+{
+    mGeneration++;
+    mProgram.clear();
+    mColumns.clear();
+    mStackDepth = 0;
+    mError.clear();
+    mMatchCache.clear();
+}
+
+//--------------------------------------------------------------
+// [SECTION] Evaluation
+//--------------------------------------------------------------
+
+void ProcessFilter::Evaluate(const std::vector<ProcessEntry*>& entries)
+{
+    if (mProgram.empty()) {
+        return;
+    }
+
+    // Results are kept in the entries and carried over to the next copy of an
+    // unchanged row, so only new and changed rows are gathered and evaluated
+    mPending.clear();
+    for (auto* entry : entries) {
+        if (entry->GetFilterGeneration() != mGeneration) {
+            mPending.emplace_back(entry);
+        }
+    }
+    if (mPending.empty()) {
+        return;
+    }
+
+    Gather(mPending);
+
+    // Interned strings don't change while in use, so matches are remembered until the next compile
+    mStack.resize(mStackDepth);
+    mMatchCache.resize(mProgram.size());
+    mPassed.resize(mPending.size());
+
+    for (size_t begin = 0; begin < mPending.size(); begin += BATCH_SIZE) {
+        RunBatch(begin, std::min(BATCH_SIZE, mPending.size() - begin), mPassed.data() + begin);
+    }
+
+    for (size_t row = 0; row < mPending.size(); row++) {
+        mPending[row]->SetFilterResult(mGeneration, mPassed[row] != 0);
+    }
+}
+
+bool ProcessFilter::Passes(const ProcessEntry* entry) const
+{
+    return mProgram.empty() || entry->PassesFilter(mGeneration);
+}
+
+void ProcessFilter::Gather(const std::vector<ProcessEntry*>& entries)
+{
+    // Only the columns the program reads are copied out of the entries
+    const int maxColumn = *std::max_element(mColumns.begin(), mColumns.end());
+    mNumbers.resize((size_t)maxColumn + 1);
+    mStrings.resize((size_t)maxColumn + 1);
+
+    for (const int column : mColumns) {
+        if (IsStringColumn(column)) {
+            auto& values = mStrings[column];
+            values.resize(entries.size());
+            for (size_t row = 0; row < entries.size(); row++) {
+                values[row] = GetString(entries[row], column);
+            }
+        } else {
+            auto& values = mNumbers[column];
+            values.resize(entries.size());
+            for (size_t row = 0; row < entries.size(); row++) {
+                values[row] = GetNumber(entries[row], column);
+            }
+        }
+    }
+}
+
+void ProcessFilter::RunBatch(const size_t begin, const size_t count, uint8_t* result)
+{
+    size_t top = 0;
+    for (size_t i = 0; i < mProgram.size(); i++) {
+        const auto& instruction = mProgram[i];
+        switch (instruction.Code) {
+        case OpCode::CompareNumber:
+            CompareNumbers(instruction, mNumbers[instruction.Column].data() + begin, mStack[top++].data(), count);
+            break;
+        case OpCode::CompareString:
+        case OpCode::Contains:
+        case OpCode::NotContains:
+            MatchStrings(i, mStrings[instruction.Column].data() + begin, mStack[top++].data(), count);
+            break;
+        case OpCode::And: {
+            uint8_t* lhs = mStack[top - 2].data();
+            const uint8_t* rhs = mStack[top - 1].data();
+            for (size_t row = 0; row < count; row++) {
+                lhs[row] &= rhs[row];
+            }
+            top--;
+        } break;
+        case OpCode::Or: {
+            uint8_t* lhs = mStack[top - 2].data();
+            const uint8_t* rhs = mStack[top - 1].data();
+            for (size_t row = 0; row < count; row++) {
+                lhs[row] |= rhs[row];
+            }
+            top--;
+        } break;
+        case OpCode::Not: {
+            uint8_t* mask = mStack[top - 1].data();
+            for (size_t row = 0; row < count; row++) {
+                mask[row] ^= 1;
+            }
+        } break;
+        }
+    }
+
+    std::memcpy(result, mStack[0].data(), count);
+}
+
+void ProcessFilter::CompareNumbers(const Instruction& instruction, const double* values, uint8_t* mask, const size_t count) const
+{
+    // One branch-free loop per operator
+    const double number = instruction.Number;
+    switch (instruction.Op) {
+    case CompareOp::Less:
+        for (size_t row = 0; row < count; row++) {
+            mask[row] = values[row] < number;
+        }
+        break;
+    case CompareOp::LessEqual:
+        for (size_t row = 0; row < count; row++) {
+            mask[row] = values[row] <= number;
+        }
+        break;
+    case CompareOp::Greater:
+        for (size_t row = 0; row < count; row++) {
+            mask[row] = values[row] > number;
+        }
+        break;
+    case CompareOp::GreaterEqual:
+        for (size_t row = 0; row < count; row++) {
+            mask[row] = values[row] >= number;
+        }
+        break;
+    case CompareOp::Equal:
+        for (size_t row = 0; row < count; row++) {
+            mask[row] = values[row] == number;
+        }
+        break;
+    case CompareOp::NotEqual:
+        for (size_t row = 0; row < count; row++) {
+            mask[row] = values[row] != number;
+        }
+        break;
+    }
+}
+
+void ProcessFilter::MatchStrings(const size_t instructionIndex, const StringPool::Id* ids, uint8_t* mask, const size_t count)
+{
+    const auto& instruction = mProgram[instructionIndex];
+    auto& cache = mMatchCache[instructionIndex];
+    auto& pool = StringPool::Get();
+
+    // Ids of dropped strings get reused, so matches cached for them no longer hold
+    if (mPoolGeneration != pool.GetGeneration()) {
+        mPoolGeneration = pool.GetGeneration();
+        for (auto& instructionCache : mMatchCache) {
+            instructionCache.clear();
+        }
+    }
+
+    // Many rows share a string (svchost.exe, chrome.exe...), so each id is matched once
+    for (size_t row = 0; row < count; row++) {
+        const StringPool::Id id = ids[row];
+        if (id >= cache.size()) {
+            cache.resize(pool.Size(), 0);
+        }
+
+        if (cache[id] == 0) {
+            const auto text = pool.View(id);
+            bool match;
+            if (instruction.Code == OpCode::CompareString) {
+                const bool equal = text.size() == instruction.Text.size() && StringPool::CompareNoCase(text, instruction.Text) == 0;
+                match = (instruction.Op == CompareOp::Equal) == equal;
+            } else {
+                bool contains = instruction.Text.empty();
+                for (size_t i = 0; !contains && i + instruction.Text.size() <= text.size(); i++) {
+                    contains = StringPool::CompareNoCase(text.substr(i, instruction.Text.size()), instruction.Text) == 0;
+                }
+                match = (instruction.Code == OpCode::Contains) == contains;
+            }
+            cache[id] = match ? 2 : 1;
+        }
+        mask[row] = cache[id] == 2;
+    }
+}
+
+}
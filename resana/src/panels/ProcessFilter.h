@@ -0,0 +1,103 @@
+#pragma once
+
+#include "helpers/StringPool.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace RESANA {
+
+class ProcessEntry;
+
+/*
+ * Filter expressions over the process table columns, e.g.
+ *
+ *     cpu > 5 && rss > 1G && name ~ "java"
+ *
+ * An expression is compiled once into a postfix program. Evaluation gathers
+ * the referenced columns into contiguous arrays, then runs each instruction
+ * over a batch of rows at a time, so the inner loops are plain array
+ * comparisons the compiler can vectorise.
+ *
+ * Numbers accept K, M, G and T suffixes (powers of 1024). Strings compare
+ * with ==, != and ~ / !~ (contains), ignoring case.
+ */
+class ProcessFilter {
+public:
+    // Returns false and sets the error message if the expression is invalid
+    bool Compile(std::string_view expression);
+    void Clear();
+
+    [[nodiscard]] bool IsEmpty() const { return mProgram.empty(); }
+    [[nodiscard]] const std::string& GetError() const { return mError; }
+    [[nodiscard]] const std::vector<int>& GetColumns() const { return mColumns; }
+
+    // Evaluates the given entries that have no result for the current expression, and stores the
+    // result in each. After a Compile that has to be every entry, after that only the changed ones.
+    void Evaluate(const std::vector<ProcessEntry*>& entries);
+    [[nodiscard]] bool Passes(const ProcessEntry* entry) const;
+
+private:
+    enum class OpCode {
+        CompareNumber,
+        CompareString,
+        Contains,
+        NotContains,
+        And,
+        Or,
+        Not,
+    };
+
+    enum class CompareOp {
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+        Equal,
+        NotEqual,
+    };
+
+    struct Instruction {
+        OpCode Code {};
+        int Column = -1; // A ProcessMenu value
+        CompareOp Op {};
+        double Number {};
+        std::string Text {}; // Lower case
+    };
+
+    struct Token;
+    class Parser;
+
+    static bool IsStringColumn(int column);
+    static double GetNumber(const ProcessEntry* entry, int column);
+    static StringPool::Id GetString(const ProcessEntry* entry, int column);
+
+    void Gather(const std::vector<ProcessEntry*>& entries);
+    void RunBatch(size_t begin, size_t count, uint8_t* result);
+    void CompareNumbers(const Instruction& instruction, const double* values, uint8_t* mask, size_t count) const;
+    void MatchStrings(size_t instructionIndex, const StringPool::Id* ids, uint8_t* mask, size_t count);
+
+private:
+    static constexpr size_t BATCH_SIZE = 1024;
+
+    std::vector<Instruction> mProgram {};
+    std::vector<int> mColumns {}; // Referenced by the program
+    size_t mStackDepth = 0;
+    std::string mError {};
+
+    uint32_t mGeneration = 0; // Bumped by every Compile and Clear
+
+    // Evaluation state, reused between calls
+    std::vector<ProcessEntry*> mPending {};                 // Rows without a result
+    std::vector<uint8_t> mPassed {};
+    std::vector<std::vector<double>> mNumbers {};           // Per column, numeric ones only
+    std::vector<std::vector<StringPool::Id>> mStrings {};   // Per column, string ones only
+    std::vector<std::vector<uint8_t>> mMatchCache {};       // Per instruction, by string id: 0 unknown, 1 no, 2 yes
+    uint32_t mPoolGeneration {};                            // Of the string pool the cache was filled against
+    std::vector<std::array<uint8_t, BATCH_SIZE>> mStack {};
+};
+
+}
@@ -36,6 +36,7 @@ void ProcessPanel::OnDetach()
 {
     mPanelOpen = false;
     ProcessManager::Shutdown();
+    PerfCounterCollector::Shutdown();
 }
 
 void ProcessPanel::OnUpdate(const Timestep ts)
@@ -69,6 +70,41 @@ void ProcessPanel::UpdateProcessList()
                 mDataCache.Copy(data.get());
                 mDataCache.SelectEntry(backupId); // Set selected process (if any)
                 mDataCache.SetDirty();
+                mFilterDirty = true;
+
+                // Threads and modules of the selected process
+                auto threads = mProcessManager->GetThreads(backupId);
+                auto modules = mProcessManager->GetModules(backupId);
+                FdBreakdown fdBreakdown;
+                const bool hasFdBreakdown = mProcessManager->GetFdBreakdown(backupId, fdBreakdown);
+                std::scoped_lock detailLock(mDetailMutex);
+                mThreadCache = std::move(threads);
+                mModuleCache = std::move(modules);
+                mFdBreakdown = fdBreakdown;
+                mHasFdBreakdown = hasFdBreakdown;
+                mDetailCacheId = backupId;
+                mThreadCacheDirty = true;
+                mModuleCacheDirty = true;
+
+                if (mShowExited) {
+                    mExitedCache = mProcessManager->GetExitedGroups();
+                    mCapturingExits = mProcessManager->IsCapturingExits();
+                    mExitedCacheDirty = true;
+                }
+
+                if (mShowTop) {
+                    for (int metric = 0; metric < Top_Count; metric++) {
+                        mTopCache[metric] = mProcessManager->GetTopConsumers((TopMetric)metric, TOP_COUNT);
+                    }
+                }
+
+                if (mGroupByCgroup) {
+                    mCgroupCache = mProcessManager->GetCgroups();
+                    mCgroupChildren.clear();
+                    for (uint32_t i = 0; i < (uint32_t)mCgroupCache.size(); i++) {
+                        mCgroupChildren[mCgroupCache[i].Parent].emplace_back(i);
+                    }
+                }
             }
             mProcessManager->ReleaseData();
         }
@@ -80,11 +116,17 @@ void ProcessPanel::ShowPanel(bool* pOpen)
     if ((mPanelOpen = *pOpen)) {
         if (ImGui::BeginChild("Details", ImGui::GetContentRegionAvail())) {
             ProcessManager::Run();
+            mCountersShown = false;
             ShowProcessTable();
+
+            // Counters attach to the selected process only, and only while its Counters tab is drawn
+            PerfCounterCollector::WatchProcess(mCountersShown ? mSelectedId : (unsigned long)-1);
+            PerfCounterCollector::Run();
         }
         ImGui::EndChild();
     } else {
         ProcessManager::Stop();
+        PerfCounterCollector::WatchProcess((unsigned long)-1);
     }
 }
 
@@ -94,10 +136,23 @@ void ProcessPanel::ShowPanelMenu()
     {
         ImGui::MenuItem("Process ID", nullptr, GetMenuOption(View_ProcessId));
         ImGui::MenuItem("Parent Process ID", nullptr, GetMenuOption(View_ParentProcessId));
-        ImGui::MenuItem("Module ID", nullptr, GetMenuOption(View_ModuleId));
+        ImGui::MenuItem("Module Count", nullptr, GetMenuOption(View_ModuleCount));
         ImGui::MenuItem("Memory Usage", nullptr, GetMenuOption(View_MemoryUsage));
         ImGui::MenuItem("Thread Count", nullptr, GetMenuOption(View_ThreadCount));
         ImGui::MenuItem("Priority Class", nullptr, GetMenuOption(View_PriorityClass));
+        ImGui::MenuItem("CPU Usage", nullptr, GetMenuOption(View_CpuUsage));
+        ImGui::MenuItem("Command Line", nullptr, GetMenuOption(View_CommandLine));
+        ImGui::MenuItem("Disk Read Rate", nullptr, GetMenuOption(View_DiskRead));
+        ImGui::MenuItem("Disk Write Rate", nullptr, GetMenuOption(View_DiskWrite));
+        ImGui::MenuItem("Open Descriptors", nullptr, GetMenuOption(View_FdCount));
+        ImGui::Separator();
+        ImGui::MenuItem("Process Tree", nullptr, &mShowTree);
+        ImGui::MenuItem("Group by Cgroup", nullptr, &mGroupByCgroup, mProcessManager->HasCgroups());
+        ImGui::MenuItem("Top Consumers", nullptr, &mShowTop);
+        if (ImGui::MenuItem("Recently Exited", nullptr, &mShowExited)) {
+            // Short-lived processes are only captured while someone is looking
+            mProcessManager->SetExitCapture(mShowExited);
+        }
     }
 
     // Update number of columns needed
@@ -115,6 +170,12 @@ void ProcessPanel::SortTableEntries()
 
     // Sort our data if sort specs have been changed!
     if (ImGuiTableSortSpecs* sortSpecs = ImGui::TableGetSortSpecs()) {
+        // Sorting by an expensive field needs it for every process
+        mSortFields = Detail_None;
+        for (int n = 0; n < sortSpecs->SpecsCount; n++) {
+            mSortFields |= GetDetailField(sortSpecs->Specs[n].ColumnUserID);
+        }
+
         if (sortSpecs->SpecsDirty || mDataCache.IsDirty()) {
             sCurrentSortSpecs = sortSpecs; // Store in variable accessible by the sort function.
             if (entries.size() > 1) {
@@ -139,25 +200,23 @@ bool ProcessPanel::CompareWithSortSpecs(const void* lhs, const void* rhs)
         int delta = 0;
 
         switch (sortSpec->ColumnUserID) {
-        case View_ProcessName: {
-            std::string lStr = a->GetName();
-            std::string rStr = b->GetName();
-            // Transform to upper for consistent differences regardless of case
-            std::transform(lStr.begin(), lStr.end(), lStr.begin(), [](auto c) { return std::tolower(c); });
-            std::transform(rStr.begin(), rStr.end(), rStr.begin(), [](auto c) { return std::tolower(c); });
-            delta = lStr.compare(rStr);
-        } break;
+        case View_ProcessName:
+            // Equal ids are equal names; otherwise compare in place, regardless of case
+            if (a->GetNameId() != b->GetNameId()) {
+                delta = StringPool::CompareNoCase(a->GetName(), b->GetName());
+            }
+            break;
         case View_ProcessId:
             delta = (int)(a->GetProcessId() - b->GetProcessId());
             break;
         case View_ParentProcessId:
             delta = (int)(a->GetParentProcessId() - b->GetParentProcessId());
             break;
-        case View_ModuleId:
-            delta = (int)(a->GetModuleId() - b->GetModuleId());
+        case View_ModuleCount:
+            delta = (int)(a->GetModuleCount() - b->GetModuleCount());
             break;
         case View_MemoryUsage:
-            delta = (int)(a->GetMemoryUsage() - b->GetMemoryUsage());
+            delta = (a->GetMemoryUsage() > b->GetMemoryUsage()) - (a->GetMemoryUsage() < b->GetMemoryUsage());
             break;
         case View_ThreadCount:
             delta = (int)(a->GetThreadCount() - b->GetThreadCount());
@@ -165,6 +224,23 @@ bool ProcessPanel::CompareWithSortSpecs(const void* lhs, const void* rhs)
         case View_PriorityClass:
             delta = (int)(a->GetPriorityClass() - b->GetPriorityClass());
             break;
+        case View_CpuUsage:
+            delta = (a->GetCpuLoad() > b->GetCpuLoad()) - (a->GetCpuLoad() < b->GetCpuLoad());
+            break;
+        case View_DiskRead:
+            delta = (a->GetIoRates().ReadBytes > b->GetIoRates().ReadBytes) - (a->GetIoRates().ReadBytes < b->GetIoRates().ReadBytes);
+            break;
+        case View_DiskWrite:
+            delta = (a->GetIoRates().WriteBytes > b->GetIoRates().WriteBytes) - (a->GetIoRates().WriteBytes < b->GetIoRates().WriteBytes);
+            break;
+        case View_FdCount:
+            delta = (int)a->GetFdStats().Count - (int)b->GetFdStats().Count;
+            break;
+        case View_CommandLine:
+            if (a->GetCommandLineId() != b->GetCommandLineId()) {
+                delta = StringPool::CompareNoCase(a->GetCommandLine(), b->GetCommandLine());
+            }
+            break;
         default:
             RS_CORE_ASSERT(false, "Unknown column!")
             break;
@@ -204,9 +280,129 @@ bool* ProcessPanel::GetMenuOption(ProcessMenu option)
     return &mMenuMap[option];
 }
 
+void ProcessPanel::ShowSearchBar()
+{
+    auto& index = mProcessManager->GetSearchIndex();
+
+    ImGui::SetNextItemWidth(240.0f);
+    if (ImGui::InputTextWithHint("##search", "Search name, PID or command line", mSearchText, sizeof(mSearchText))) {
+        index.SetQuery(mSearchText);
+        mSearching = mSearchText[0] != '\0';
+    }
+
+    if (!mSearching) {
+        mSearchResults.clear();
+        return;
+    }
+
+    // Only a slice of the candidates is checked each frame
+    mSearchComplete = index.Step(SEARCH_BUDGET);
+    index.PollResults(mSearchCursor, mSearchResults);
+
+    ImGui::SameLine();
+    if (mSearchComplete) {
+        ImGui::Text("%d matches", (int)mSearchResults.size());
+    } else {
+        ImGui::Text("Searching... %d matches", (int)mSearchResults.size());
+    }
+}
+
+void ProcessPanel::ShowFilterBar()
+{
+    ImGui::SetNextItemWidth(320.0f);
+    if (ImGui::InputTextWithHint("##filter", "Filter, e.g. cpu > 5 && rss > 1G && name ~ java", mFilterText, sizeof(mFilterText))) {
+        mFilter.Compile(mFilterText);
+        mFilterCompiled = true;
+    }
+
+    if (!mFilter.GetError().empty()) {
+        ImGui::SameLine();
+        ImGui::TextColored({ 0.9f, 0.2f, 0.2f, 1.0f }, "%s", mFilter.GetError().c_str());
+    }
+}
+
+void ProcessPanel::ShowScanStats() const
+{
+    const ScanStats stats = mProcessManager->GetScanStats();
+
+    ImGui::TextDisabled("Scan every %.2f s", stats.EffectiveInterval / 1000.0f);
+    if (ImGui::IsItemHovered()) {
+        ImGui::BeginTooltip();
+        ImGui::Text("Update speed: %.2f s", stats.BaseInterval / 1000.0f);
+        ImGui::Text("Churn: %.1f processes per scan", stats.Churn);
+        ImGui::Text("Scan cost: %.2f ms", stats.ScanCost);
+        ImGui::Text("Overhead: %.2f%% of a core", stats.Overhead);
+        // Against rescanning every field at the update speed; bursts may cost more
+        ImGui::Text("Saved: %.2f%% of a core", stats.FixedOverhead - stats.Overhead);
+        ImGui::EndTooltip();
+    }
+}
+
+void ProcessPanel::ShowTopConsumers()
+{
+    static ImGuiTableFlags tableFlags = ImGuiTableFlags_Borders | ImGuiTableFlags_SizingStretchSame | ImGuiTableFlags_NoSavedSettings;
+    if (!ImGui::BeginTable("top_table", Top_Count, tableFlags)) {
+        return;
+    }
+
+    ImGui::TableSetupColumn("Top CPU");
+    ImGui::TableSetupColumn("Top Memory");
+    ImGui::TableSetupColumn("Top Disk Read");
+    ImGui::TableSetupColumn("Top Disk Write");
+    ImGui::TableHeadersRow();
+
+    std::scoped_lock locks(mDataCache.GetMutex(), mDetailMutex);
+    for (size_t row = 0; row < TOP_COUNT; row++) {
+        ImGui::TableNextRow();
+        for (int metric = 0; metric < Top_Count; metric++) {
+            ImGui::TableNextColumn();
+            if (row >= mTopCache[metric].size()) {
+                continue;
+            }
+
+            // Ranked by the manager; the table only supplies the name
+            const auto& top = mTopCache[metric][row];
+            const auto* entry = mDataCache.FindEntry((uint32_t)top.ProcessId);
+            const char* name = entry ? entry->GetName() : "?";
+            switch (metric) {
+            case Top_Cpu:
+                ImGui::Text("%s  %.1f%%", name, top.Value);
+                break;
+            case Top_Memory:
+                ImGui::Text("%s  %llu K", name, (unsigned long long)(top.Value / 1024.0));
+                break;
+            default:
+                ImGui::Text("%s  %.1f KB/s", name, top.Value / 1024.0);
+                break;
+            }
+        }
+    }
+    ImGui::EndTable();
+}
+
+bool ProcessPanel::IsRowHidden(const ProcessEntry* entry) const
+{
+    if (!mFilter.Passes(entry)) {
+        return true;
+    }
+    return mSearching && mSearchResults.count(entry->GetProcessId()) == 0;
+}
+
 void ProcessPanel::ShowProcessTable()
 {
-    const auto outerSize = ImVec2(-1.0f, ImGui::GetContentRegionAvail().y);
+    ShowSearchBar();
+    ImGui::SameLine();
+    ShowFilterBar();
+    ImGui::SameLine();
+    ShowScanStats();
+
+    if (mShowTop) {
+        ShowTopConsumers();
+    }
+
+    // Leave room for the details of the selected process
+    const float detailsHeight = (mDataCache.GetSelectedEntry() || mShowExited) ? DETAILS_HEIGHT : 0.0f;
+    const auto outerSize = ImVec2(-1.0f, ImGui::GetContentRegionAvail().y - detailsHeight);
 
     ImGui::PushStyleColor(ImGuiCol_Text, { 0.0f, 0.0f, 0.0f, 1.0f });
     ImGui::PushStyleColor(ImGuiCol_TableHeaderBg, { 1.0f, 1.0f, 1.0f, 1.0f });
@@ -214,13 +410,11 @@ void ProcessPanel::ShowProcessTable()
     ImGui::PushStyleColor(ImGuiCol_TableBorderLight, { 1.0f, 1.0f, 1.0f, 1.0f });
 
     CalcTableColumnCount();
+    mVisibleIds.clear();
 
     static ImGuiTableFlags tableFlags = ImGuiTableFlags_Sortable | ImGuiTableFlags_ScrollX | ImGuiTableFlags_ScrollY | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_Reorderable | ImGuiTableFlags_NoSavedSettings;
 
     if (ImGui::BeginTable("proc_table", (int)GetTableColumnCount(), tableFlags, outerSize)) {
-        static bool showColWidthRow;
-        showColWidthRow = true;
-
         SetupTableColumns();
 
         // Lock the data and read the entries
@@ -228,64 +422,870 @@ void ProcessPanel::ShowProcessTable()
 
         SortTableEntries();
 
-        for (const auto& entry : mDataCache.GetEntries()) {
-            ImGui::TableNextRow();
-            ImGui::TableNextColumn();
+        // Results are stored per entry, so a sort doesn't need them redone
+        if (mFilterCompiled) {
+            mFilterCompiled = false;
+            mFilterDirty = false;
+            mFilter.Evaluate(mDataCache.GetEntries());
+        } else if (mFilterDirty.exchange(false)) {
+            mFilter.Evaluate(mDataCache.GetChangedEntries());
+        }
+
+        // Matches are listed flat, their ancestors may not match
+        if (mGroupByCgroup && !mSearching && mFilter.IsEmpty()) {
+            ShowCgroupTree();
+        } else if (mShowTree && !mSearching && mFilter.IsEmpty()) {
+            ShowProcessTree();
+        } else {
+            ShowProcessRows();
+        }
+        ImGui::EndTable();
+    }
+    ImGui::PopStyleColor(4);
+
+    if (detailsHeight > 0.0f) {
+        ShowProcessDetails();
+    }
+
+    UpdateWatchedProcesses();
+    UpdateDetailDemand();
+}
+
+void ProcessPanel::UpdateWatchedProcesses()
+{
+    const auto* selected = mDataCache.GetSelectedEntry();
+    const unsigned long selectedId = selected ? selected->GetProcessId() : (unsigned long)-1;
+    if (selectedId != mSelectedId) {
+        mSelectedId = selectedId;
+        mProcessManager->SelectProcess(mSelectedId);
+    }
 
-            /* [DEBUG]
-             * Show width of each column in the first row. */
-            if (showColWidthRow) {
-                ImGui::Text("%.2f", ImGui::GetContentRegionAvail().x);
+    std::vector<unsigned long> watched;
+    if (selected) {
+        watched.emplace_back(selectedId);
+    }
+    if (mShowTree && !mGroupByCgroup && !mSearching && mFilter.IsEmpty()) {
+        watched.insert(watched.end(), mExpandedIds.begin(), mExpandedIds.end());
+    }
+
+    // Only tell the manager when the set actually changes
+    if (watched != mWatchedIds) {
+        mWatchedIds = std::move(watched);
+        mProcessManager->WatchThreads(mWatchedIds);
+    }
+}
+
+void ProcessPanel::UpdateDetailDemand()
+{
+    DetailDemand demand;
+    demand.Visible = mVisibleIds;
+    std::sort(demand.Visible.begin(), demand.Visible.end());
+
+    for (const auto column : { View_CommandLine, View_DiskRead, View_DiskWrite, View_FdCount, View_ModuleCount }) {
+        if (CheckMenuOption(column)) {
+            demand.VisibleFields |= GetDetailField(column);
+        }
+    }
+
+    demand.AllFields = mSortFields;
+    for (const int column : mFilter.GetColumns()) {
+        demand.AllFields |= GetDetailField(column);
+    }
+    if (mSearching) {
+        demand.AllFields |= Detail_CommandLine; // Searched along with the name
+    }
+    if (mGroupByCgroup) {
+        demand.AllFields |= Detail_Cgroup;
+    }
+
+    // Only tell the manager when the demand actually changes, e.g. on scrolling
+    if (demand != mDetailDemand) {
+        mDetailDemand = demand;
+        mProcessManager->SetDetailDemand(std::move(demand));
+    }
+}
+
+uint32_t ProcessPanel::GetDetailField(const int column)
+{
+    switch (column) {
+    case View_CommandLine:
+        return Detail_CommandLine;
+    case View_DiskRead:
+    case View_DiskWrite:
+        return Detail_Io;
+    case View_FdCount:
+        return Detail_Fd;
+    case View_ModuleCount:
+        return Detail_Modules;
+    default:
+        return Detail_None;
+    }
+}
+
+void ProcessPanel::ShowProcessDetails()
+{
+    std::scoped_lock detailLock(mDetailMutex);
+
+    const auto* selected = mDataCache.GetSelectedEntry();
+    const bool hasDetails = selected && selected->GetProcessId() == mDetailCacheId;
+    if (selected && !hasDetails && !mShowExited) {
+        ImGui::TextUnformatted("Collecting process details...");
+        return;
+    }
+
+    if (ImGui::BeginTabBar("proc_details")) {
+        static char label[32];
+        if (hasDetails) {
+            snprintf(label, sizeof(label), "Threads (%d)###threads", (int)mThreadCache.size());
+            if (ImGui::BeginTabItem(label)) {
+                ShowThreadTable();
+                ImGui::EndTabItem();
+            }
+
+            snprintf(label, sizeof(label), "Modules (%d)###modules", (int)mModuleCache.size());
+            if (ImGui::BeginTabItem(label)) {
+                ShowModuleTable();
+                ImGui::EndTabItem();
+            }
+
+            if (FdCollector::HAS_BREAKDOWN && ImGui::BeginTabItem("Descriptors")) {
+                ShowFdBreakdown();
+                ImGui::EndTabItem();
+            }
+
+            if (ImGui::BeginTabItem("Counters")) {
+                mCountersShown = true;
+                ShowPerfCounters();
+                ImGui::EndTabItem();
+            }
+        }
+
+        if (mShowExited) {
+            snprintf(label, sizeof(label), "Recently Exited (%d)###exited", (int)mExitedCache.size());
+            if (ImGui::BeginTabItem(label)) {
+                ShowExitedTable();
+                ImGui::EndTabItem();
+            }
+        }
+        ImGui::EndTabBar();
+    }
+}
+
+void ProcessPanel::ShowExitedTable()
+{
+    if (!mCapturingExits) {
+        ImGui::TextDisabled("Exit capture unavailable, processes that exit between scans are not listed");
+    }
+
+    static ImGuiTableFlags tableFlags = ImGuiTableFlags_Sortable | ImGuiTableFlags_ScrollY | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_NoSavedSettings;
+    const auto outerSize = ImVec2(-1.0f, ImGui::GetContentRegionAvail().y);
+
+    if (ImGui::BeginTable("exited_table", 7, tableFlags, outerSize)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthFixed, 160.0f, Exited_Name);
+        ImGui::TableSetupColumn("Exits", ImGuiTableColumnFlags_PreferSortDescending | ImGuiTableColumnFlags_WidthFixed, 0.0f, Exited_Count);
+        ImGui::TableSetupColumn("Between Scans", ImGuiTableColumnFlags_PreferSortDescending | ImGuiTableColumnFlags_WidthFixed, 0.0f, Exited_Unseen);
+        ImGui::TableSetupColumn("Spawns/min", ImGuiTableColumnFlags_PreferSortDescending | ImGuiTableColumnFlags_WidthFixed, 0.0f, Exited_SpawnRate);
+        ImGui::TableSetupColumn("CPU Time", ImGuiTableColumnFlags_PreferSortDescending | ImGuiTableColumnFlags_WidthFixed, 0.0f, Exited_CpuTime);
+        ImGui::TableSetupColumn("Peak Memory", ImGuiTableColumnFlags_PreferSortDescending | ImGuiTableColumnFlags_WidthFixed, 0.0f, Exited_PeakMemory);
+        ImGui::TableSetupColumn("Last Exit", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_WidthFixed, 0.0f, Exited_LastExit);
+        ImGui::TableHeadersRow();
+
+        SortExitedEntries();
+
+        ImGuiListClipper clipper;
+        clipper.Begin((int)mExitedCache.size());
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                const auto& group = mExitedCache[row];
+
+                ImGui::TableNextRow();
                 ImGui::TableNextColumn();
-                ImGui::Text("%.2f", ImGui::GetContentRegionAvail().x);
+                ImGui::TextUnformatted(StringPool::Get().CStr(group.Name));
                 ImGui::TableNextColumn();
-                ImGui::Text("%.2f", ImGui::GetContentRegionAvail().x);
-                ImGui::TableNextRow();
+                ImGui::Text("%llu", (unsigned long long)group.Count);
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", (unsigned long long)group.Unseen);
                 ImGui::TableNextColumn();
-                showColWidthRow = false; // Only called once (first row)
+                ImGui::Text("%.0f", group.SpawnRate);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f s", (double)group.CpuTime / 1.0e7);
+                ImGui::TableNextColumn();
+                if (group.PeakMemory) {
+                    ImGui::Text("%llu K", (unsigned long long)(group.PeakMemory / 1024));
+                } else {
+                    ImGui::TextDisabled("-"); // Only known for scanned processes
+                }
+                ImGui::TableNextColumn();
+                ImGui::Text("%.0f s ago", group.SecondsAgo);
             }
+        }
+        ImGui::EndTable();
+    }
+}
 
-            {
-                // Lock the entry
-                std::scoped_lock entryLock(entry->Mutex());
+void ProcessPanel::ShowThreadTable()
+{
 
-                static char uniqueId[64];
-                sprintf_s(uniqueId, "##%lu", entry->GetProcessId());
+    static ImGuiTableFlags tableFlags = ImGuiTableFlags_Sortable | ImGuiTableFlags_ScrollY | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_NoSavedSettings;
+    const auto outerSize = ImVec2(-1.0f, ImGui::GetContentRegionAvail().y);
 
-                if (ImGui::Selectable(entry->GetName().c_str(), entry->IsSelected(),
-                        ImGuiSelectableFlags_SpanAllColumns, ImGui::GetColumnWidth(-1), uniqueId)) {
-                    mDataCache.SelectEntry(entry);
-                }
+    if (ImGui::BeginTable("thread_table", 7, tableFlags, outerSize)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("TID", ImGuiTableColumnFlags_WidthFixed, 60.0f, Thread_Id);
+        ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthFixed, 140.0f, Thread_Name);
+        ImGui::TableSetupColumn("State", ImGuiTableColumnFlags_WidthFixed, 0.0f, Thread_State);
+        ImGui::TableSetupColumn("CPU", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending | ImGuiTableColumnFlags_WidthFixed, 0.0f, Thread_CpuUsage);
+        ImGui::TableSetupColumn("CPU Time", ImGuiTableColumnFlags_WidthFixed, 0.0f, Thread_CpuTime);
+        ImGui::TableSetupColumn("Last CPU", ImGuiTableColumnFlags_WidthFixed, 0.0f, Thread_LastCpu);
+        ImGui::TableSetupColumn("Priority", ImGuiTableColumnFlags_WidthFixed, 0.0f, Thread_Priority);
+        ImGui::TableHeadersRow();
 
-                if (CheckMenuOption(View_ProcessId)) {
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%lu", entry->GetProcessId());
-                }
-                if (CheckMenuOption(View_ParentProcessId)) {
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%lu", entry->GetParentProcessId());
-                }
-                if (CheckMenuOption(View_ModuleId)) {
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%lu", entry->GetModuleId());
-                }
-                if (CheckMenuOption(View_MemoryUsage)) {
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%lu", entry->GetMemoryUsage());
-                }
-                if (CheckMenuOption(View_ThreadCount)) {
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%lu", entry->GetThreadCount());
+        SortThreadEntries();
+
+        ImGuiListClipper clipper;
+        clipper.Begin((int)mThreadCache.size());
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                const auto& thread = mThreadCache[row];
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%lu", thread.ThreadId);
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(StringPool::Get().CStr(thread.Name));
+                ImGui::TableNextColumn();
+                ImGui::Text("%c", thread.State);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f%%", thread.CpuLoad);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f s", (double)thread.CpuTime / 1.0e7);
+                ImGui::TableNextColumn();
+                if (thread.LastCpu >= 0) {
+                    ImGui::Text("%d", thread.LastCpu);
+                } else {
+                    ImGui::TextUnformatted("-");
                 }
-                if (CheckMenuOption(View_PriorityClass)) {
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%lu", entry->GetPriorityClass());
+                ImGui::TableNextColumn();
+                ImGui::Text("%ld", thread.Priority);
+            }
+        }
+        ImGui::EndTable();
+    }
+}
+
+void ProcessPanel::ShowModuleTable()
+{
+    static ImGuiTableFlags tableFlags = ImGuiTableFlags_Sortable | ImGuiTableFlags_ScrollY | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_NoSavedSettings;
+    const auto outerSize = ImVec2(-1.0f, ImGui::GetContentRegionAvail().y);
+
+    if (ImGui::BeginTable("module_table", 5, tableFlags, outerSize)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Name", ImGuiTableColumnFlags_WidthFixed, 160.0f, Module_Name);
+        ImGui::TableSetupColumn("Resident", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending | ImGuiTableColumnFlags_WidthFixed, 0.0f, Module_Resident);
+        ImGui::TableSetupColumn("Size", ImGuiTableColumnFlags_WidthFixed, 0.0f, Module_Size);
+        ImGui::TableSetupColumn("Mappings", ImGuiTableColumnFlags_WidthFixed, 0.0f, Module_Mappings);
+        ImGui::TableSetupColumn("Path", ImGuiTableColumnFlags_WidthStretch, 0.0f, Module_Path);
+        ImGui::TableHeadersRow();
+
+        SortModuleEntries();
+
+        ImGuiListClipper clipper;
+        clipper.Begin((int)mModuleCache.size());
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                const auto& module = mModuleCache[row];
+                const auto path = StringPool::Get().View(module.PathId);
+                const auto lastSlash = path.find_last_of("/\\");
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(path.data() + (lastSlash == std::string_view::npos ? 0 : lastSlash + 1));
+                ImGui::TableNextColumn();
+                if (module.Resident > 0) {
+                    ImGui::Text("%llu K", (unsigned long long)(module.Resident / 1024));
+                } else {
+                    ImGui::TextUnformatted("-");
                 }
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu K", (unsigned long long)(module.Size / 1024));
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", module.MappingCount);
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(path.data());
             }
         }
         ImGui::EndTable();
     }
-    ImGui::PopStyleColor(4);
+}
+
+void ProcessPanel::ShowFdBreakdown()
+{
+    if (!mHasFdBreakdown) {
+        ImGui::TextUnformatted("Open descriptors are not available for this process.");
+        return;
+    }
+
+    static ImGuiTableFlags tableFlags = ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_NoSavedSettings;
+    if (ImGui::BeginTable("fd_table", 2, tableFlags)) {
+        const auto showRow = [](const char* type, const uint32_t count) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(type);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", count);
+        };
+
+        showRow("Files", mFdBreakdown.Files);
+        showRow("Sockets", mFdBreakdown.Sockets);
+        showRow("Pipes", mFdBreakdown.Pipes);
+        showRow("Anonymous inodes", mFdBreakdown.AnonInodes);
+        showRow("Other", mFdBreakdown.Other);
+        ImGui::EndTable();
+    }
+}
+
+void ProcessPanel::ShowPerfCounters() const
+{
+    const auto* collector = PerfCounterCollector::Get();
+    if (!collector->IsAvailable()) {
+        ImGui::TextUnformatted("Performance counters are not available.");
+        return;
+    }
+
+    const ProcessPerfRates process = collector->GetProcess();
+    if (process.ProcessId == mSelectedId && process.Denied) {
+        ImGui::TextUnformatted("Not permitted to count events of this process.");
+        return;
+    }
+    if (process.ProcessId != mSelectedId || !process.Rates.Available) {
+        ImGui::TextUnformatted("Collecting counters...");
+        return;
+    }
+
+    const auto& rates = process.Rates;
+    ImGui::Text("%u threads%s%s", process.Threads, process.Truncated ? " (more not counted)" : "",
+                collector->HasHardware() ? "" : ", no PMU exposed, software events only");
+    if (collector->IsUserOnly()) {
+        // perf_event_paranoid of 2, the usual default, only lets user-space events be counted
+        ImGui::TextDisabled("Kernel events not permitted: context switches and migrations are not counted");
+    }
+
+    static ImGuiTableFlags tableFlags = ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_NoSavedSettings;
+    if (ImGui::BeginTable("perf_table", 2, tableFlags)) {
+        for (int counter = 0; counter < PerfCounter_Count; counter++) {
+            if (!rates.Counted[counter]) {
+                continue;
+            }
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(PerfCounterCollector::GetName((PerfCounter)counter));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f/s", rates.Rates[counter]);
+        }
+
+        if (rates.Counted[PerfCounter_Cycles] && rates.Counted[PerfCounter_Instructions] && rates.Rates[PerfCounter_Cycles] > 0.0) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted("Instructions per cycle");
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", rates.Rates[PerfCounter_Instructions] / rates.Rates[PerfCounter_Cycles]);
+        }
+        ImGui::EndTable();
+    }
+}
+
+void ProcessPanel::SortModuleEntries()
+{
+    ImGuiTableSortSpecs* sortSpecs = ImGui::TableGetSortSpecs();
+    if (!sortSpecs || !(sortSpecs->SpecsDirty || mModuleCacheDirty) || sortSpecs->SpecsCount == 0) {
+        return;
+    }
+
+    const ImGuiTableColumnSortSpecs& sortSpec = sortSpecs->Specs[0];
+    const bool ascending = sortSpec.SortDirection == ImGuiSortDirection_Ascending;
+
+    const auto& pool = StringPool::Get();
+    std::sort(mModuleCache.begin(), mModuleCache.end(), [&](const ModuleEntry& a, const ModuleEntry& b) {
+        int delta = 0;
+        switch (sortSpec.ColumnUserID) {
+        case Module_Name:
+            delta = pool.View(a.PathId).substr(pool.View(a.PathId).find_last_of("/\\") + 1)
+                        .compare(pool.View(b.PathId).substr(pool.View(b.PathId).find_last_of("/\\") + 1));
+            break;
+        case Module_Path:
+            delta = (a.PathId != b.PathId) ? pool.View(a.PathId).compare(pool.View(b.PathId)) : 0;
+            break;
+        case Module_Resident:
+            delta = (a.Resident > b.Resident) - (a.Resident < b.Resident);
+            break;
+        case Module_Size:
+            delta = (a.Size > b.Size) - (a.Size < b.Size);
+            break;
+        case Module_Mappings:
+            delta = (int)a.MappingCount - (int)b.MappingCount;
+            break;
+        default:
+            break;
+        }
+        return ascending ? delta < 0 : delta > 0;
+    });
+
+    sortSpecs->SpecsDirty = false;
+    mModuleCacheDirty = false;
+}
+
+void ProcessPanel::SortExitedEntries()
+{
+    ImGuiTableSortSpecs* sortSpecs = ImGui::TableGetSortSpecs();
+    if (!sortSpecs || !(sortSpecs->SpecsDirty || mExitedCacheDirty) || sortSpecs->SpecsCount == 0) {
+        return;
+    }
+
+    const ImGuiTableColumnSortSpecs& sortSpec = sortSpecs->Specs[0];
+    const bool ascending = sortSpec.SortDirection == ImGuiSortDirection_Ascending;
+
+    std::sort(mExitedCache.begin(), mExitedCache.end(), [&](const ExitedGroup& a, const ExitedGroup& b) {
+        int delta = 0;
+        switch (sortSpec.ColumnUserID) {
+        case Exited_Name:
+            delta = (a.Name != b.Name) ? StringPool::CompareNoCase(StringPool::Get().View(a.Name), StringPool::Get().View(b.Name)) : 0;
+            break;
+        case Exited_Count:
+            delta = (a.Count > b.Count) - (a.Count < b.Count);
+            break;
+        case Exited_Unseen:
+            delta = (a.Unseen > b.Unseen) - (a.Unseen < b.Unseen);
+            break;
+        case Exited_SpawnRate:
+            delta = (a.SpawnRate > b.SpawnRate) - (a.SpawnRate < b.SpawnRate);
+            break;
+        case Exited_CpuTime:
+            delta = (a.CpuTime > b.CpuTime) - (a.CpuTime < b.CpuTime);
+            break;
+        case Exited_PeakMemory:
+            delta = (a.PeakMemory > b.PeakMemory) - (a.PeakMemory < b.PeakMemory);
+            break;
+        case Exited_LastExit:
+            delta = (a.SecondsAgo > b.SecondsAgo) - (a.SecondsAgo < b.SecondsAgo);
+            break;
+        default:
+            break;
+        }
+        return ascending ? delta < 0 : delta > 0;
+    });
+
+    sortSpecs->SpecsDirty = false;
+    mExitedCacheDirty = false;
+}
+
+void ProcessPanel::SortThreadEntries()
+{
+    ImGuiTableSortSpecs* sortSpecs = ImGui::TableGetSortSpecs();
+    if (!sortSpecs || !(sortSpecs->SpecsDirty || mThreadCacheDirty) || sortSpecs->SpecsCount == 0) {
+        return;
+    }
+
+    const ImGuiTableColumnSortSpecs& sortSpec = sortSpecs->Specs[0];
+    const bool ascending = sortSpec.SortDirection == ImGuiSortDirection_Ascending;
+
+    std::sort(mThreadCache.begin(), mThreadCache.end(), [&](const ThreadEntry& a, const ThreadEntry& b) {
+        int delta = 0;
+        switch (sortSpec.ColumnUserID) {
+        case Thread_Id:
+            delta = (a.ThreadId > b.ThreadId) - (a.ThreadId < b.ThreadId);
+            break;
+        case Thread_Name:
+            delta = (a.Name != b.Name) ? StringPool::Get().View(a.Name).compare(StringPool::Get().View(b.Name)) : 0;
+            break;
+        case Thread_State:
+            delta = a.State - b.State;
+            break;
+        case Thread_CpuUsage:
+            delta = (a.CpuLoad > b.CpuLoad) - (a.CpuLoad < b.CpuLoad);
+            break;
+        case Thread_CpuTime:
+            delta = (a.CpuTime > b.CpuTime) - (a.CpuTime < b.CpuTime);
+            break;
+        case Thread_LastCpu:
+            delta = a.LastCpu - b.LastCpu;
+            break;
+        case Thread_Priority:
+            delta = (a.Priority > b.Priority) - (a.Priority < b.Priority);
+            break;
+        default:
+            break;
+        }
+        return ascending ? delta < 0 : delta > 0;
+    });
+
+    sortSpecs->SpecsDirty = false;
+    mThreadCacheDirty = false;
+}
+
+void ProcessPanel::ShowProcessRows()
+{
+    const auto& entries = mDataCache.GetEntries();
+    mShownRows.clear();
+    for (size_t row = 0; row < entries.size(); row++) {
+        if (!IsRowHidden(entries[row])) {
+            mShownRows.emplace_back((uint32_t)row);
+        }
+    }
+
+    /* [DEBUG]
+     * Show width of each column in the first row. */
+    if (!mShownRows.empty()) {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::Text("%.2f", ImGui::GetContentRegionAvail().x);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.2f", ImGui::GetContentRegionAvail().x);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.2f", ImGui::GetContentRegionAvail().x);
+    }
+
+    // Only the rows in view are drawn, and only their expensive fields are fetched
+    ImGuiListClipper clipper;
+    clipper.Begin((int)mShownRows.size());
+    while (clipper.Step()) {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+            auto* entry = entries[mShownRows[i]];
+            mVisibleIds.emplace_back(entry->GetProcessId());
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+
+            // Lock the entry
+            std::scoped_lock entryLock(entry->Mutex());
+
+            static char uniqueId[64];
+            snprintf(uniqueId, sizeof(uniqueId), "##%lu", entry->GetProcessId());
+
+            if (ImGui::Selectable(entry->GetName(), entry->IsSelected(),
+                    ImGuiSelectableFlags_SpanAllColumns, ImGui::GetColumnWidth(-1), uniqueId)) {
+                mDataCache.SelectEntry(entry);
+            }
+
+            ShowEntryColumns(entry);
+        }
+    }
+}
+
+void ProcessPanel::ShowProcessTree()
+{
+    const auto& tree = mDataCache.GetTree();
+    mExpandedIds.clear();
+
+    // Only the roots are gathered up front, children are materialised once their node is opened
+    std::vector<ProcessEntry*> roots;
+    roots.reserve(tree.GetRoots().size());
+    for (const auto procId : tree.GetRoots()) {
+        if (auto* entry = mDataCache.FindEntry(procId)) {
+            roots.emplace_back(entry);
+        }
+    }
+
+    SortTreeLevel(roots);
+    for (auto* entry : roots) {
+        ShowProcessTreeNode(entry);
+    }
+}
+
+void ProcessPanel::ShowProcessTreeNode(ProcessEntry* entry)
+{
+    const auto* node = mDataCache.GetTree().Find(entry->GetProcessId());
+    const bool hasChildren = node && !node->Children.empty();
+
+    ImGui::TableNextRow();
+    ImGui::TableNextColumn();
+
+    ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_OpenOnArrow;
+    if (!hasChildren) {
+        flags |= ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+    }
+    if (entry->IsSelected()) {
+        flags |= ImGuiTreeNodeFlags_Selected;
+    }
+
+    bool open;
+    {
+        // Lock the entry
+        std::scoped_lock entryLock(entry->Mutex());
+
+        open = ImGui::TreeNodeEx((void*)(intptr_t)entry->GetProcessId(), flags, "%s", entry->GetName());
+        if (ImGui::IsItemVisible()) {
+            mVisibleIds.emplace_back(entry->GetProcessId());
+        }
+        if (ImGui::IsItemClicked() && !ImGui::IsItemToggledOpen()) {
+            mDataCache.SelectEntry(entry);
+        }
+
+        // A collapsed parent shows the totals of its whole subtree
+        ShowEntryColumns(entry, (hasChildren && !open) ? &node->Subtree : nullptr);
+    }
+
+    if (hasChildren && open) {
+        mExpandedIds.emplace_back(entry->GetProcessId());
+
+        std::vector<ProcessEntry*> children;
+        children.reserve(node->Children.size());
+        for (const auto childId : node->Children) {
+            if (auto* child = mDataCache.FindEntry(childId)) {
+                children.emplace_back(child);
+            }
+        }
+
+        SortTreeLevel(children);
+        for (auto* child : children) {
+            ShowProcessTreeNode(child);
+        }
+        ImGui::TreePop();
+    }
+}
+
+void ProcessPanel::ShowCgroupTree()
+{
+    std::scoped_lock detailLock(mDetailMutex);
+
+    // Members keep the table's sort order
+    std::unordered_map<StringPool::Id, std::vector<ProcessEntry*>> members;
+    for (auto* entry : mDataCache.GetEntries()) {
+        members[entry->GetCgroupId()].emplace_back(entry);
+    }
+
+    if (const auto roots = mCgroupChildren.find(StringPool::Empty); roots != mCgroupChildren.end()) {
+        for (const uint32_t index : roots->second) {
+            ShowCgroupNode(index, members);
+        }
+    }
+
+    // Not looked up yet, or outside the unified hierarchy
+    if (const auto unassigned = members.find(StringPool::Empty); unassigned != members.end()) {
+        ShowCgroupMembers(unassigned->second);
+    }
+}
+
+void ProcessPanel::ShowCgroupNode(const uint32_t index, const std::unordered_map<StringPool::Id, std::vector<ProcessEntry*>>& members)
+{
+    const auto& cgroup = mCgroupCache[index];
+    const std::string_view path = StringPool::Get().View(cgroup.Path);
+    const std::string_view name = (path.size() > 1) ? path.substr(path.find_last_of('/') + 1) : path;
+
+    ImGui::TableNextRow();
+    ImGui::TableNextColumn();
+
+    const ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_OpenOnArrow | (cgroup.Parent == StringPool::Empty ? ImGuiTreeNodeFlags_DefaultOpen : 0);
+    const bool open = ImGui::TreeNodeEx((const void*)(intptr_t)cgroup.Path, flags, "%.*s (%u)", (int)name.size(), name.data(), cgroup.SubtreeProcesses);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("%.*s", (int)path.size(), path.data());
+    }
+    ShowCgroupColumns(cgroup);
+
+    if (!open) {
+        return;
+    }
+
+    if (const auto children = mCgroupChildren.find(cgroup.Path); children != mCgroupChildren.end()) {
+        for (const uint32_t child : children->second) {
+            ShowCgroupNode(child, members);
+        }
+    }
+
+    if (const auto processes = members.find(cgroup.Path); processes != members.end()) {
+        ShowCgroupMembers(processes->second);
+    }
+    ImGui::TreePop();
+}
+
+void ProcessPanel::ShowCgroupMembers(const std::vector<ProcessEntry*>& entries)
+{
+    for (auto* entry : entries) {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+
+        ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+        if (entry->IsSelected()) {
+            flags |= ImGuiTreeNodeFlags_Selected;
+        }
+
+        // Lock the entry
+        std::scoped_lock entryLock(entry->Mutex());
+
+        ImGui::TreeNodeEx((void*)(intptr_t)entry->GetProcessId(), flags, "%s", entry->GetName());
+        if (ImGui::IsItemClicked()) {
+            mDataCache.SelectEntry(entry);
+        }
+        if (ImGui::IsItemVisible()) {
+            mVisibleIds.emplace_back(entry->GetProcessId());
+        }
+        ShowEntryColumns(entry);
+    }
+}
+
+void ProcessPanel::ShowPressureLines(const PressureStats& pressure)
+{
+    if (!pressure.Available) {
+        return;
+    }
+
+    // The kernel's 10/60/300 s averages, then the share of the last scan interval
+    ImGui::Text("Pressure (some): %.1f%% / %.1f%% / %.1f%%, %.1f%% now",
+        pressure.Some.Avg10, pressure.Some.Avg60, pressure.Some.Avg300, pressure.Some.Stalled);
+    if (pressure.HasFull) {
+        ImGui::Text("Pressure (full): %.1f%% / %.1f%% / %.1f%%, %.1f%% now",
+            pressure.Full.Avg10, pressure.Full.Avg60, pressure.Full.Avg300, pressure.Full.Stalled);
+    }
+}
+
+void ProcessPanel::ShowCgroupColumns(const CgroupStats& cgroup)
+{
+    // The kernel accounts each cgroup over its whole subtree; columns without a cgroup total stay empty
+    for (const auto column : { View_ProcessId, View_ParentProcessId, View_ModuleCount }) {
+        if (CheckMenuOption(column)) {
+            ImGui::TableNextColumn();
+        }
+    }
+    if (CheckMenuOption(View_MemoryUsage)) {
+        ImGui::TableNextColumn();
+        ImGui::Text("%llu K", (unsigned long long)(cgroup.MemoryCurrent / 1024));
+        if (ImGui::IsItemHovered()) {
+            ImGui::BeginTooltip();
+            ImGui::Text("Anonymous: %llu K\nPage cache: %llu K",
+                (unsigned long long)(cgroup.MemoryAnon / 1024), (unsigned long long)(cgroup.MemoryFile / 1024));
+            ShowPressureLines(cgroup.Pressure[PressureResource_Memory]);
+            ImGui::EndTooltip();
+        }
+    }
+    for (const auto column : { View_ThreadCount, View_PriorityClass }) {
+        if (CheckMenuOption(column)) {
+            ImGui::TableNextColumn();
+        }
+    }
+    if (CheckMenuOption(View_CpuUsage)) {
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f%%", cgroup.CpuLoad);
+        if (ImGui::IsItemHovered()) {
+            ImGui::BeginTooltip();
+            ImGui::Text("CPU time: %.1f s\nThrottled: %.1f s", (double)cgroup.CpuUsage / 1.0e7, (double)cgroup.Throttled / 1.0e7);
+            ShowPressureLines(cgroup.Pressure[PressureResource_Cpu]);
+            ImGui::EndTooltip();
+        }
+    }
+    if (CheckMenuOption(View_DiskRead)) {
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f KB/s", cgroup.IoReadRate / 1024.0);
+        if (ImGui::IsItemHovered() && cgroup.Pressure[PressureResource_Io].Available) {
+            ImGui::BeginTooltip();
+            ShowPressureLines(cgroup.Pressure[PressureResource_Io]);
+            ImGui::EndTooltip();
+        }
+    }
+    if (CheckMenuOption(View_DiskWrite)) {
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f KB/s", cgroup.IoWriteRate / 1024.0);
+    }
+    for (const auto column : { View_FdCount, View_CommandLine }) {
+        if (CheckMenuOption(column)) {
+            ImGui::TableNextColumn();
+        }
+    }
+}
+
+void ProcessPanel::SortTreeLevel(std::vector<ProcessEntry*>& entries)
+{
+    if (const ImGuiTableSortSpecs* sortSpecs = ImGui::TableGetSortSpecs(); sortSpecs && entries.size() > 1) {
+        sCurrentSortSpecs = sortSpecs;
+        std::sort(entries.begin(), entries.end(), [](const void* lhs, const void* rhs) {
+            return CompareWithSortSpecs(lhs, rhs);
+        });
+        sCurrentSortSpecs = nullptr;
+    }
+}
+
+void ProcessPanel::ShowEntryColumns(const ProcessEntry* entry, const ProcessTotals* subtree)
+{
+    if (CheckMenuOption(View_ProcessId)) {
+        ImGui::TableNextColumn();
+        ImGui::Text("%lu", entry->GetProcessId());
+    }
+    if (CheckMenuOption(View_ParentProcessId)) {
+        ImGui::TableNextColumn();
+        ImGui::Text("%lu", entry->GetParentProcessId());
+    }
+    if (CheckMenuOption(View_ModuleCount)) {
+        ImGui::TableNextColumn();
+        ImGui::Text("%lu", entry->GetModuleCount());
+    }
+    if (CheckMenuOption(View_MemoryUsage)) {
+        ImGui::TableNextColumn();
+        const auto memory = subtree ? subtree->MemoryUsage : entry->GetMemoryUsage();
+        ImGui::Text("%llu K", (unsigned long long)(memory / 1024));
+    }
+    if (CheckMenuOption(View_ThreadCount)) {
+        ImGui::TableNextColumn();
+        ImGui::Text("%llu", subtree ? (unsigned long long)subtree->ThreadCount : (unsigned long long)entry->GetThreadCount());
+    }
+    if (CheckMenuOption(View_PriorityClass)) {
+        ImGui::TableNextColumn();
+        ImGui::Text("%ld", entry->GetPriorityClass());
+    }
+    if (CheckMenuOption(View_CpuUsage)) {
+        ImGui::TableNextColumn();
+        ImGui::Text("%.1f%%", subtree ? subtree->CpuLoad : entry->GetCpuLoad());
+    }
+    if (CheckMenuOption(View_DiskRead)) {
+        ImGui::TableNextColumn();
+        ShowIoRate(entry, entry->GetIoRates().ReadBytes);
+    }
+    if (CheckMenuOption(View_DiskWrite)) {
+        ImGui::TableNextColumn();
+        ShowIoRate(entry, entry->GetIoRates().WriteBytes);
+    }
+    if (CheckMenuOption(View_FdCount)) {
+        ImGui::TableNextColumn();
+        ShowFdCount(entry);
+    }
+    if (CheckMenuOption(View_CommandLine)) {
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(entry->GetCommandLine());
+    }
+}
+
+void ProcessPanel::ShowFdCount(const ProcessEntry* entry)
+{
+    if (!entry->HasFdStats()) {
+        ImGui::TextDisabled("-"); // Access denied
+        return;
+    }
+
+    // A steadily growing count is the early sign of a descriptor leak
+    const auto& stats = entry->GetFdStats();
+    ImGui::Text("%u", stats.Count);
+    if (stats.Trend >= 0.1 || stats.Trend <= -0.1) {
+        ImGui::SameLine();
+        const ImVec4 color = (stats.Trend > 0.0) ? ImVec4(0.8f, 0.2f, 0.1f, 1.0f) : ImVec4(0.2f, 0.6f, 0.2f, 1.0f);
+        ImGui::TextColored(color, "%+.1f/min", stats.Trend);
+    }
+}
+
+void ProcessPanel::ShowIoRate(const ProcessEntry* entry, const double rate)
+{
+    if (!entry->HasIoCounters()) {
+        ImGui::TextDisabled("-"); // Access denied
+    } else if (rate >= 1024.0 * 1024.0) {
+        ImGui::Text("%.1f MB/s", rate / (1024.0 * 1024.0));
+    } else {
+        ImGui::Text("%.1f KB/s", rate / 1024.0);
+    }
+
+    if (entry->HasIoCounters() && ImGui::IsItemHovered()) {
+        const auto& rates = entry->GetIoRates();
+        const auto& counters = entry->GetIoCounters();
+        ImGui::SetTooltip("Reads: %.0f/s\nWrites: %.0f/s\nCancelled writes: %llu K",
+            rates.ReadOps, rates.WriteOps, (unsigned long long)(counters.CancelledWriteBytes / 1024));
+    }
 }
 
 void ProcessPanel::SetDefaultViewOptions()
@@ -293,6 +1293,7 @@ void ProcessPanel::SetDefaultViewOptions()
     mMenuMap[View_ProcessId] = true;
     mMenuMap[View_ThreadCount] = true;
     mMenuMap[View_PriorityClass] = true;
+    mMenuMap[View_CpuUsage] = true;
 }
 
 void ProcessPanel::SetupTableColumns()
@@ -307,8 +1308,8 @@ void ProcessPanel::SetupTableColumns()
     if (CheckMenuOption(View_ParentProcessId)) {
         ImGui::TableSetupColumn("PPID", ImGuiTableColumnFlags_WidthFixed, 50.0f, View_ParentProcessId);
     }
-    if (CheckMenuOption(View_ModuleId)) {
-        ImGui::TableSetupColumn("Module", ImGuiTableColumnFlags_WidthFixed, 50.0f, View_ModuleId);
+    if (CheckMenuOption(View_ModuleCount)) {
+        ImGui::TableSetupColumn("Modules", ImGuiTableColumnFlags_WidthFixed, 50.0f, View_ModuleCount);
     }
     if (CheckMenuOption(View_MemoryUsage)) {
         ImGui::TableSetupColumn("Memory", ImGuiTableColumnFlags_WidthFixed, 0.0f, View_MemoryUsage);
@@ -319,6 +1320,21 @@ void ProcessPanel::SetupTableColumns()
     if (CheckMenuOption(View_PriorityClass)) {
         ImGui::TableSetupColumn("Priority", ImGuiTableColumnFlags_WidthFixed, 0.0f, View_PriorityClass);
     }
+    if (CheckMenuOption(View_CpuUsage)) {
+        ImGui::TableSetupColumn("CPU", ImGuiTableColumnFlags_WidthFixed, 0.0f, View_CpuUsage);
+    }
+    if (CheckMenuOption(View_DiskRead)) {
+        ImGui::TableSetupColumn("Disk R/s", ImGuiTableColumnFlags_PreferSortDescending | ImGuiTableColumnFlags_WidthFixed, 0.0f, View_DiskRead);
+    }
+    if (CheckMenuOption(View_DiskWrite)) {
+        ImGui::TableSetupColumn("Disk W/s", ImGuiTableColumnFlags_PreferSortDescending | ImGuiTableColumnFlags_WidthFixed, 0.0f, View_DiskWrite);
+    }
+    if (CheckMenuOption(View_FdCount)) {
+        ImGui::TableSetupColumn("FDs", ImGuiTableColumnFlags_PreferSortDescending | ImGuiTableColumnFlags_WidthFixed, 0.0f, View_FdCount);
+    }
+    if (CheckMenuOption(View_CommandLine)) {
+        ImGui::TableSetupColumn("Command Line", ImGuiTableColumnFlags_WidthFixed, 320.0f, View_CommandLine);
+    }
 
     ImGui::TableHeadersRow();
 }
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "Panel.h"
+#include "ProcessFilter.h"
 
 #include "system/processes/ProcessContainer.h"
 #include "system/processes/ProcessManager.h"
+#include "system/perf/PerfCounterCollector.h"
 
 namespace RESANA {
 
@@ -11,10 +13,43 @@ enum ProcessMenu {
     View_ProcessName = 0,
     View_ProcessId,
     View_ParentProcessId,
-    View_ModuleId,
+    View_ModuleCount,
     View_MemoryUsage,
     View_ThreadCount,
-    View_PriorityClass
+    View_PriorityClass,
+    View_CpuUsage,
+    View_CommandLine,
+    View_DiskRead,
+    View_DiskWrite,
+    View_FdCount
+};
+
+enum ThreadColumn {
+    Thread_Id = 0,
+    Thread_Name,
+    Thread_State,
+    Thread_CpuUsage,
+    Thread_CpuTime,
+    Thread_LastCpu,
+    Thread_Priority
+};
+
+enum ModuleColumn {
+    Module_Name = 0,
+    Module_Resident,
+    Module_Size,
+    Module_Mappings,
+    Module_Path
+};
+
+enum ExitedColumn {
+    Exited_Name = 0,
+    Exited_Count,
+    Exited_Unseen,
+    Exited_SpawnRate,
+    Exited_CpuTime,
+    Exited_PeakMemory,
+    Exited_LastExit
 };
 
 class ProcessPanel final : public Panel {
@@ -42,7 +77,36 @@ public:
     static bool CompareWithSortSpecs(const void* lhs, const void* rhs);
 
 private:
+    void ShowSearchBar();
+    void ShowFilterBar();
+    void ShowScanStats() const;
+    void ShowTopConsumers();
+    [[nodiscard]] bool IsRowHidden(const ProcessEntry* entry) const;
     void ShowProcessTable();
+    void ShowProcessRows();
+    void ShowProcessTree();
+    void ShowProcessTreeNode(ProcessEntry* entry);
+    void ShowCgroupTree();
+    void ShowCgroupNode(uint32_t index, const std::unordered_map<StringPool::Id, std::vector<ProcessEntry*>>& members);
+    void ShowCgroupMembers(const std::vector<ProcessEntry*>& entries);
+    void ShowCgroupColumns(const CgroupStats& cgroup);
+    static void ShowPressureLines(const PressureStats& pressure);
+    void SortTreeLevel(std::vector<ProcessEntry*>& entries);
+    void ShowEntryColumns(const ProcessEntry* entry, const ProcessTotals* subtree = nullptr);
+    static void ShowIoRate(const ProcessEntry* entry, double rate);
+    static void ShowFdCount(const ProcessEntry* entry);
+    void ShowProcessDetails();
+    void ShowThreadTable();
+    void ShowModuleTable();
+    void ShowFdBreakdown();
+    void ShowPerfCounters() const;
+    void ShowExitedTable();
+    void SortThreadEntries();
+    void SortModuleEntries();
+    void SortExitedEntries();
+    void UpdateWatchedProcesses();
+    void UpdateDetailDemand();
+    static uint32_t GetDetailField(int column);
     void SetDefaultViewOptions();
     void SetupTableColumns();
     void CalcTableColumnCount();
@@ -51,10 +115,65 @@ private:
     ProcessManager* mProcessManager = nullptr;
     ProcessContainer mDataCache {};
     bool mPanelOpen = false;
+    bool mShowTree = false;
+    bool mShowExited = false;
+    bool mGroupByCgroup = false;
+    bool mShowTop = false;
     uint32_t mUpdateInterval { 0 };
     uint32_t mTableColumnCount { 0 };
     std::unordered_map<ProcessMenu, bool> mMenuMap {};
 
+    // Threads and modules of the selected process, refreshed once per tick
+    std::mutex mDetailMutex {};
+    std::vector<ThreadEntry> mThreadCache {};
+    std::vector<ModuleEntry> mModuleCache {};
+    FdBreakdown mFdBreakdown {};
+    bool mHasFdBreakdown = false;
+    uint32_t mDetailCacheId = -1;
+    bool mThreadCacheDirty = false;
+    bool mModuleCacheDirty = false;
+
+    // Recently exited processes, refreshed once per tick while shown
+    std::vector<ExitedGroup> mExitedCache {};
+    bool mExitedCacheDirty = false;
+    bool mCapturingExits = false;
+    bool mCountersShown = false; // The Counters tab was drawn this frame
+
+    // Cgroup tree, refreshed once per tick while grouping by cgroup
+    std::vector<CgroupStats> mCgroupCache {};
+    std::unordered_map<StringPool::Id, std::vector<uint32_t>> mCgroupChildren {};
+
+    // Largest consumers per metric, refreshed once per tick while shown
+    std::array<std::vector<TopEntry>, Top_Count> mTopCache {};
+    unsigned long mSelectedId = (unsigned long)-1;
+
+    // Processes expanded in the tree view this frame
+    std::vector<unsigned long> mExpandedIds {};
+    std::vector<unsigned long> mWatchedIds {};
+
+    // Rows drawn this frame, and the fields the sort order needs for every process
+    std::vector<uint32_t> mShownRows {};
+    std::vector<unsigned long> mVisibleIds {};
+    uint32_t mSortFields = Detail_None;
+    DetailDemand mDetailDemand {};
+
+    // Search results, gathered a little every frame
+    char mSearchText[128] {};
+    bool mSearching = false;
+    bool mSearchComplete = true;
+    SearchCursor mSearchCursor {};
+    std::unordered_set<unsigned long> mSearchResults {};
+
+    // Compiled filter, evaluated for the changed rows whenever new data arrives
+    char mFilterText[256] {};
+    ProcessFilter mFilter {};
+    std::atomic<bool> mFilterDirty = false;
+    bool mFilterCompiled = false; // Every row needs evaluating, not just the changed ones
+
+    const float DETAILS_HEIGHT = 220.0f;
+    const size_t TOP_COUNT = 5;
+    const std::chrono::microseconds SEARCH_BUDGET { 2000 };
+
 	static const ImGuiTableSortSpecs* sCurrentSortSpecs;
 };
 
@@ -16,7 +16,11 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include "core/Core.h"
+
+#if defined(RS_PLATFORM_WINDOWS)
 #include <Windows.h>
+#endif
 
 #include "core/Log.h"
 #include "helpers/Container.h"
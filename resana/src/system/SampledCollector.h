@@ -0,0 +1,95 @@
+#pragma once
+
+#include "SelfProfiler.h"
+#include "ServiceThread.h"
+
+#include <cstdint>
+
+namespace RESANA
+{
+
+	/*
+	 * The singleton and sampling loop shared by the collectors that poll on an
+	 * interval of their own. The loop runs on a ServiceThread, samples while
+	 * the collector is wanted and sleeps in between; Stop joins it, so a Run
+	 * that follows never starts a second loop, and Shutdown deletes the
+	 * collector right away. T befriends this class and implements IsWanted and
+	 * Sample, and optionally OnStopped.
+	 */
+	template <typename T>
+	class SampledCollector
+	{
+	public:
+		static T* Get()
+		{
+			if (!sInstance) {
+				sInstance = new T();
+			}
+
+			return sInstance;
+		}
+
+		// Cheap enough to call every frame; does nothing while running or unwanted
+		static void Run()
+		{
+			T* collector = Get();
+			if (collector->IsWanted()) {
+				collector->mThread.Start([collector] { collector->CollectLoop(); });
+			}
+		}
+
+		static void Stop()
+		{
+			if (sInstance) {
+				sInstance->mThread.Stop();
+			}
+		}
+
+		static void Shutdown()
+		{
+			if (sInstance)
+			{
+				Stop();
+				delete sInstance;
+				sInstance = nullptr;
+			}
+		}
+
+		[[nodiscard]] bool IsRunning() const { return mThread.IsRunning(); }
+
+	protected:
+		SampledCollector(const char* name, const Subsystem subsystem, const uint32_t interval)
+			: mSubsystem(subsystem), mInterval(interval), mThread(name)
+		{
+		}
+
+		virtual ~SampledCollector() = default;
+
+		// Checked before the loop starts and after every sample; the loop ends once false
+		[[nodiscard]] virtual bool IsWanted() const = 0;
+		virtual void Sample() = 0;
+
+		// Runs on the collecting thread once the loop ends
+		virtual void OnStopped() {}
+
+	private:
+		void CollectLoop()
+		{
+			do
+			{
+				SelfProfiler::Scope scope(mSubsystem);
+				Sample();
+			} while (IsWanted() && mThread.Sleep(mInterval));
+
+			OnStopped();
+		}
+
+	private:
+		const Subsystem mSubsystem;
+		const uint32_t mInterval;
+		ServiceThread mThread;
+
+		static inline T* sInstance = nullptr;
+	};
+
+}
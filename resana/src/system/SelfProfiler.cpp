@@ -0,0 +1,139 @@
+#include "rspch.h"
+#include "SelfProfiler.h"
+
+#include "core/Core.h"
+
+#if defined(RS_PLATFORM_WINDOWS)
+#include <Windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace RESANA
+{
+	SelfProfiler SelfProfiler::sInstance;
+	thread_local SelfProfiler::ThreadState SelfProfiler::sState;
+
+	namespace
+	{
+		constexpr const char* SUBSYSTEM_NAMES[Subsystem_Count] = {
+			"Other", "UI", "CPU", "Memory", "Pressure", "Scheduler", "Perf counters", "Processes", "Process details", "Exit capture"
+		};
+	}
+
+	SelfProfiler::Scope::Scope(const Subsystem subsystem)
+		: mPrevious(Switch(subsystem))
+	{
+	}
+
+	SelfProfiler::Scope::~Scope()
+	{
+		Switch(mPrevious);
+	}
+
+	void SelfProfiler::NameThread(const std::string& name)
+	{
+		if (!sState.Record)
+		{
+			sState.Record = sInstance.Register(name);
+			sState.Last = GetThreadTime();
+		}
+	}
+
+	SelfUsage SelfProfiler::GetUsage()
+	{
+		auto& profiler = sInstance;
+		std::scoped_lock lock(profiler.mMutex);
+
+		const auto now = std::chrono::steady_clock::now();
+		if (now - profiler.mLastReport < REPORT_INTERVAL) {
+			return profiler.mUsage;
+		}
+
+		// The first report only sets the baseline
+		const bool hasReport = profiler.mLastReport != std::chrono::steady_clock::time_point{};
+		const double elapsed = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(now - profiler.mLastReport).count();
+		profiler.mLastReport = now;
+
+		SelfUsage usage;
+		for (const auto& record : profiler.mThreads)
+		{
+			ThreadUsage thread;
+			thread.Name = record->Name;
+			for (int subsystem = 0; subsystem < Subsystem_Count; subsystem++)
+			{
+				const uint64_t time = record->Time[subsystem].load(std::memory_order_relaxed);
+				const double load = hasReport ? (double)(time - record->Reported[subsystem]) / elapsed * 100.0 : 0.0;
+				record->Reported[subsystem] = time;
+
+				thread.Subsystems[subsystem] = load;
+				thread.Load += load;
+				usage.Subsystems[subsystem] += load;
+			}
+			usage.Total += thread.Load;
+			usage.Threads.emplace_back(std::move(thread));
+		}
+
+		std::sort(usage.Threads.begin(), usage.Threads.end(), [](const ThreadUsage& a, const ThreadUsage& b) {
+			return a.Load > b.Load;
+		});
+		profiler.mUsage = usage;
+		return usage;
+	}
+
+	const char* SelfProfiler::GetName(const Subsystem subsystem)
+	{
+		return SUBSYSTEM_NAMES[subsystem];
+	}
+
+	SelfProfiler::ThreadRecord* SelfProfiler::Register(const std::string& name)
+	{
+		std::scoped_lock lock(mMutex);
+
+		// Threads that are restarted, like the exit capture, keep adding to their row
+		for (const auto& record : mThreads) {
+			if (record->Name == name) {
+				return record.get();
+			}
+		}
+
+		auto& record = mThreads.emplace_back(std::make_unique<ThreadRecord>());
+		record->Name = name;
+		return record.get();
+	}
+
+	Subsystem SelfProfiler::Switch(const Subsystem next)
+	{
+		auto& state = sState;
+		const uint64_t now = GetThreadTime();
+		if (!state.Record) {
+			state.Record = sInstance.Register("Unnamed");
+		} else {
+			state.Record->Time[state.Current].fetch_add(now - state.Last, std::memory_order_relaxed);
+		}
+
+		const Subsystem previous = state.Current;
+		state.Current = next;
+		state.Last = now;
+		return previous;
+	}
+
+	uint64_t SelfProfiler::GetThreadTime()
+	{
+#if defined(RS_PLATFORM_WINDOWS)
+		// Only advances at the scheduler's quantum, so short scopes are charged unevenly but in full
+		FILETIME creation, exit, kernel, user;
+		if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+			return 0;
+		}
+		const uint64_t ticks = (((uint64_t)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime) +
+			(((uint64_t)user.dwHighDateTime << 32) | user.dwLowDateTime);
+		return ticks * 100;
+#else
+		timespec time{};
+		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+		return (uint64_t)time.tv_sec * 1000000000 + (uint64_t)time.tv_nsec;
+#endif
+	}
+
+}
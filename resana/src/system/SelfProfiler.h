@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace RESANA
+{
+
+	// What a thread of the monitor is working on
+	enum Subsystem
+	{
+		Subsystem_Other = 0,     // Pool jobs outside any collector
+		Subsystem_UI,
+		Subsystem_CPU,
+		Subsystem_Memory,
+		Subsystem_Pressure,
+		Subsystem_Scheduler,
+		Subsystem_PerfCounters,
+		Subsystem_Processes,
+		Subsystem_ProcessDetails, // Threads and modules of the selected process
+		Subsystem_ExitCapture,
+		Subsystem_Count
+	};
+
+	struct ThreadUsage
+	{
+		std::string Name{};
+		double Load{};                         // Percent of one core
+		double Subsystems[Subsystem_Count]{};
+	};
+
+	struct SelfUsage
+	{
+		double Total{};                        // Percent of one core, over the accounted threads
+		double Subsystems[Subsystem_Count]{};
+		std::vector<ThreadUsage> Threads{};    // Busiest first
+	};
+
+	/*
+	 * Accounts the monitor's own CPU time to the subsystem that spent it. A
+	 * thread reads its own CPU clock whenever a Scope opens or closes, and
+	 * charges the time since its previous reading to the subsystem that was
+	 * running; nested scopes are therefore charged exclusively, and a pool
+	 * job's time outside any collector lands in Other. Charges go to atomic
+	 * counters owned by the thread, so only a thread's first scope locks.
+	 */
+	class SelfProfiler
+	{
+	public:
+		class Scope
+		{
+		public:
+			explicit Scope(Subsystem subsystem);
+			~Scope();
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+		private:
+			Subsystem mPrevious;
+		};
+
+		// Names the calling thread in the report; threads given the same name share a row
+		static void NameThread(const std::string& name);
+
+		// Rates since the previous report, recomputed at most once per REPORT_INTERVAL
+		static SelfUsage GetUsage();
+
+		static const char* GetName(Subsystem subsystem);
+
+	public:
+		static constexpr std::chrono::milliseconds REPORT_INTERVAL{ 1000 };
+
+	private:
+		struct ThreadRecord
+		{
+			std::string Name{};
+			std::atomic<uint64_t> Time[Subsystem_Count]{}; // Nanoseconds
+			uint64_t Reported[Subsystem_Count]{};          // Time at the previous report
+		};
+
+		struct ThreadState
+		{
+			ThreadRecord* Record = nullptr;
+			Subsystem Current = Subsystem_Other;
+			uint64_t Last{};
+		};
+
+		ThreadRecord* Register(const std::string& name);
+		static Subsystem Switch(Subsystem next);
+		static uint64_t GetThreadTime();
+
+	private:
+		std::mutex mMutex{};
+		std::vector<std::unique_ptr<ThreadRecord>> mThreads{};
+		std::chrono::steady_clock::time_point mLastReport{};
+		SelfUsage mUsage{};
+
+		static SelfProfiler sInstance;
+		static thread_local ThreadState sState;
+	};
+
+}
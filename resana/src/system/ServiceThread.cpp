@@ -0,0 +1,58 @@
+#include "ServiceThread.h"
+#include "SelfProfiler.h"
+
+namespace RESANA
+{
+
+	ServiceThread::ServiceThread(std::string name)
+		: mName(std::move(name))
+	{
+	}
+
+	ServiceThread::~ServiceThread()
+	{
+		Stop();
+	}
+
+	bool ServiceThread::Start(const std::function<void()>& loop)
+	{
+		if (mRunning) {
+			return false;
+		}
+
+		// A loop that returned by itself has still to be joined
+		if (mThread.joinable()) {
+			mThread.join();
+		}
+
+		mRunning = true;
+		mThread = std::thread([this, loop] {
+			SelfProfiler::NameThread(mName);
+			loop();
+			mRunning = false;
+		});
+		return true;
+	}
+
+	void ServiceThread::Stop()
+	{
+		{
+			std::scoped_lock lock(mMutex);
+			mRunning = false;
+		}
+		mCondition.notify_all();
+
+		// The loop may stop itself, but can't wait for itself to finish
+		if (mThread.joinable() && mThread.get_id() != std::this_thread::get_id()) {
+			mThread.join();
+		}
+	}
+
+	bool ServiceThread::Sleep(const uint32_t ms)
+	{
+		std::unique_lock lock(mMutex);
+		mCondition.wait_for(lock, std::chrono::milliseconds(ms), [this] { return !mRunning; });
+		return mRunning;
+	}
+
+}
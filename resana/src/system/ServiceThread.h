@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace RESANA
+{
+
+	/*
+	 * A thread of its own for a loop that lives as long as its collector, so
+	 * long-running polls never hold on to a pool worker that short jobs are
+	 * queued behind. Stop wakes the loop out of Sleep and joins it, so the loop
+	 * is gone once Stop returns and a Start that follows never runs two.
+	 */
+	class ServiceThread
+	{
+	public:
+		explicit ServiceThread(std::string name);
+		~ServiceThread();
+
+		ServiceThread(const ServiceThread&) = delete;
+		ServiceThread& operator=(const ServiceThread&) = delete;
+
+		// Returns false if the loop is still running
+		bool Start(const std::function<void()>& loop);
+		void Stop();
+
+		[[nodiscard]] bool IsRunning() const { return mRunning; }
+
+		// Sleeps for the interval unless stopped first; returns whether the loop should go on
+		bool Sleep(uint32_t ms);
+
+	private:
+		std::string mName{};
+		std::thread mThread{};
+		std::mutex mMutex{};
+		std::condition_variable mCondition{};
+		std::atomic<bool> mRunning{ false };
+	};
+
+}
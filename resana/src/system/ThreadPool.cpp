@@ -1,4 +1,5 @@
 #include "ThreadPool.h"
+#include "SelfProfiler.h"
 
 
 namespace RESANA
@@ -17,7 +18,10 @@ namespace RESANA
 		mThreads.resize(numThreads);
 
 		for (uint32_t i = 0; i < numThreads; i++) {
-			mThreads.at(i) = std::thread([this] {ThreadLoop();});
+			mThreads.at(i) = std::thread([this, i] {
+				SelfProfiler::NameThread("Pool " + std::to_string(i));
+				ThreadLoop();
+			});
 		}
 	}
 
@@ -72,6 +76,9 @@ namespace RESANA
 				job = mQueue.front();
 				mQueue.pop();
 			}
+
+			// Collectors charge their own scopes; whatever is left of the job is Other
+			SelfProfiler::Scope scope(Subsystem_Other);
 			job();
 		}
 	}
@@ -0,0 +1,174 @@
+#include "rspch.h"
+#include "CPUFrequencyCollector.h"
+
+#include "core/Core.h"
+#include "helpers/ProcFS.h"
+
+#if defined(RS_PLATFORM_WINDOWS)
+#include <Windows.h>
+#include <powerbase.h>
+#elif defined(RS_PLATFORM_LINUX)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace RESANA {
+
+#if defined(RS_PLATFORM_WINDOWS)
+
+	// Documented but not declared by the SDK headers
+	typedef struct _PROCESSOR_POWER_INFORMATION {
+		ULONG Number;
+		ULONG MaxMhz;
+		ULONG CurrentMhz;
+		ULONG MhzLimit;
+		ULONG MaxIdleState;
+		ULONG CurrentIdleState;
+	} PROCESSOR_POWER_INFORMATION;
+
+	CPUFrequencyCollector::CPUFrequencyCollector()
+	{
+		SYSTEM_INFO sysInfo;
+		GetSystemInfo(&sysInfo);
+		mBuffer.resize(sysInfo.dwNumberOfProcessors * sizeof(PROCESSOR_POWER_INFORMATION));
+	}
+
+	CPUFrequencyCollector::~CPUFrequencyCollector() = default;
+
+	void CPUFrequencyCollector::Refresh(LogicalCoreData& data)
+	{
+		const NTSTATUS status = CallNtPowerInformation(ProcessorInformation, nullptr, 0, mBuffer.data(), (ULONG)mBuffer.size());
+		if (status != 0) {
+			return;
+		}
+
+		// Windows has no throttle counter; a clock held below its maximum is the closest sign
+		std::scoped_lock lock(data.GetMutex());
+		const auto* info = (const PROCESSOR_POWER_INFORMATION*)mBuffer.data();
+		const size_t count = mBuffer.size() / sizeof(PROCESSOR_POWER_INFORMATION);
+		data.Reserve(count);
+		for (size_t i = 0; i < count; i++)
+		{
+			auto& core = data.GetProcessors()[info[i].Number < count ? info[i].Number : i];
+			core.Frequency = info[i].CurrentMhz;
+			core.MaxFrequency = info[i].MaxMhz;
+		}
+	}
+
+#elif defined(RS_PLATFORM_LINUX)
+
+	CPUFrequencyCollector::CPUFrequencyCollector()
+	{
+		const long configured = sysconf(_SC_NPROCESSORS_CONF);
+		mCores.resize(configured > 0 ? (size_t)configured : 1);
+		for (size_t core = 0; core < mCores.size(); core++) {
+			Open(core);
+		}
+	}
+
+	CPUFrequencyCollector::~CPUFrequencyCollector()
+	{
+		for (const auto& files : mCores)
+		{
+			if (files.Frequency >= 0) {
+				close(files.Frequency);
+			}
+			if (files.Throttles >= 0) {
+				close(files.Throttles);
+			}
+		}
+	}
+
+	void CPUFrequencyCollector::Refresh(LogicalCoreData& data)
+	{
+		// Missing files are looked for again every so often, for cores that came online
+		const bool reopen = (++mTicks % REOPEN_TICKS) == 0;
+
+		std::scoped_lock lock(data.GetMutex());
+		data.Reserve(mCores.size());
+		auto& processors = data.GetProcessors();
+
+		char buffer[32];
+		for (size_t i = 0; i < mCores.size(); i++)
+		{
+			auto& files = mCores[i];
+			if (reopen && files.Frequency < 0) {
+				Open(i);
+			}
+
+			auto& core = processors[i];
+			core.MaxFrequency = files.MaxFrequency;
+
+			// scaling_cur_freq is in kHz
+			uint64_t value = 0;
+			core.Frequency = 0;
+			if (files.Frequency >= 0)
+			{
+				if (ProcFS::ReadFile(files.Frequency, buffer, sizeof(buffer)) > 0) {
+					ProcFS::ParseUInt64(buffer, value);
+					core.Frequency = (uint32_t)(value / 1000);
+				} else {
+					CloseFrequency(i); // Went offline; the throttle count carries on
+				}
+			}
+
+			core.Throttles = -1;
+			if (files.Throttles >= 0 && ProcFS::ReadFile(files.Throttles, buffer, sizeof(buffer)) > 0)
+			{
+				ProcFS::ParseUInt64(buffer, value);
+				core.Throttles = files.HasThrottles && value >= files.LastThrottles ? (int64_t)(value - files.LastThrottles) : 0;
+				files.LastThrottles = value;
+				files.HasThrottles = true;
+			}
+		}
+	}
+
+	void CPUFrequencyCollector::Open(const size_t core)
+	{
+		auto& files = mCores[core];
+		char path[96];
+
+		if (files.Frequency < 0)
+		{
+			snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%zu/cpufreq/scaling_cur_freq", core);
+			files.Frequency = open(path, O_RDONLY | O_CLOEXEC);
+
+			char buffer[32];
+			uint64_t value = 0;
+			snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%zu/cpufreq/cpuinfo_max_freq", core);
+			if (ProcFS::ReadFile(path, buffer, sizeof(buffer)) > 0) {
+				ProcFS::ParseUInt64(buffer, value);
+			}
+			files.MaxFrequency = (uint32_t)(value / 1000);
+		}
+
+		// Only on x86 with the therm_throt driver
+		if (files.Throttles < 0)
+		{
+			snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%zu/thermal_throttle/core_throttle_count", core);
+			files.Throttles = open(path, O_RDONLY | O_CLOEXEC);
+			files.HasThrottles = false;
+		}
+	}
+
+	void CPUFrequencyCollector::CloseFrequency(const size_t core)
+	{
+		auto& files = mCores[core];
+		if (files.Frequency >= 0) {
+			close(files.Frequency);
+			files.Frequency = -1;
+		}
+	}
+
+#else
+
+	CPUFrequencyCollector::CPUFrequencyCollector() = default;
+	CPUFrequencyCollector::~CPUFrequencyCollector() = default;
+
+	void CPUFrequencyCollector::Refresh(LogicalCoreData& data)
+	{
+	}
+
+#endif
+
+}
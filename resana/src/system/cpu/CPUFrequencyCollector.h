@@ -0,0 +1,52 @@
+#pragma once
+
+#include "LogicalCoreData.h"
+#include "core/Core.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace RESANA {
+
+	/*
+	 * Current clock and thermal throttling of each core. On Linux the cpufreq
+	 * and thermal_throttle files are opened once and re-read every tick; a
+	 * core whose frequency file is missing (no driver, or offline) is retried
+	 * now and then rather than on every tick.
+	 */
+	class CPUFrequencyCollector
+	{
+	public:
+		CPUFrequencyCollector();
+		~CPUFrequencyCollector();
+
+		// Fills in Frequency, MaxFrequency and Throttles of each core
+		void Refresh(LogicalCoreData& data);
+
+#if defined(RS_PLATFORM_LINUX)
+	private:
+		// Opens whichever of the core's files aren't open yet
+		void Open(size_t core);
+		void CloseFrequency(size_t core);
+
+	private:
+		static constexpr uint32_t REOPEN_TICKS = 30;
+
+		struct CoreFiles
+		{
+			int Frequency = -1;
+			int Throttles = -1;
+			uint32_t MaxFrequency{}; // MHz; fixed, so read once when opened
+			uint64_t LastThrottles{};
+			bool HasThrottles = false; // LastThrottles holds a reading
+		};
+
+		std::vector<CoreFiles> mCores{};
+		uint32_t mTicks{};
+#elif defined(RS_PLATFORM_WINDOWS)
+	private:
+		std::vector<char> mBuffer{}; // The power information array
+#endif
+	};
+
+}
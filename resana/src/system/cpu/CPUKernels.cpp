@@ -0,0 +1,433 @@
+#include "rspch.h"
+#include "CPUKernels.h"
+
+#include <atomic>
+#include <cstring>
+#include <limits>
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define RS_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define RS_TARGET_AVX2
+#else
+#define RS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace RESANA {
+
+	namespace {
+
+		// Busy time is everything but idle and iowait; guest time is already part of user and nice
+		constexpr CpuField BUSY_FIELDS[] = {
+			CpuField_User, CpuField_Nice, CpuField_System, CpuField_Irq, CpuField_SoftIrq, CpuField_Steal
+		};
+		constexpr CpuField IDLE_FIELDS[] = { CpuField_Idle, CpuField_IOWait };
+
+		// States that are a counter as is; user and nice lose their guest share, which is a state of its own
+		constexpr std::pair<CpuState, CpuField> DIRECT_STATES[] = {
+			{ CpuState_System, CpuField_System }, { CpuState_Irq, CpuField_Irq }, { CpuState_SoftIrq, CpuField_SoftIrq },
+			{ CpuState_IOWait, CpuField_IOWait }, { CpuState_Steal, CpuField_Steal }, { CpuState_Idle, CpuField_Idle }
+		};
+
+		CoreCounters Offset(const CoreCounters& counters, const size_t offset)
+		{
+			CoreCounters result;
+			for (int field = 0; field < CpuField_Count; field++) {
+				result.Fields[field] = counters.Fields[field] + offset;
+			}
+			return result;
+		}
+
+		//--------------------------------------------------------------
+		// [SECTION] Scalar
+		//--------------------------------------------------------------
+
+		void ComputeLoadsScalar(const CoreCounters& last, const CoreCounters& current, const size_t count, double* loads)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				// Counters can step back (iowait does, and hotplugged cores restart), so each delta is floored at zero
+				const auto delta = [&](const CpuField field) {
+					const double value = (double)current.Fields[field][i] - (double)last.Fields[field][i];
+					return value > 0.0 ? value : 0.0;
+				};
+
+				double busy = 0.0, idle = 0.0;
+				for (const auto field : BUSY_FIELDS) { busy += delta(field); }
+				for (const auto field : IDLE_FIELDS) { idle += delta(field); }
+
+				const double total = busy + idle;
+				loads[i] = total > 0.0 ? std::min(busy / total * 100.0, 100.0) : CPUKernels::NO_LOAD;
+			}
+		}
+
+		void ComputeStatesScalar(const CoreCounters& last, const CoreCounters& current, const size_t count, const CoreStates& states)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				double delta[CpuField_Count];
+				for (int field = 0; field < CpuField_Count; field++)
+				{
+					const double value = (double)current.Fields[field][i] - (double)last.Fields[field][i];
+					delta[field] = value > 0.0 ? value : 0.0;
+				}
+
+				double busy = 0.0, idle = 0.0;
+				for (const auto field : BUSY_FIELDS) { busy += delta[field]; }
+				for (const auto field : IDLE_FIELDS) { idle += delta[field]; }
+
+				const double total = busy + idle;
+				const double scale = total > 0.0 ? 100.0 / total : 0.0;
+				for (const auto& [state, field] : DIRECT_STATES) { states.States[state][i] = delta[field] * scale; }
+				states.States[CpuState_User][i] = std::max(delta[CpuField_User] - delta[CpuField_Guest], 0.0) * scale;
+				states.States[CpuState_Nice][i] = std::max(delta[CpuField_Nice] - delta[CpuField_GuestNice], 0.0) * scale;
+				states.States[CpuState_Guest][i] = (delta[CpuField_Guest] + delta[CpuField_GuestNice]) * scale;
+			}
+		}
+
+		LoadSummary SummarizeScalar(const double* loads, const size_t count)
+		{
+			double min = std::numeric_limits<double>::infinity();
+			double max = -std::numeric_limits<double>::infinity();
+			double sum = 0.0;
+			uint32_t valid = 0;
+			for (size_t i = 0; i < count; i++)
+			{
+				if (loads[i] < 0.0) { continue; }
+				min = std::min(min, loads[i]);
+				max = std::max(max, loads[i]);
+				sum += loads[i];
+				valid++;
+			}
+
+			if (!valid) { return {}; }
+			return { min, max, sum / valid, valid };
+		}
+
+		LoadSummary MergeSummary(const LoadSummary& summary, double min, double max, double sum, double valid)
+		{
+			// Folds a vector pass into the scalar result of its tail
+			if (summary.Count) {
+				min = std::min(min, summary.Min);
+				max = std::max(max, summary.Max);
+				sum += summary.Average * summary.Count;
+				valid += summary.Count;
+			}
+
+			if (valid == 0.0) { return {}; }
+			return { min, max, sum / valid, (uint32_t)valid };
+		}
+
+#if defined(RS_SIMD_X86)
+
+		//--------------------------------------------------------------
+		// [SECTION] SSE2
+		//--------------------------------------------------------------
+
+		// Exact for counters below 2^52, i.e. forever for jiffies
+		__m128d ToDouble(const uint64_t* p)
+		{
+			const __m128i bits = _mm_or_si128(_mm_loadu_si128((const __m128i*)p), _mm_set1_epi64x(0x4330000000000000));
+			return _mm_sub_pd(_mm_castsi128_pd(bits), _mm_set1_pd(4503599627370496.0));
+		}
+
+		__m128d Delta(const CoreCounters& last, const CoreCounters& current, const CpuField field, const size_t i)
+		{
+			const __m128d delta = _mm_sub_pd(ToDouble(current.Fields[field] + i), ToDouble(last.Fields[field] + i));
+			return _mm_max_pd(delta, _mm_setzero_pd());
+		}
+
+		void ComputeLoadsSSE2(const CoreCounters& last, const CoreCounters& current, const size_t count, double* loads)
+		{
+			const __m128d hundred = _mm_set1_pd(100.0);
+			const __m128d noLoad = _mm_set1_pd(CPUKernels::NO_LOAD);
+
+			size_t i = 0;
+			for (; i + 2 <= count; i += 2)
+			{
+				__m128d busy = _mm_setzero_pd();
+				__m128d idle = _mm_setzero_pd();
+				for (const auto field : BUSY_FIELDS) { busy = _mm_add_pd(busy, Delta(last, current, field, i)); }
+				for (const auto field : IDLE_FIELDS) { idle = _mm_add_pd(idle, Delta(last, current, field, i)); }
+
+				// Lanes with no elapsed time divide by zero; the mask replaces them
+				const __m128d total = _mm_add_pd(busy, idle);
+				const __m128d load = _mm_min_pd(_mm_mul_pd(_mm_div_pd(busy, total), hundred), hundred);
+				const __m128d valid = _mm_cmpgt_pd(total, _mm_setzero_pd());
+				_mm_storeu_pd(loads + i, _mm_or_pd(_mm_and_pd(valid, load), _mm_andnot_pd(valid, noLoad)));
+			}
+			ComputeLoadsScalar(Offset(last, i), Offset(current, i), count - i, loads + i);
+		}
+
+		void ComputeStatesSSE2(const CoreCounters& last, const CoreCounters& current, const size_t count, const CoreStates& states)
+		{
+			const __m128d hundred = _mm_set1_pd(100.0);
+
+			size_t i = 0;
+			for (; i + 2 <= count; i += 2)
+			{
+				__m128d delta[CpuField_Count];
+				for (int field = 0; field < CpuField_Count; field++) { delta[field] = Delta(last, current, (CpuField)field, i); }
+
+				__m128d busy = _mm_setzero_pd();
+				__m128d idle = _mm_setzero_pd();
+				for (const auto field : BUSY_FIELDS) { busy = _mm_add_pd(busy, delta[field]); }
+				for (const auto field : IDLE_FIELDS) { idle = _mm_add_pd(idle, delta[field]); }
+
+				const __m128d total = _mm_add_pd(busy, idle);
+				const __m128d scale = _mm_and_pd(_mm_cmpgt_pd(total, _mm_setzero_pd()), _mm_div_pd(hundred, total));
+				for (const auto& [state, field] : DIRECT_STATES) { _mm_storeu_pd(states.States[state] + i, _mm_mul_pd(delta[field], scale)); }
+
+				const __m128d user = _mm_max_pd(_mm_sub_pd(delta[CpuField_User], delta[CpuField_Guest]), _mm_setzero_pd());
+				const __m128d nice = _mm_max_pd(_mm_sub_pd(delta[CpuField_Nice], delta[CpuField_GuestNice]), _mm_setzero_pd());
+				_mm_storeu_pd(states.States[CpuState_User] + i, _mm_mul_pd(user, scale));
+				_mm_storeu_pd(states.States[CpuState_Nice] + i, _mm_mul_pd(nice, scale));
+				_mm_storeu_pd(states.States[CpuState_Guest] + i, _mm_mul_pd(_mm_add_pd(delta[CpuField_Guest], delta[CpuField_GuestNice]), scale));
+			}
+			if (i < count)
+			{
+				CoreStates tail;
+				for (int state = 0; state < CpuState_Count; state++) { tail.States[state] = states.States[state] + i; }
+				ComputeStatesScalar(Offset(last, i), Offset(current, i), count - i, tail);
+			}
+		}
+
+		LoadSummary SummarizeSSE2(const double* loads, const size_t count)
+		{
+			const __m128d inf = _mm_set1_pd(std::numeric_limits<double>::infinity());
+			const __m128d negInf = _mm_set1_pd(-std::numeric_limits<double>::infinity());
+			const __m128d one = _mm_set1_pd(1.0);
+
+			__m128d min = inf, max = negInf, sum = _mm_setzero_pd(), valid = _mm_setzero_pd();
+			size_t i = 0;
+			for (; i + 2 <= count; i += 2)
+			{
+				const __m128d load = _mm_loadu_pd(loads + i);
+				const __m128d mask = _mm_cmpge_pd(load, _mm_setzero_pd());
+				min = _mm_min_pd(min, _mm_or_pd(_mm_and_pd(mask, load), _mm_andnot_pd(mask, inf)));
+				max = _mm_max_pd(max, _mm_or_pd(_mm_and_pd(mask, load), _mm_andnot_pd(mask, negInf)));
+				sum = _mm_add_pd(sum, _mm_and_pd(mask, load));
+				valid = _mm_add_pd(valid, _mm_and_pd(mask, one));
+			}
+
+			alignas(16) double lanes[4][2];
+			_mm_store_pd(lanes[0], min);
+			_mm_store_pd(lanes[1], max);
+			_mm_store_pd(lanes[2], sum);
+			_mm_store_pd(lanes[3], valid);
+			return MergeSummary(SummarizeScalar(loads + i, count - i),
+				std::min(lanes[0][0], lanes[0][1]), std::max(lanes[1][0], lanes[1][1]),
+				lanes[2][0] + lanes[2][1], lanes[3][0] + lanes[3][1]);
+		}
+
+		//--------------------------------------------------------------
+		// [SECTION] AVX2
+		//--------------------------------------------------------------
+
+		// All lanes below count - i; the tail is masked rather than handed to scalar code,
+		// whose SSE encoding would stall on the dirty upper halves of the registers
+		RS_TARGET_AVX2 __m256i LaneMask(const size_t remaining)
+		{
+			const long long lanes = (long long)std::min<size_t>(remaining, 4);
+			return _mm256_cmpgt_epi64(_mm256_set1_epi64x(lanes), _mm256_setr_epi64x(0, 1, 2, 3));
+		}
+
+		RS_TARGET_AVX2 __m256d ToDouble4(const uint64_t* p, const __m256i mask)
+		{
+			const __m256i value = _mm256_maskload_epi64((const long long*)p, mask);
+			const __m256i bits = _mm256_or_si256(value, _mm256_set1_epi64x(0x4330000000000000));
+			return _mm256_sub_pd(_mm256_castsi256_pd(bits), _mm256_set1_pd(4503599627370496.0));
+		}
+
+		RS_TARGET_AVX2 __m256d Delta4(const CoreCounters& last, const CoreCounters& current, const CpuField field, const size_t i, const __m256i mask)
+		{
+			const __m256d delta = _mm256_sub_pd(ToDouble4(current.Fields[field] + i, mask), ToDouble4(last.Fields[field] + i, mask));
+			return _mm256_max_pd(delta, _mm256_setzero_pd());
+		}
+
+		RS_TARGET_AVX2 void ComputeLoadsAVX2(const CoreCounters& last, const CoreCounters& current, const size_t count, double* loads)
+		{
+			const __m256d hundred = _mm256_set1_pd(100.0);
+			const __m256d noLoad = _mm256_set1_pd(CPUKernels::NO_LOAD);
+
+			for (size_t i = 0; i < count; i += 4)
+			{
+				const __m256i mask = LaneMask(count - i);
+
+				__m256d busy = _mm256_setzero_pd();
+				__m256d idle = _mm256_setzero_pd();
+				for (const auto field : BUSY_FIELDS) { busy = _mm256_add_pd(busy, Delta4(last, current, field, i, mask)); }
+				for (const auto field : IDLE_FIELDS) { idle = _mm256_add_pd(idle, Delta4(last, current, field, i, mask)); }
+
+				const __m256d total = _mm256_add_pd(busy, idle);
+				const __m256d load = _mm256_min_pd(_mm256_mul_pd(_mm256_div_pd(busy, total), hundred), hundred);
+				const __m256d valid = _mm256_cmp_pd(total, _mm256_setzero_pd(), _CMP_GT_OQ);
+				_mm256_maskstore_pd(loads + i, mask, _mm256_blendv_pd(noLoad, load, valid));
+			}
+		}
+
+		RS_TARGET_AVX2 void ComputeStatesAVX2(const CoreCounters& last, const CoreCounters& current, const size_t count, const CoreStates& states)
+		{
+			const __m256d hundred = _mm256_set1_pd(100.0);
+
+			for (size_t i = 0; i < count; i += 4)
+			{
+				const __m256i mask = LaneMask(count - i);
+
+				__m256d delta[CpuField_Count];
+				for (int field = 0; field < CpuField_Count; field++) { delta[field] = Delta4(last, current, (CpuField)field, i, mask); }
+
+				__m256d busy = _mm256_setzero_pd();
+				__m256d idle = _mm256_setzero_pd();
+				for (const auto field : BUSY_FIELDS) { busy = _mm256_add_pd(busy, delta[field]); }
+				for (const auto field : IDLE_FIELDS) { idle = _mm256_add_pd(idle, delta[field]); }
+
+				const __m256d total = _mm256_add_pd(busy, idle);
+				const __m256d valid = _mm256_cmp_pd(total, _mm256_setzero_pd(), _CMP_GT_OQ);
+				const __m256d scale = _mm256_and_pd(valid, _mm256_div_pd(hundred, total));
+				for (const auto& [state, field] : DIRECT_STATES) { _mm256_maskstore_pd(states.States[state] + i, mask, _mm256_mul_pd(delta[field], scale)); }
+
+				const __m256d user = _mm256_max_pd(_mm256_sub_pd(delta[CpuField_User], delta[CpuField_Guest]), _mm256_setzero_pd());
+				const __m256d nice = _mm256_max_pd(_mm256_sub_pd(delta[CpuField_Nice], delta[CpuField_GuestNice]), _mm256_setzero_pd());
+				_mm256_maskstore_pd(states.States[CpuState_User] + i, mask, _mm256_mul_pd(user, scale));
+				_mm256_maskstore_pd(states.States[CpuState_Nice] + i, mask, _mm256_mul_pd(nice, scale));
+				_mm256_maskstore_pd(states.States[CpuState_Guest] + i, mask, _mm256_mul_pd(_mm256_add_pd(delta[CpuField_Guest], delta[CpuField_GuestNice]), scale));
+			}
+		}
+
+		RS_TARGET_AVX2 LoadSummary SummarizeAVX2(const double* loads, const size_t count)
+		{
+			const __m256d inf = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+			const __m256d negInf = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+			const __m256d one = _mm256_set1_pd(1.0);
+
+			__m256d min = inf, max = negInf, sum = _mm256_setzero_pd(), valid = _mm256_setzero_pd();
+			for (size_t i = 0; i < count; i += 4)
+			{
+				// Lanes past the end load as zero, which would count as an idle core
+				const __m256i lanes = LaneMask(count - i);
+				const __m256d load = _mm256_maskload_pd(loads + i, lanes);
+				const __m256d mask = _mm256_and_pd(_mm256_cmp_pd(load, _mm256_setzero_pd(), _CMP_GE_OQ), _mm256_castsi256_pd(lanes));
+				min = _mm256_min_pd(min, _mm256_blendv_pd(inf, load, mask));
+				max = _mm256_max_pd(max, _mm256_blendv_pd(negInf, load, mask));
+				sum = _mm256_add_pd(sum, _mm256_and_pd(mask, load));
+				valid = _mm256_add_pd(valid, _mm256_and_pd(mask, one));
+			}
+
+			alignas(32) double lanes[4][4];
+			_mm256_store_pd(lanes[0], min);
+			_mm256_store_pd(lanes[1], max);
+			_mm256_store_pd(lanes[2], sum);
+			_mm256_store_pd(lanes[3], valid);
+			return MergeSummary({},
+				std::min({ lanes[0][0], lanes[0][1], lanes[0][2], lanes[0][3] }),
+				std::max({ lanes[1][0], lanes[1][1], lanes[1][2], lanes[1][3] }),
+				lanes[2][0] + lanes[2][1] + lanes[2][2] + lanes[2][3],
+				lanes[3][0] + lanes[3][1] + lanes[3][2] + lanes[3][3]);
+		}
+
+		bool HasAVX2()
+		{
+#if defined(_MSC_VER) && !defined(__clang__)
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7) { return false; }
+
+			// The OS must also save the YMM registers on context switches
+			__cpuid(info, 1);
+			const bool osxsave = (info[2] & (1 << 27)) != 0;
+			if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) { return false; }
+
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+#else
+			return __builtin_cpu_supports("avx2");
+#endif
+		}
+
+#endif
+
+		//--------------------------------------------------------------
+		// [SECTION] Dispatch
+		//--------------------------------------------------------------
+
+		struct Kernels
+		{
+			const char* Name;
+			void (*ComputeLoads)(const CoreCounters&, const CoreCounters&, size_t, double*);
+			void (*ComputeStates)(const CoreCounters&, const CoreCounters&, size_t, const CoreStates&);
+			LoadSummary (*Summarize)(const double*, size_t);
+		};
+
+		// Worst to best
+		const std::vector<Kernels>& GetAvailableKernels()
+		{
+			static const std::vector<Kernels> available = [] {
+				std::vector<Kernels> kernels{ { "Scalar", ComputeLoadsScalar, ComputeStatesScalar, SummarizeScalar } };
+#if defined(RS_SIMD_X86)
+				kernels.push_back({ "SSE2", ComputeLoadsSSE2, ComputeStatesSSE2, SummarizeSSE2 });
+				if (HasAVX2()) {
+					kernels.push_back({ "AVX2", ComputeLoadsAVX2, ComputeStatesAVX2, SummarizeAVX2 });
+				}
+#endif
+				return kernels;
+			}();
+			return available;
+		}
+
+		// Only set by benchmarks; sampling threads read it, so it is atomic
+		std::atomic<const Kernels*> sOverride{ nullptr };
+
+		const Kernels& GetKernels()
+		{
+			static const Kernels* best = &GetAvailableKernels().back();
+			const Kernels* chosen = sOverride.load(std::memory_order_acquire);
+			return chosen ? *chosen : *best;
+		}
+
+	}
+
+	void CPUKernels::ComputeLoads(const CoreCounters& last, const CoreCounters& current, const size_t count, double* loads)
+	{
+		GetKernels().ComputeLoads(last, current, count, loads);
+	}
+
+	void CPUKernels::ComputeStates(const CoreCounters& last, const CoreCounters& current, const size_t count, const CoreStates& states)
+	{
+		GetKernels().ComputeStates(last, current, count, states);
+	}
+
+	LoadSummary CPUKernels::Summarize(const double* loads, const size_t count)
+	{
+		return GetKernels().Summarize(loads, count);
+	}
+
+	const char* CPUKernels::GetInstructionSet()
+	{
+		return GetKernels().Name;
+	}
+
+	std::vector<const char*> CPUKernels::GetInstructionSets()
+	{
+		std::vector<const char*> names;
+		for (const auto& kernels : GetAvailableKernels()) {
+			names.emplace_back(kernels.Name);
+		}
+		return names;
+	}
+
+	bool CPUKernels::SetInstructionSet(const char* name)
+	{
+		for (const auto& kernels : GetAvailableKernels()) {
+			if (std::strcmp(kernels.Name, name) == 0) {
+				sOverride.store(&kernels, std::memory_order_release);
+				return true;
+			}
+		}
+		return false;
+	}
+
+}
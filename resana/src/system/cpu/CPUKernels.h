@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace RESANA {
+
+	// Per-core time counters, in the order of a /proc/stat "cpuN" line
+	enum CpuField
+	{
+		CpuField_User = 0,
+		CpuField_Nice,
+		CpuField_System,
+		CpuField_Idle,
+		CpuField_IOWait,
+		CpuField_Irq,
+		CpuField_SoftIrq,
+		CpuField_Steal,
+		CpuField_Guest,     // Also counted in user
+		CpuField_GuestNice, // Also counted in nice
+		CpuField_Count
+	};
+
+	// Where a core's time went, as shown; guest time is taken out of user and nice
+	enum CpuState
+	{
+		CpuState_User = 0,
+		CpuState_Nice,
+		CpuState_System,
+		CpuState_Irq,
+		CpuState_SoftIrq,
+		CpuState_IOWait,
+		CpuState_Steal,
+		CpuState_Guest,
+		CpuState_Idle,
+		CpuState_Count
+	};
+
+	// One array per field, indexed by core number
+	struct CoreCounters
+	{
+		const uint64_t* Fields[CpuField_Count]{};
+	};
+
+	// One output array per state, indexed by core number
+	struct CoreStates
+	{
+		double* States[CpuState_Count]{};
+	};
+
+	struct LoadSummary
+	{
+		double Min{};
+		double Max{};
+		double Average{};
+		uint32_t Count{}; // Cores with a load; the others are left out
+	};
+
+	/*
+	 * Loops over every core that run on each sample. They are vectorised with
+	 * SSE2 and AVX2, picked once at run time from what the processor supports,
+	 * and fall back to plain loops elsewhere; all paths give the same results.
+	 */
+	class CPUKernels {
+	public:
+		// Percent busy per core between two samples; cores whose counters did not
+		// move (offline, or sampled twice within a tick) get NO_LOAD
+		static void ComputeLoads(const CoreCounters& last, const CoreCounters& current, size_t count, double* loads);
+
+		// Percent of each core's time spent in each state; cores whose counters
+		// did not move get zero in every state
+		static void ComputeStates(const CoreCounters& last, const CoreCounters& current, size_t count, const CoreStates& states);
+
+		// Min, max and average over the cores that have a load
+		static LoadSummary Summarize(const double* loads, size_t count);
+
+		// Name of the instruction set in use, for diagnostics
+		static const char* GetInstructionSet();
+
+		// Every instruction set this build and processor can run. Switching is
+		// meant for benchmarks only; sampling uses the best set unless overridden.
+		static std::vector<const char*> GetInstructionSets();
+		static bool SetInstructionSet(const char* name);
+
+	public:
+		static constexpr double NO_LOAD = -1.0;
+	};
+
+}
@@ -2,16 +2,13 @@
 #include "CPUPerformance.h"
 
 #include "core/Core.h"
-#include "core/Application.h"
 
 #include "helpers/Container.h"
+#include "system/SelfProfiler.h"
 
+#include <limits>
 #include <mutex>
 
-#include <PdhMsg.h>
-#include <Psapi.h>
-#include <Windows.h>
-
 namespace RESANA {
 
 	CPUPerformance* CPUPerformance::sInstance = nullptr;
@@ -24,45 +21,40 @@ namespace RESANA {
 
 	CPUPerformance::~CPUPerformance()
 	{
-		Time::Sleep(mUpdateInterval); // Let threads finish before destructing
-
 		std::mutex mutex;
 		std::unique_lock<std::mutex> lock(mutex);
 
 		auto& lc = GetLockContainer();
 		while (mDataBusy) { lc.Wait(lock); }
+
+		for (; !mDataQueue.empty(); mDataQueue.pop()) {
+			delete mDataQueue.front();
+		}
+		for (const auto* data : mFreeData) {
+			delete data;
+		}
 	}
 
 	void CPUPerformance::InitCPUData()
 	{
-		SYSTEM_INFO sysInfo;
-		GetSystemInfo(&sysInfo);
-		mNumProcessors = (int)sysInfo.dwNumberOfProcessors;
-
-		PDH_STATUS pdhStatus = PdhOpenQuery(nullptr, 0, &mCPUCounter.Query);
-
-		if (pdhStatus != ERROR_SUCCESS) {
-			RS_CORE_ERROR("PdhOpenQuery failed with 0x{0}", pdhStatus);
+		mSampler = CPUSampler::Create();
+		if (!mSampler) {
+			RS_CORE_ERROR("No CPU sampler for this platform");
+			return;
 		}
+		mNumProcessors = mSampler->GetNumProcessors();
+		mTopology.Detect();
 
-		// Specify a counter object with a wildcard for the instance.
-		pdhStatus = PdhAddCounter(mCPUCounter.Query, TEXT("\\Processor(*)\\% Processor Time"), 0, &mCPUCounter.Counter);
-		if (pdhStatus != ERROR_SUCCESS) {
-			RS_CORE_ERROR("PdhAddCounter failed with 0x{0}", pdhStatus);
-		}
+		// The first sample only sets the baseline for the next one
+		LogicalCoreData data;
+		mSampler->Sample(data);
 	}
 
 	void CPUPerformance::InitProcessData()
 	{
-		FILETIME ftime, fsys, fuser;
-
-		GetSystemTimeAsFileTime(&ftime);
-		memcpy(&mProcCounter.Last, &ftime, sizeof(FILETIME));
-
-		mProcCounter.Handle = GetCurrentProcess();
-		GetProcessTimes(mProcCounter.Handle, &ftime, &ftime, &fsys, &fuser);
-		memcpy(&mProcCounter.LastSys, &fsys, sizeof(FILETIME));
-		memcpy(&mProcCounter.LastUser, &fuser, sizeof(FILETIME));
+		if (mSampler) {
+			mSampler->SampleProcessTimes(mLastWallTime, mLastProcessTime);
+		}
 	}
 
 	void CPUPerformance::Run()
@@ -75,12 +67,10 @@ namespace RESANA {
 		{
 			sInstance->mRunning = true;
 
-			const auto& app = Application::Get();
-			auto& threadPool = app.GetThreadPool();
-
-			threadPool.Queue([&] { sInstance->PrepareDataThread(); });
-			threadPool.Queue([&] { sInstance->ProcessDataThread(); });
-			threadPool.Queue([&] { sInstance->CalcProcessLoadThread(); });
+			// Both loops live as long as the collector, so they don't take pool workers
+			auto* cpu = sInstance;
+			cpu->mSampleThread.Start([cpu] { cpu->PrepareDataThread(); });
+			cpu->mProcessThread.Start([cpu] { cpu->ProcessDataThread(); });
 		}
 	}
 
@@ -88,9 +78,16 @@ namespace RESANA {
 	{
 		if (sInstance && sInstance->IsRunning())
 		{
-			sInstance->mRunning = false;
+			{
+				std::scoped_lock lock(sInstance->mScheduleMutex);
+				sInstance->mRunning = false;
+			}
+			sInstance->mScheduleChanged.notify_all();
 			auto& lc = sInstance->GetLockContainer();
 			lc.NotifyAll();
+
+			sInstance->mSampleThread.Stop();
+			sInstance->mProcessThread.Stop();
 		}
 	}
 
@@ -99,19 +96,11 @@ namespace RESANA {
 		if (sInstance)
 		{
 			Stop();
-			const auto& app = Application::Get();
-			auto& threadPool = app.GetThreadPool();
-			threadPool.Queue([&] {sInstance->Destroy(); });
+			delete sInstance;
 			sInstance = nullptr;
 		}
 	}
 
-	void CPUPerformance::Destroy() const
-	{
-		sInstance = nullptr;
-		delete this;
-	}
-
 	CPUPerformance* CPUPerformance::Get()
 	{
 		if (!sInstance)
@@ -158,43 +147,18 @@ namespace RESANA {
 
 	double CPUPerformance::GetCurrentLoad()
 	{
-		PDH_FMT_COUNTERVALUE counterValue{};
-
-		PDH_STATUS pdhStatus = PdhOpenQuery(nullptr, 0, &mLoadCounter.Query);
-
-		if (pdhStatus != ERROR_SUCCESS) {
-			RS_CORE_ERROR("PdhOpenQuery failed with 0x{0}", pdhStatus);
-		}
-
-		// Specify a counter object with a wildcard for the instance.
-		pdhStatus = PdhAddCounter(mLoadCounter.Query,
-			TEXT("\\Processor(_Total)\\% Processor Time"), 0, &mLoadCounter.Counter);
-		if (pdhStatus != ERROR_SUCCESS) {
-			RS_CORE_ERROR("PdhAddCounter failed with 0x{0}", pdhStatus);
+		// Between scheduled samples, the last delta is as current as it gets
+		if (IsRunning()) {
+			return mCurrentLoad;
 		}
 
-		pdhStatus = PdhCollectQueryData(mLoadCounter.Query);
-		if (pdhStatus != ERROR_SUCCESS) {
-			RS_CORE_ERROR("PdhCollectQueryData failed with 0x{0}", pdhStatus);
+		// Otherwise take one now; the sampler still holds the counters of its last read
+		std::scoped_lock lock(mSamplerMutex);
+		LogicalCoreData data;
+		if (mSampler && mSampler->Sample(data)) {
+			mCurrentLoad = data.GetTotalLoad() > 0.0 ? data.GetTotalLoad() : 0.0;
 		}
-
-		Time::Sleep(mUpdateInterval); // Sleep for one second.
-
-		pdhStatus = PdhCollectQueryData(mLoadCounter.Query);
-		if (pdhStatus == ERROR_SUCCESS)
-		{
-			pdhStatus = PdhGetFormattedCounterValue(mLoadCounter.Counter,
-				PDH_FMT_DOUBLE | PDH_FMT_NOCAP100, nullptr, &counterValue);
-
-			if (pdhStatus == PDH_CALC_NEGATIVE_DENOMINATOR) {
-				RS_CORE_ERROR("PdhCollectQueryData failed with 0x{0}", pdhStatus);
-			}
-		}
-		else {
-			RS_CORE_ERROR("PdhCollectQueryData failed with 0x{0}", pdhStatus);
-		}
-
-		return counterValue.doubleValue > 0.0 ? counterValue.doubleValue : 0.0;
+		return mCurrentLoad;
 	}
 
 	double CPUPerformance::GetCurrentProcessLoad() const
@@ -211,7 +175,12 @@ namespace RESANA {
 
 	void CPUPerformance::SetUpdateInterval(Timestep interval)
 	{
-		mUpdateInterval = interval;
+		// Called every frame; only a new interval needs to reschedule the next sample
+		if (mUpdateInterval.exchange((uint32_t)interval) != (uint32_t)interval)
+		{
+			{ std::scoped_lock lock(mScheduleMutex); } // So the wake can't fall between the check and the wait
+			mScheduleChanged.notify_all();
+		}
 	}
 
 	bool CPUPerformance::IsRunning() const
@@ -223,8 +192,11 @@ namespace RESANA {
 	{
 		while (IsRunning())
 		{
+			SelfProfiler::Scope scope(Subsystem_CPU);
 			const auto data = PrepareData();
 			PushData(data);
+			CalcProcessLoad();
+			WaitForNextSample();
 		}
 	}
 
@@ -232,70 +204,42 @@ namespace RESANA {
 	{
 		while (IsRunning())
 		{
+			SelfProfiler::Scope scope(Subsystem_CPU);
 			auto* data = ExtractData();
 			ProcessData(data);
 			SetData(data);
 		}
 	}
 
-	LogicalCoreData* CPUPerformance::PrepareData() const
+	void CPUPerformance::WaitForNextSample()
 	{
-		auto data = new LogicalCoreData();
-		bool success = true;
-		PdhItem* processorRef = nullptr;
-
-		// Some counters need two samples in order to format a value, so
-		// make this call to get the first value before entering the loop.
-		PDH_STATUS pdhStatus = PdhCollectQueryData(mCPUCounter.Query);
-
-		if (pdhStatus != ERROR_SUCCESS) {
-			RS_CORE_ERROR("PdhCollectQueryData failed with 0x{0}", pdhStatus);
-			success = false;
-		}
-
-		Time::Sleep(mUpdateInterval); // Sleep for 1 second on this thread.
-
-		pdhStatus = PdhCollectQueryData(mCPUCounter.Query);
-		if (pdhStatus != ERROR_SUCCESS) {
-			RS_CORE_ERROR("PdhCollectQueryData failed with 0x{0}", pdhStatus);
-			success = false;
-		}
-
-
-		/* FAILS HERE */
-		// Get the required size of the data buffer.
-		pdhStatus = PdhGetFormattedCounterArray(mCPUCounter.Counter, PDH_FMT_DOUBLE,
-			&data->GetBuffer(), &data->GetSize(), processorRef);
-
-		if (pdhStatus != PDH_MORE_DATA) {
-			RS_CORE_ERROR("PdhGetFormattedCounterArray failed with 0x{0}", pdhStatus);
-			success = false;
-		}
-
-		processorRef = (PdhItem*)malloc(data->GetBuffer());
-		if (!processorRef) {
-			RS_CORE_ERROR("malloc for PdhGetFormattedCounterArray failed 0x{0}", pdhStatus);
-			success = false;
+		// The deadline is re-read on every wake, so a new interval applies to the sample in progress
+		std::unique_lock lock(mScheduleMutex);
+		while (IsRunning())
+		{
+			const auto next = mLastSample + std::chrono::milliseconds(mUpdateInterval.load());
+			if (std::chrono::steady_clock::now() >= next) { return; }
+			mScheduleChanged.wait_until(lock, next);
 		}
+	}
 
-		pdhStatus = PdhGetFormattedCounterArray(mCPUCounter.Counter, PDH_FMT_DOUBLE,
-			&data->GetBuffer(), &data->GetSize(), processorRef);
+	LogicalCoreData* CPUPerformance::PrepareData()
+	{
+		std::scoped_lock lock(mSamplerMutex);
+		mLastSample = std::chrono::steady_clock::now();
 
-		if (pdhStatus != ERROR_SUCCESS) {
-			RS_CORE_ERROR("PdhGetFormattedCounterArray failed with 0x{0}", pdhStatus);
-			success = false;
-		}
+		if (!mSampler) { return nullptr; }
 
-		if (success) {
-			data->SetProcessorRef(processorRef);
-		}
-		else
+		auto data = TakeFreeData();
+		if (!mSampler->Sample(*data))
 		{
-			// In case of an error, free the memory
-			delete data;
-			data = nullptr;
+			RecycleData(data);
+			return nullptr;
 		}
 
+		mFrequencyCollector.Refresh(*data);
+
+		mCurrentLoad = data->GetTotalLoad() > 0.0 ? data->GetTotalLoad() : 0.0;
 		return data;
 	}
 
@@ -322,10 +266,11 @@ namespace RESANA {
 		auto& lc = GetLockContainer();
 		LogicalCoreData* data = nullptr;
 
+		// Bounded, as the notify of a Stop can fall between the check and the wait
 		while (mDataQueue.empty())
 		{
 			if (!IsRunning()) { return nullptr; }
-			lc.Wait(lock);
+			lc.WaitFor(lock, std::chrono::milliseconds(mUpdateInterval.load()));
 		}
 		lock.unlock();
 		std::lock(mutex, lc.GetMutex());
@@ -349,66 +294,47 @@ namespace RESANA {
 		std::mutex mutex;
 		auto& lc = GetLockContainer();
 
-		const auto processorPtr = data->GetProcessorRef();
+		std::lock(mutex, lc.GetMutex());
+		std::lock_guard lock1(mutex, std::adopt_lock);
+		std::lock_guard lock2(lc.GetMutex(), std::adopt_lock);
 
-		// Loop through the array and add _Total to deque and cpu values into the local vector
-		for (DWORD i = 0; i < data->GetSize(); ++i)
-		{
-			const auto processor = new PdhItem(processorPtr[i]);
-			if (!processor) { continue; }
+		// Remove the oldest value
+		if (mCPULoadValues.size() == MAX_LOAD_COUNT) {
+			mCPULoadValues.pop_front();
+		}
 
-			const auto name = processor->szName;
-			auto value = processor->FmtValue.doubleValue;
+		// Add the current value and compute the average
+		mCPULoadValues.push_back(data->GetTotalLoad());
+		mCPULoadAvg = CalculateAverage(mCPULoadValues);
 
-			if (std::strcmp(name, "_Total") == 0)
-			{
-				std::lock(mutex, lc.GetMutex());
-				std::lock_guard lock1(mutex, std::adopt_lock);
-				std::lock_guard lock2(lc.GetMutex(), std::adopt_lock);
-
-				// Remove the oldest value
-				if (mCPULoadValues.size() == MAX_LOAD_COUNT) {
-					mCPULoadValues.pop_front();
-				}
-
-				// Add the current value and compute the average
-				mCPULoadValues.push_back(value);
-				mCPULoadAvg = CalculateAverage(mCPULoadValues);
-			}
-			else {
-				// Add the processor
-				auto copy = new PdhItem(*processor);
-				data->GetProcessors().emplace_back(copy);
-			}
-		}
-	}
+		const auto now = MetricHistory::Clock::now();
+		mLoadHistory.Append(now, (float)data->GetTotalLoad());
+		mStateHistory.Append(now, data->GetTotalStates().data());
 
-	void CPUPerformance::CalcProcessLoadThread()
-	{
-		while (mRunning) { CalcProcessLoad(); Time::Time::Sleep(mUpdateInterval); }
+		// Hotplug beyond the configured cores is rare enough to just start the per-core history over
+		const auto& processors = data->GetProcessors();
+		if (mCoreHistory.GetSeriesCount() != processors.size()) {
+			mCoreHistory.Resize(processors.size());
+		}
+		mCoreLoads.resize(processors.size());
+		for (size_t i = 0; i < processors.size(); i++) {
+			mCoreLoads[i] = processors[i].Online ? (float)processors[i].Load : std::numeric_limits<float>::quiet_NaN();
+		}
+		mCoreHistory.Append(now, mCoreLoads.data());
 	}
 
 	void CPUPerformance::CalcProcessLoad()
 	{
-		static FILETIME ftime, fsys, fuser;
-		static ULARGE_INTEGER now, sys, user;
-		static double percent;
-
-		GetSystemTimeAsFileTime(&ftime);
-		memcpy(&now, &ftime, sizeof(FILETIME));
+		uint64_t now = 0, cpuTime = 0;
+		if (!mSampler || !mSampler->SampleProcessTimes(now, cpuTime)) { return; }
+		if (now <= mLastWallTime) { return; }
 
-		GetProcessTimes(mProcCounter.Handle, &ftime, &ftime, &fsys, &fuser);
-		memcpy(&sys, &fsys, sizeof(FILETIME));
-		memcpy(&user, &fuser, sizeof(FILETIME));
-
-		percent = (double)(sys.QuadPart - mProcCounter.LastSys.QuadPart) +
-			(double)(user.QuadPart - mProcCounter.LastUser.QuadPart);
-		percent /= (double)(now.QuadPart - mProcCounter.Last.QuadPart);
+		double percent = (double)(cpuTime - mLastProcessTime);
+		percent /= (double)(now - mLastWallTime);
 		percent /= GetNumProcessors();
 
-		mProcCounter.Last = now;
-		mProcCounter.LastUser = user;
-		mProcCounter.LastSys = sys;
+		mLastWallTime = now;
+		mLastProcessTime = cpuTime;
 		mProcessLoad = percent * 100;
 	}
 
@@ -416,16 +342,14 @@ namespace RESANA {
 	{
 		if (!sInstance || !data) { return; }
 
-		SortAscending(data);
-
 		std::mutex mutex;
 		std::unique_lock<std::mutex> lock(mutex);
 		auto& lc = GetLockContainer();
 
 		while (mDataBusy)
 		{
-			if (!IsRunning()) { return; }
-			lc.Wait(lock);
+			if (!IsRunning()) { RecycleData(data); return; }
+			lc.WaitFor(lock, std::chrono::milliseconds(mUpdateInterval.load()));
 		}
 		lock.unlock();
 
@@ -435,21 +359,30 @@ namespace RESANA {
 			std::lock_guard lock1(mutex, std::adopt_lock);
 			std::lock_guard lock2(lc.GetMutex(), std::adopt_lock);
 
-			mLogicalCoreData.reset(data);
+			// Copied in place, so the panel's buffer keeps its storage
+			mLogicalCoreData->Copy(data);
 		}
+		RecycleData(data);
 		mDataReady = true;
 		lc.NotifyAll();
 	}
 
-	LogicalCoreData* CPUPerformance::SortAscending(LogicalCoreData* data)
+	LogicalCoreData* CPUPerformance::TakeFreeData()
 	{
-		auto& processors = data->GetProcessors();
-		std::sort(processors.begin(), processors.end(),
-			[&](const auto* left, const auto* right) {
-				return std::stoi(left->szName) < std::stoi(right->szName);
-			});
+		std::scoped_lock lock(GetLockContainer().GetMutex());
+		if (mFreeData.empty()) {
+			return new LogicalCoreData(); // Only until the pipeline has one buffer per stage
+		}
 
+		auto* data = mFreeData.back();
+		mFreeData.pop_back();
 		return data;
 	}
 
+	void CPUPerformance::RecycleData(LogicalCoreData* data)
+	{
+		std::scoped_lock lock(GetLockContainer().GetMutex());
+		mFreeData.push_back(data);
+	}
+
 }
\ No newline at end of file
@@ -1,10 +1,18 @@
 #pragma once
 
 #include "system/base/ConcurrentProcess.h"
+#include "system/ServiceThread.h"
+#include "CPUFrequencyCollector.h"
+#include "CPUSampler.h"
+#include "CPUTopology.h"
 #include "LogicalCoreData.h"
 
+#include "helpers/MetricHistory.h"
 #include "helpers/Time.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <queue>
 #include <deque>
 
@@ -22,10 +30,16 @@ namespace RESANA {
 		std::shared_ptr<LogicalCoreData> GetData();
 
 		[[nodiscard]] int GetNumProcessors() const;
+		[[nodiscard]] const CPUTopology& GetTopology() const { return mTopology; }
 		[[nodiscard]] double GetAverageLoad() const;
 		[[nodiscard]] double GetCurrentLoad();
 		[[nodiscard]] double GetCurrentProcessLoad() const;
 
+		// Total load, load per core (missing while offline) and total share of each CpuState
+		[[nodiscard]] const MetricHistory& GetLoadHistory() const { return mLoadHistory; }
+		[[nodiscard]] const MetricHistory& GetCoreHistory() const { return mCoreHistory; }
+		[[nodiscard]] const MetricHistory& GetStateHistory() const { return mStateHistory; }
+
 		// Must be called after GetData() to unlock mutex
 		void ReleaseData();
 		void SetUpdateInterval(Timestep interval);
@@ -40,44 +54,61 @@ namespace RESANA {
 		void InitCPUData();
 		void InitProcessData();
 
-		// Calls destructor on new thread
-		void Destroy() const;
-
 		// Threads
 		void PrepareDataThread();
 		void ProcessDataThread();
-		void CalcProcessLoadThread();
+		void WaitForNextSample();
 
 		// Called from threads
-		[[nodiscard]] LogicalCoreData* PrepareData() const;
+		[[nodiscard]] LogicalCoreData* PrepareData();
 		LogicalCoreData* ExtractData();
 		void CalcProcessLoad();
 		void SetData(LogicalCoreData* data);
 		void PushData(LogicalCoreData* data);
 		void ProcessData(LogicalCoreData* data);
 
-		// Helpers
-		static LogicalCoreData* SortAscending(LogicalCoreData* data);
+		// Sample buffers are reused rather than allocated per tick
+		LogicalCoreData* TakeFreeData();
+		void RecycleData(LogicalCoreData* data);
 
 	private:
 		const unsigned int MAX_LOAD_COUNT = 3;
 
 		bool mRunning = false;
-		uint32_t mUpdateInterval{};
+		std::atomic<uint32_t> mUpdateInterval{};
 		std::atomic<bool> mDataReady;
 		std::atomic<bool> mDataBusy;
 
 		std::shared_ptr<LogicalCoreData> mLogicalCoreData{};
 		std::queue<LogicalCoreData*> mDataQueue{};
+		std::vector<LogicalCoreData*> mFreeData{};
 		std::deque<double> mCPULoadValues{};
 
 		double mCPULoadAvg{};
+		std::atomic<double> mCurrentLoad{}; // Total load over the last sample
 		double mProcessLoad{};
 		int mNumProcessors{};
-
-		PDHCounter mCPUCounter{};
-		PDHCounter mLoadCounter{};
-		PDHCounter mProcCounter{};
+		CPUTopology mTopology{};
+
+		MetricHistory mLoadHistory{};
+		MetricHistory mCoreHistory{ 0, HistoryPrecision_Percent }; // Sized by the first sample; 77 KB a core, 20 MB at 256
+		MetricHistory mStateHistory{ CpuState_Count };
+		std::vector<float> mCoreLoads{};
+
+		// Samples are taken on a schedule and only read counters, so they can be
+		// spaced by the interval without ever sleeping inside a sample
+		std::unique_ptr<CPUSampler> mSampler{};
+		CPUFrequencyCollector mFrequencyCollector{};
+		std::mutex mSamplerMutex{};
+		std::mutex mScheduleMutex{};
+		std::condition_variable mScheduleChanged{};
+		std::chrono::steady_clock::time_point mLastSample{};
+		uint64_t mLastWallTime{}; // Of the previous process load sample, in 100ns units
+		uint64_t mLastProcessTime{};
+
+		// Declared last, so they are joined before anything they use is destroyed
+		ServiceThread mSampleThread{ "CPU sample" };
+		ServiceThread mProcessThread{ "CPU process" };
 
 		static CPUPerformance* sInstance;
 	};
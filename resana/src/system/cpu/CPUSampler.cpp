@@ -0,0 +1,25 @@
+#include "rspch.h"
+#include "CPUSampler.h"
+
+#include "core/Core.h"
+
+#if defined(RS_PLATFORM_WINDOWS)
+#include "PDHSampler.h"
+#elif defined(RS_PLATFORM_LINUX)
+#include "ProcStatSampler.h"
+#endif
+
+namespace RESANA {
+
+	std::unique_ptr<CPUSampler> CPUSampler::Create()
+	{
+#if defined(RS_PLATFORM_WINDOWS)
+		return std::make_unique<PDHSampler>();
+#elif defined(RS_PLATFORM_LINUX)
+		return std::make_unique<ProcStatSampler>();
+#else
+		return nullptr;
+#endif
+	}
+
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "LogicalCoreData.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace RESANA {
+
+	/*
+	 * Source of CPU load for CPUPerformance. Each backend keeps the counters of
+	 * its previous sample and reports the load since then, so a sample is one
+	 * read of the counters rather than a sleep between two.
+	 */
+	class CPUSampler
+	{
+	public:
+		virtual ~CPUSampler() = default;
+
+		// The backend for this platform
+		static std::unique_ptr<CPUSampler> Create();
+
+		[[nodiscard]] virtual int GetNumProcessors() const = 0;
+
+		// Fills in per-core and total load since the previous call; false until there are two samples
+		virtual bool Sample(LogicalCoreData& data) = 0;
+
+		// Wall clock and CPU time used by this process, both in 100ns units
+		virtual bool SampleProcessTimes(uint64_t& wallTime, uint64_t& cpuTime) = 0;
+	};
+
+}
@@ -0,0 +1,290 @@
+#include "rspch.h"
+#include "CPUTopology.h"
+
+#include "core/Core.h"
+#include "helpers/ProcFS.h"
+
+#include <map>
+#include <tuple>
+
+#if defined(RS_PLATFORM_WINDOWS)
+#include <Windows.h>
+#elif defined(RS_PLATFORM_LINUX)
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+namespace RESANA {
+
+	namespace {
+
+		// Hands out dense indices for whatever identifies a group on the platform
+		template <typename Key>
+		class DenseIds
+		{
+		public:
+			int32_t Get(const Key& key)
+			{
+				const auto [it, inserted] = mIds.try_emplace(key, (int32_t)mIds.size());
+				return it->second;
+			}
+
+		private:
+			std::map<Key, int32_t> mIds{};
+		};
+
+	}
+
+#if defined(RS_PLATFORM_LINUX)
+
+	namespace {
+
+		bool ReadInt(const char* path, int64_t& value)
+		{
+			char buffer[32];
+			if (ProcFS::ReadFile(path, buffer, sizeof(buffer)) <= 0) { return false; }
+			ProcFS::ParseInt64(buffer, value);
+			return true;
+		}
+
+	}
+
+	void CPUTopology::Detect()
+	{
+		const long configured = sysconf(_SC_NPROCESSORS_CONF);
+		mCores.assign(configured > 0 ? (size_t)configured : 1, {});
+
+		DenseIds<int64_t> packages;
+		DenseIds<std::tuple<int64_t, int64_t, int64_t>> cores;
+		DenseIds<std::tuple<int32_t, int64_t>> l3Domains;   // Package, and first processor sharing the cache
+		DenseIds<int64_t> l2Domains;
+		DenseIds<int64_t> nodes;
+
+		char path[128];
+		char buffer[256];
+		for (size_t cpu = 0; cpu < mCores.size(); cpu++)
+		{
+			auto& core = mCores[cpu];
+
+			// Offline processors have no topology directory
+			int64_t package = 0, die = 0, coreId = 0;
+			snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%zu/topology/physical_package_id", cpu);
+			if (!ReadInt(path, package)) { continue; }
+			snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%zu/topology/die_id", cpu);
+			ReadInt(path, die);
+			snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%zu/topology/core_id", cpu);
+			ReadInt(path, coreId);
+
+			core.Package = packages.Get(package);
+			core.Die = (int32_t)die;
+			core.PhysicalCore = cores.Get({ package, die, coreId });
+
+			// The lowest processor sharing a cache names it, which works on kernels without cache ids
+			for (int index = 0; index < 8; index++)
+			{
+				int64_t level = 0;
+				snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%zu/cache/index%d/level", cpu, index);
+				if (!ReadInt(path, level)) { break; }
+				if (level < 2) { continue; }
+
+				snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%zu/cache/index%d/shared_cpu_list", cpu, index);
+				uint64_t first = 0;
+				if (ProcFS::ReadFile(path, buffer, sizeof(buffer)) <= 0) { continue; }
+				ProcFS::ParseUInt64(buffer, first);
+
+				if (level == 2) {
+					core.L2 = l2Domains.Get((int64_t)first);
+				} else if (level == 3) {
+					core.L3 = l3Domains.Get({ core.Package, (int64_t)first });
+				}
+			}
+
+			// Without an L3 the package is the shared domain
+			if (core.L3 < 0) {
+				core.L3 = l3Domains.Get({ core.Package, -1 });
+			}
+		}
+
+		// NUMA nodes list their processors
+		std::vector<uint32_t> cpus;
+		if (DIR* dir = opendir("/sys/devices/system/node"))
+		{
+			while (const dirent* entry = readdir(dir))
+			{
+				if (std::strncmp(entry->d_name, "node", 4) != 0 || !ProcFS::IsNumeric(entry->d_name + 4)) { continue; }
+
+				snprintf(path, sizeof(path), "/sys/devices/system/node/%s/cpulist", entry->d_name);
+				if (ProcFS::ReadFile(path, buffer, sizeof(buffer)) <= 0) { continue; }
+
+				cpus.clear();
+				ProcFS::ParseCpuList(buffer, cpus);
+				const int32_t node = nodes.Get(std::strtoll(entry->d_name + 4, nullptr, 10));
+				for (const uint32_t cpu : cpus) {
+					if (cpu < mCores.size()) { mCores[cpu].Node = node; }
+				}
+			}
+			closedir(dir);
+		}
+
+		BuildChildren();
+	}
+
+#elif defined(RS_PLATFORM_WINDOWS)
+
+	void CPUTopology::Detect()
+	{
+		DWORD length = 0;
+		GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+		if (GetLastError() != ERROR_INSUFFICIENT_BUFFER) { return; }
+
+		std::vector<char> buffer(length);
+		auto* info = (SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*)buffer.data();
+		if (!GetLogicalProcessorInformationEx(RelationAll, info, &length)) { return; }
+
+		// Processors are numbered group * 64 + index, as PDH names them
+		const auto forEachProcessor = [this](const GROUP_AFFINITY& affinity, const auto& fn) {
+			for (uint32_t bit = 0; bit < 64; bit++)
+			{
+				if (!(affinity.Mask & ((KAFFINITY)1 << bit))) { continue; }
+				const size_t cpu = (size_t)affinity.Group * 64 + bit;
+				if (cpu >= mCores.size()) { mCores.resize(cpu + 1); }
+				fn(mCores[cpu]);
+			}
+		};
+
+		int32_t packages = 0, cores = 0, l2Domains = 0, l3Caches = 0, nodes = 0;
+
+		for (DWORD offset = 0; offset < length;)
+		{
+			const auto* entry = (const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*)(buffer.data() + offset);
+			switch (entry->Relationship)
+			{
+			case RelationProcessorPackage:
+				for (WORD group = 0; group < entry->Processor.GroupCount; group++) {
+					forEachProcessor(entry->Processor.GroupMask[group], [&](CoreTopology& core) { core.Package = packages; core.Die = 0; });
+				}
+				packages++;
+				break;
+			case RelationProcessorCore:
+			{
+				int32_t thread = 0;
+				for (WORD group = 0; group < entry->Processor.GroupCount; group++) {
+					forEachProcessor(entry->Processor.GroupMask[group], [&](CoreTopology& core) { core.PhysicalCore = cores; core.Thread = thread++; });
+				}
+				cores++;
+				break;
+			}
+			case RelationCache:
+				if (entry->Cache.Level == 2) {
+					forEachProcessor(entry->Cache.GroupMask, [&](CoreTopology& core) { core.L2 = l2Domains; });
+					l2Domains++;
+				} else if (entry->Cache.Level == 3) {
+					forEachProcessor(entry->Cache.GroupMask, [&](CoreTopology& core) { core.L3 = l3Caches; });
+					l3Caches++;
+				}
+				break;
+			case RelationNumaNode:
+				forEachProcessor(entry->NumaNode.GroupMask, [&](CoreTopology& core) { core.Node = nodes; });
+				nodes++;
+				break;
+			default:
+				break;
+			}
+			offset += entry->Size;
+		}
+
+		// Packages may come after caches, so the L3 domains are numbered within them here
+		DenseIds<std::tuple<int32_t, int32_t>> l3Domains;
+		for (auto& core : mCores)
+		{
+			if (core.Package < 0) { continue; }
+			core.L3 = l3Domains.Get({ core.Package, core.L3 });
+		}
+
+		BuildChildren();
+	}
+
+#else
+
+	void CPUTopology::Detect()
+	{
+	}
+
+#endif
+
+	void CPUTopology::BuildChildren()
+	{
+		mPackages.clear();
+		mL3Domains.clear();
+		mPhysicalCores.clear();
+		mNodes.clear();
+
+		const auto addChild = [](std::vector<std::vector<int32_t>>& parents, const int32_t parent, const int32_t child) {
+			if (parent < 0 || child < 0) { return; }
+			if ((size_t)parent >= parents.size()) { parents.resize((size_t)parent + 1); }
+
+			auto& children = parents[parent];
+			if (std::find(children.begin(), children.end(), child) == children.end()) {
+				children.push_back(child);
+			}
+		};
+
+		for (int32_t cpu = 0; cpu < (int32_t)mCores.size(); cpu++)
+		{
+			const auto& core = mCores[cpu];
+			addChild(mPackages, core.Package, core.L3);
+			addChild(mL3Domains, core.L3, core.PhysicalCore);
+			addChild(mPhysicalCores, core.PhysicalCore, cpu);
+			addChild(mNodes, core.Node, cpu);
+		}
+
+		// Siblings are numbered in processor order
+		for (const auto& siblings : mPhysicalCores)
+		{
+			for (size_t i = 0; i < siblings.size(); i++) {
+				mCores[siblings[i]].Thread = (int32_t)i;
+			}
+		}
+	}
+
+	void CPUTopology::Aggregate(const std::vector<CoreLoad>& cores, TopologyLoad& load) const
+	{
+		const auto reset = [](std::vector<TopologyGroup>& groups, const size_t count) {
+			groups.resize(count);
+			std::fill(groups.begin(), groups.end(), TopologyGroup{});
+		};
+		reset(load.Packages, mPackages.size());
+		reset(load.L3Domains, mL3Domains.size());
+		reset(load.PhysicalCores, mPhysicalCores.size());
+		reset(load.Nodes, mNodes.size());
+
+		const auto add = [](std::vector<TopologyGroup>& groups, const int32_t id, const double value) {
+			if (id < 0 || (size_t)id >= groups.size()) { return; }
+			auto& group = groups[id];
+			group.Load += value;
+			group.MaxLoad = std::max(group.MaxLoad, value);
+			group.Online++;
+			group.Busy += value > BUSY_LOAD ? 1 : 0;
+		};
+
+		const size_t count = std::min(cores.size(), mCores.size());
+		for (size_t cpu = 0; cpu < count; cpu++)
+		{
+			if (!cores[cpu].Online) { continue; }
+
+			const auto& core = mCores[cpu];
+			add(load.Packages, core.Package, cores[cpu].Load);
+			add(load.L3Domains, core.L3, cores[cpu].Load);
+			add(load.PhysicalCores, core.PhysicalCore, cores[cpu].Load);
+			add(load.Nodes, core.Node, cores[cpu].Load);
+		}
+
+		for (auto* groups : { &load.Packages, &load.L3Domains, &load.PhysicalCores, &load.Nodes })
+		{
+			for (auto& group : *groups) {
+				group.Load = group.Online ? group.Load / group.Online : 0.0;
+			}
+		}
+	}
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "LogicalCoreData.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace RESANA {
+
+	// Where a logical processor sits; every index is dense, -1 when unknown (offline)
+	struct CoreTopology
+	{
+		int32_t Package = -1;
+		int32_t Die = -1;
+		int32_t L3 = -1;           // Cores sharing one last level cache
+		int32_t PhysicalCore = -1;
+		int32_t Thread = -1;       // SMT sibling within the physical core
+		int32_t L2 = -1;
+		int32_t Node = -1;         // NUMA node
+	};
+
+	struct TopologyGroup
+	{
+		double Load{};       // Average over the online logical processors
+		double MaxLoad{};
+		uint32_t Online{};
+		uint32_t Busy{};     // Logical processors above BUSY_LOAD
+	};
+
+	// Load per level of the topology, indexed like the ids in CoreTopology
+	struct TopologyLoad
+	{
+		std::vector<TopologyGroup> Packages{};
+		std::vector<TopologyGroup> L3Domains{};
+		std::vector<TopologyGroup> PhysicalCores{};
+		std::vector<TopologyGroup> Nodes{};
+	};
+
+	/*
+	 * Packages, last level caches, physical cores and SMT siblings of the
+	 * machine, read once: from /sys/devices/system/cpu on Linux and from
+	 * GetLogicalProcessorInformationEx on Windows. Logical processors are
+	 * numbered as the samplers number them.
+	 */
+	class CPUTopology
+	{
+	public:
+		void Detect();
+
+		[[nodiscard]] bool IsAvailable() const { return !mPackages.empty(); }
+
+		// Indexed by logical processor
+		[[nodiscard]] const std::vector<CoreTopology>& GetCores() const { return mCores; }
+
+		// Children of each level, in order
+		[[nodiscard]] const std::vector<std::vector<int32_t>>& GetPackages() const { return mPackages; }         // L3 domains
+		[[nodiscard]] const std::vector<std::vector<int32_t>>& GetL3Domains() const { return mL3Domains; }       // Physical cores
+		[[nodiscard]] const std::vector<std::vector<int32_t>>& GetPhysicalCores() const { return mPhysicalCores; } // Logical processors
+		[[nodiscard]] const std::vector<std::vector<int32_t>>& GetNodes() const { return mNodes; }               // Logical processors
+
+		// Reuses the vectors of load, so it allocates only the first time
+		void Aggregate(const std::vector<CoreLoad>& cores, TopologyLoad& load) const;
+
+	public:
+		static constexpr double BUSY_LOAD = 50.0;
+
+	private:
+		void BuildChildren();
+
+	private:
+		std::vector<CoreTopology> mCores{};
+		std::vector<std::vector<int32_t>> mPackages{};
+		std::vector<std::vector<int32_t>> mL3Domains{};
+		std::vector<std::vector<int32_t>> mPhysicalCores{};
+		std::vector<std::vector<int32_t>> mNodes{};
+	};
+
+}
@@ -10,66 +10,75 @@ namespace RESANA
 		Copy(other);
 	}
 
-	LogicalCoreData::~LogicalCoreData() {
-		std::scoped_lock lock(mMutex);
-		for (const auto processor : mProcessors) {
-			delete processor;
-		}
-	}
+	LogicalCoreData::~LogicalCoreData() = default;
 
 	std::mutex& LogicalCoreData::GetMutex()
 	{
 		return mMutex;
 	}
 
-	std::vector<PdhItem*>& LogicalCoreData::GetProcessors()
+	std::vector<CoreLoad>& LogicalCoreData::GetProcessors()
 	{
 		return mProcessors;
 	}
 
-	void LogicalCoreData::SetProcessorRef(PdhItem* ref)
+	void LogicalCoreData::Reserve(const size_t count)
 	{
-		mProcessorRef = ref;
+		if (mProcessors.size() < count) {
+			mProcessors.resize(count);
+		}
 	}
 
-	PdhItem* LogicalCoreData::GetProcessorRef()
+	void LogicalCoreData::SetTotalLoad(const double load)
 	{
-		return mProcessorRef;
+		mTotalLoad = load;
 	}
 
-	DWORD& LogicalCoreData::GetSize()
+	double LogicalCoreData::GetTotalLoad() const
 	{
-		return mSize;
+		return mTotalLoad;
 	}
 
-	DWORD& LogicalCoreData::GetBuffer()
+	void LogicalCoreData::SetTotalStates(const StateShares& states)
 	{
-		return mBuffer;
+		mTotalStates = states;
 	}
 
-	void LogicalCoreData::Clear()
+	const StateShares& LogicalCoreData::GetTotalStates() const
 	{
-		std::scoped_lock lock(mMutex);
-		mProcessors.clear();
+		return mTotalStates;
 	}
 
-	void LogicalCoreData::Copy(LogicalCoreData* other)
+	void LogicalCoreData::SetCoreSummary(const LoadSummary& summary)
 	{
-		if (this == other) { return; }
+		mCoreSummary = summary;
+	}
 
-		Clear();
+	const LoadSummary& LogicalCoreData::GetCoreSummary() const
+	{
+		return mCoreSummary;
+	}
 
+	void LogicalCoreData::Clear()
+	{
 		std::scoped_lock lock(mMutex);
+		std::fill(mProcessors.begin(), mProcessors.end(), CoreLoad{});
+		mTotalLoad = 0.0;
+		mTotalStates = {};
+		mCoreSummary = {};
+	}
 
-		for (const auto processor : other->mProcessors) {
-			auto copy = new PdhItem(*processor);
-			mProcessors.emplace_back(copy);
-		}
+	void LogicalCoreData::Copy(LogicalCoreData* other)
+	{
+		if (this == other) { return; }
 
-		mProcessorRef = new PdhItem(*other->GetProcessorRef());
-		mSize = other->GetSize();
-		mBuffer = other->GetBuffer();
+		std::scoped_lock lock(mMutex, other->mMutex);
 
+		// Same size after the first copy, so the assignment reuses the storage
+		mProcessors = other->mProcessors;
+		mTotalLoad = other->mTotalLoad;
+		mTotalStates = other->mTotalStates;
+		mCoreSummary = other->mCoreSummary;
 	}
 
 	LogicalCoreData& LogicalCoreData::operator=(LogicalCoreData* rhs)
@@ -77,4 +86,4 @@ namespace RESANA
 		Copy(rhs);
 		return *this;
 	}
-}
\ No newline at end of file
+}
@@ -1,28 +1,36 @@
 #pragma once
 
+#include "CPUKernels.h"
+
+#include <array>
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include <mutex>
 
-#include <tchar.h>
-#include <Pdh.h>
-
 namespace RESANA
 {
 
-	typedef PDH_FMT_COUNTERVALUE_ITEM PdhItem;
+	// Percent of the time spent in each CpuState; zero for states the backend can't tell apart
+	typedef std::array<float, CpuState_Count> StateShares;
 
-	struct PDHCounter
+	// Load of one logical processor over the last sample, whatever the backend
+	struct CoreLoad
 	{
-		HANDLE Handle{};
-		HQUERY Query{};
-		PDH_HCOUNTER Counter{};
-		ULARGE_INTEGER Last{};
-		ULARGE_INTEGER LastSys{};
-		ULARGE_INTEGER LastUser{};
+		double Load{};          // Percent
+		StateShares States{};
+		uint32_t Frequency{};    // MHz, 0 when unknown
+		uint32_t MaxFrequency{};
+		int64_t Throttles = -1; // Thermal throttle events since the last sample, -1 when not counted
+		bool Online = false;    // Offline cores keep their slot but have no load
 	};
 
 
+	/*
+	 * One sample of every logical processor, indexed by core number. The array
+	 * is sized once for the machine and overwritten in place by each sample,
+	 * so copying a sample between buffers of the same size allocates nothing.
+	 */
 	class LogicalCoreData
 	{
 	public:
@@ -32,15 +40,19 @@ namespace RESANA
 
 		std::mutex& GetMutex();
 
-		std::vector<PdhItem*>& GetProcessors();
+		std::vector<CoreLoad>& GetProcessors();
 
-		void SetProcessorRef(PdhItem* ref);
-		PdhItem* GetProcessorRef();
+		// Grows the array to hold core numbers up to count - 1; never shrinks
+		void Reserve(size_t count);
 
-		[[nodiscard]] DWORD& GetSize();
+		void SetTotalLoad(double load);
+		[[nodiscard]] double GetTotalLoad() const;
 
-		DWORD& GetBuffer();
+		void SetTotalStates(const StateShares& states);
+		[[nodiscard]] const StateShares& GetTotalStates() const;
 
+		void SetCoreSummary(const LoadSummary& summary);
+		[[nodiscard]] const LoadSummary& GetCoreSummary() const;
 
 		void Clear();
 		void Copy(LogicalCoreData* other);
@@ -49,10 +61,10 @@ namespace RESANA
 
 	private:
 		std::mutex mMutex{};
-		std::vector<PdhItem*> mProcessors{};
-		PdhItem* mProcessorRef = nullptr;
-		DWORD mSize = 0;
-		DWORD mBuffer = 0;
+		std::vector<CoreLoad> mProcessors{};
+		double mTotalLoad = 0.0;
+		StateShares mTotalStates{};
+		LoadSummary mCoreSummary{};
 	};
 
 }
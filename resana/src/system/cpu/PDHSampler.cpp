@@ -0,0 +1,209 @@
+#include "rspch.h"
+
+#include "core/Core.h"
+
+#if defined(RS_PLATFORM_WINDOWS)
+
+#include "PDHSampler.h"
+
+#include <PdhMsg.h>
+#include <Windows.h>
+
+namespace RESANA {
+
+	namespace {
+
+		constexpr const TCHAR* COUNTER_PATHS[] = {
+			TEXT("\\Processor(*)\\% Processor Time"),
+			TEXT("\\Processor(*)\\% User Time"),
+			TEXT("\\Processor(*)\\% Privileged Time"),
+			TEXT("\\Processor(*)\\% Interrupt Time"),
+			TEXT("\\Processor(*)\\% DPC Time")
+		};
+
+		// State each counter fills in; DPCs are the closest thing to softirqs
+		constexpr CpuState COUNTER_STATES[] = {
+			CpuState_Count, CpuState_User, CpuState_System, CpuState_Irq, CpuState_SoftIrq
+		};
+
+	}
+
+	PDHSampler::PDHSampler()
+	{
+		SYSTEM_INFO sysInfo;
+		GetSystemInfo(&sysInfo);
+		mNumProcessors = (int)sysInfo.dwNumberOfProcessors;
+
+		PDH_STATUS pdhStatus = PdhOpenQuery(nullptr, 0, &mQuery);
+		if (pdhStatus != ERROR_SUCCESS) {
+			RS_CORE_ERROR("PdhOpenQuery failed with 0x{0}", pdhStatus);
+		}
+
+		// Specify a counter object with a wildcard for the instance.
+		for (int counter = 0; counter < Counter_Count; counter++)
+		{
+			pdhStatus = PdhAddCounter(mQuery, COUNTER_PATHS[counter], 0, &mCounters[counter]);
+			if (pdhStatus != ERROR_SUCCESS) {
+				RS_CORE_ERROR("PdhAddCounter failed with 0x{0}", pdhStatus);
+			}
+		}
+	}
+
+	PDHSampler::~PDHSampler()
+	{
+		if (mQuery) {
+			PdhCloseQuery(mQuery);
+		}
+	}
+
+	bool PDHSampler::Sample(LogicalCoreData& data)
+	{
+		PDH_STATUS pdhStatus = PdhCollectQueryData(mQuery);
+		if (pdhStatus != ERROR_SUCCESS) {
+			RS_CORE_ERROR("PdhCollectQueryData failed with 0x{0}", pdhStatus);
+			return false;
+		}
+
+		// Rates need two samples; the first only primes the counters
+		if (!mHasSample) {
+			mHasSample = true;
+			return false;
+		}
+
+		DWORD count = 0;
+		const PdhItem* items = GetItems(Counter_Processor, count);
+		if (!items) {
+			return false;
+		}
+
+		std::scoped_lock lock(data.GetMutex());
+		data.Reserve((size_t)mNumProcessors);
+		for (auto& core : data.GetProcessors()) {
+			core.Online = false;
+			core.States = {};
+		}
+
+		for (DWORD i = 0; i < count; ++i)
+		{
+			const auto& item = items[i];
+			if (std::strcmp(item.szName, "_Total") == 0)
+			{
+				data.SetTotalLoad(item.FmtValue.doubleValue);
+				continue;
+			}
+
+			const size_t core = GetCoreNumber(item.szName);
+			data.Reserve(core + 1);
+
+			auto& load = data.GetProcessors()[core];
+			load.Load = item.FmtValue.doubleValue;
+			load.Online = true;
+		}
+
+		// A missing state counter only leaves its state at zero
+		StateShares totalStates{};
+		for (int counter = Counter_User; counter < Counter_Count; counter++)
+		{
+			DWORD stateCount = 0;
+			const PdhItem* stateItems = GetItems((Counter)counter, stateCount);
+			if (!stateItems) {
+				continue;
+			}
+
+			const CpuState state = COUNTER_STATES[counter];
+			for (DWORD i = 0; i < stateCount; ++i)
+			{
+				const auto& item = stateItems[i];
+				if (std::strcmp(item.szName, "_Total") == 0) {
+					totalStates[state] = (float)item.FmtValue.doubleValue;
+					continue;
+				}
+
+				const size_t core = GetCoreNumber(item.szName);
+				if (core < data.GetProcessors().size()) {
+					data.GetProcessors()[core].States[state] = (float)item.FmtValue.doubleValue;
+				}
+			}
+		}
+
+		FinishStates(totalStates, data.GetTotalLoad());
+		data.SetTotalStates(totalStates);
+		for (auto& core : data.GetProcessors()) {
+			if (core.Online) {
+				FinishStates(core.States, core.Load);
+			}
+		}
+
+		const auto& processors = data.GetProcessors();
+		mLoads.resize(processors.size());
+		for (size_t i = 0; i < processors.size(); i++) {
+			mLoads[i] = processors[i].Online ? processors[i].Load : CPUKernels::NO_LOAD;
+		}
+		data.SetCoreSummary(CPUKernels::Summarize(mLoads.data(), mLoads.size()));
+		return true;
+	}
+
+	PdhItem* PDHSampler::GetItems(const Counter counter, DWORD& count)
+	{
+		if (!mCounters[counter]) {
+			return nullptr; // Failed to add, already reported
+		}
+
+		// Get the required size of the data buffer.
+		DWORD size = 0;
+		PDH_STATUS pdhStatus = PdhGetFormattedCounterArray(mCounters[counter], PDH_FMT_DOUBLE, &size, &count, nullptr);
+		if (pdhStatus != PDH_MORE_DATA) {
+			RS_CORE_ERROR("PdhGetFormattedCounterArray failed with 0x{0}", pdhStatus);
+			return nullptr;
+		}
+
+		// Only grows, and only when processors come online
+		auto& buffer = mBuffers[counter];
+		if (buffer.size() < size) {
+			buffer.resize(size);
+		}
+		auto* items = (PdhItem*)buffer.data();
+		pdhStatus = PdhGetFormattedCounterArray(mCounters[counter], PDH_FMT_DOUBLE, &size, &count, items);
+		if (pdhStatus != ERROR_SUCCESS) {
+			RS_CORE_ERROR("PdhGetFormattedCounterArray failed with 0x{0}", pdhStatus);
+			return nullptr;
+		}
+		return items;
+	}
+
+	void PDHSampler::FinishStates(StateShares& states, const double load)
+	{
+		// Privileged time includes the interrupts and DPCs, which are states of their own
+		const float kernel = states[CpuState_System] - states[CpuState_Irq] - states[CpuState_SoftIrq];
+		states[CpuState_System] = std::max(kernel, 0.0f);
+		states[CpuState_Idle] = (float)std::max(100.0 - load, 0.0);
+	}
+
+	size_t PDHSampler::GetCoreNumber(const char* name)
+	{
+		// Instances are "N", or "G,N" on machines with more than one processor group
+		char* end = nullptr;
+		const unsigned long first = std::strtoul(name, &end, 10);
+		if (*end != ',') {
+			return first;
+		}
+		return first * 64 + std::strtoul(end + 1, nullptr, 10);
+	}
+
+	bool PDHSampler::SampleProcessTimes(uint64_t& wallTime, uint64_t& cpuTime)
+	{
+		FILETIME ftime, fsys, fuser;
+		GetSystemTimeAsFileTime(&ftime);
+		wallTime = ((uint64_t)ftime.dwHighDateTime << 32) | ftime.dwLowDateTime;
+
+		if (!GetProcessTimes(GetCurrentProcess(), &ftime, &ftime, &fsys, &fuser)) {
+			return false;
+		}
+		cpuTime = (((uint64_t)fsys.dwHighDateTime << 32) | fsys.dwLowDateTime) +
+			(((uint64_t)fuser.dwHighDateTime << 32) | fuser.dwLowDateTime);
+		return true;
+	}
+
+}
+
+#endif
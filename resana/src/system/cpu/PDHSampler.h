@@ -0,0 +1,55 @@
+#pragma once
+
+#include "CPUSampler.h"
+
+#include <vector>
+
+#include <tchar.h>
+#include <Pdh.h>
+
+namespace RESANA {
+
+	typedef PDH_FMT_COUNTERVALUE_ITEM PdhItem;
+
+	/*
+	 * Windows backend, on the "\Processor(*)" counters. The load comes from
+	 * "% Processor Time", the state shares from the user, privileged, interrupt
+	 * and DPC times; Windows has no counterpart for iowait, steal or guest time.
+	 */
+	class PDHSampler final : public CPUSampler
+	{
+	public:
+		PDHSampler();
+		~PDHSampler() override;
+
+		[[nodiscard]] int GetNumProcessors() const override { return mNumProcessors; }
+
+		bool Sample(LogicalCoreData& data) override;
+		bool SampleProcessTimes(uint64_t& wallTime, uint64_t& cpuTime) override;
+
+	private:
+		enum Counter
+		{
+			Counter_Processor = 0,
+			Counter_User,
+			Counter_Privileged,
+			Counter_Interrupt,
+			Counter_Dpc,
+			Counter_Count
+		};
+
+		PdhItem* GetItems(Counter counter, DWORD& count);
+		static void FinishStates(StateShares& states, double load);
+		static size_t GetCoreNumber(const char* name);
+
+	private:
+		HQUERY mQuery{};
+		PDH_HCOUNTER mCounters[Counter_Count]{};
+		bool mHasSample = false;
+		int mNumProcessors{};
+
+		std::vector<char> mBuffers[Counter_Count]{}; // Formatted counter arrays, reused between samples
+		std::vector<double> mLoads{};
+	};
+
+}
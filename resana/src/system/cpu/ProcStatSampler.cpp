@@ -0,0 +1,222 @@
+#include "rspch.h"
+
+#include "core/Core.h"
+
+#if defined(RS_PLATFORM_LINUX)
+
+#include "ProcStatSampler.h"
+
+#include "helpers/ProcFS.h"
+#include "system/scheduler/SchedulerCollector.h"
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace RESANA {
+
+	ProcStatSampler::ProcStatSampler()
+	{
+		const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+		mNumProcessors = processors > 0 ? (int)processors : 1;
+
+		const long configured = sysconf(_SC_NPROCESSORS_CONF);
+		Resize((size_t)std::max<long>(configured, mNumProcessors));
+
+		// Roughly 150 bytes per "cpuN" line, plus the interrupt and softirq lines that follow
+		mBuffer.resize(mNumCores * 256 + 64 * 1024);
+
+		mFile = open("/proc/stat", O_RDONLY | O_CLOEXEC);
+		if (mFile < 0) {
+			RS_CORE_ERROR("Failed to open /proc/stat");
+		}
+	}
+
+	ProcStatSampler::~ProcStatSampler()
+	{
+		if (mFile >= 0) {
+			close(mFile);
+		}
+	}
+
+	bool ProcStatSampler::Sample(LogicalCoreData& data)
+	{
+		if (mFile < 0) {
+			return false;
+		}
+
+		// A full buffer may have cut the file short, before the scheduler lines on machines with many interrupts
+		long length = ProcFS::ReadFile(mFile, mBuffer.data(), mBuffer.size());
+		while (length == (long)mBuffer.size() - 1)
+		{
+			mBuffer.resize(mBuffer.size() * 2);
+			length = ProcFS::ReadFile(mFile, mBuffer.data(), mBuffer.size());
+		}
+		if (length <= 0) {
+			return false;
+		}
+		const auto readTime = std::chrono::steady_clock::now();
+
+		const bool hasSample = mHasSample;
+		mHasSample = true;
+
+		double totalLoad = 0.0;
+
+		// Cores missing from this sample (offline) keep their counters, so they come out with no load
+		auto& last = mCores[mCurrent];
+		auto& current = mCores[mCurrent ^ 1];
+		for (int field = 0; field < CpuField_Count; field++) {
+			std::copy(last[field].begin(), last[field].end(), current[field].begin());
+		}
+
+		// "cpu  user nice system idle iowait irq softirq steal guest guest_nice", then one "cpuN" line per online core
+		const char* line = mBuffer.data();
+		for (; line[0] == 'c' && line[1] == 'p' && line[2] == 'u'; line = ProcFS::NextLine(line))
+		{
+			const char* p = line + 3;
+			if (*p == ' ')
+			{
+				// Kernels before 2.6.33 stop short of guest_nice; the missing fields parse as zero
+				uint64_t* fields = mTotalFields[mCurrent ^ 1];
+				for (int field = 0; field < CpuField_Count; field++) {
+					p = ProcFS::ParseUInt64(p, fields[field]);
+				}
+
+				// Guest time is already included in user and nice
+				const uint64_t idle = fields[CpuField_Idle] + fields[CpuField_IOWait];
+				const uint64_t busy = fields[CpuField_User] + fields[CpuField_Nice] + fields[CpuField_System] +
+					fields[CpuField_Irq] + fields[CpuField_SoftIrq] + fields[CpuField_Steal];
+				const Counters total{ busy, busy + idle };
+
+				totalLoad = GetLoad(mTotal, total);
+				mTotal = total;
+				continue;
+			}
+
+			uint64_t core = 0;
+			p = ProcFS::ParseUInt64(p, core);
+			const bool added = core >= mNumCores;
+			if (added) {
+				Resize(core + 1); // Hotplugged beyond what was configured
+			}
+
+			for (int field = 0; field < CpuField_Count; field++)
+			{
+				p = ProcFS::ParseUInt64(p, current[field][core]);
+				if (added) {
+					last[field][core] = current[field][core]; // No load until its next sample
+				}
+			}
+		}
+		mCurrent ^= 1;
+
+		// The scheduler counters follow the "cpu" lines, so the scheduler collector needn't read the file again
+		SchedulerCollector::ShareStat(line, readTime);
+
+		if (!hasSample) {
+			return false;
+		}
+
+		const CoreCounters lastCores = GetCounters(mCores[mCurrent ^ 1]);
+		const CoreCounters currentCores = GetCounters(mCores[mCurrent]);
+		CPUKernels::ComputeLoads(lastCores, currentCores, mNumCores, mLoads.data());
+		CPUKernels::ComputeStates(lastCores, currentCores, mNumCores, GetStates(mStates));
+
+		CoreCounters lastTotal, currentTotal;
+		double totalStates[CpuState_Count];
+		CoreStates totalOutput;
+		for (int field = 0; field < CpuField_Count; field++)
+		{
+			lastTotal.Fields[field] = &mTotalFields[mCurrent ^ 1][field];
+			currentTotal.Fields[field] = &mTotalFields[mCurrent][field];
+		}
+		for (int state = 0; state < CpuState_Count; state++) {
+			totalOutput.States[state] = &totalStates[state];
+		}
+		CPUKernels::ComputeStates(lastTotal, currentTotal, 1, totalOutput);
+
+		std::scoped_lock lock(data.GetMutex());
+		data.SetTotalLoad(totalLoad);
+		StateShares shares;
+		std::copy(std::begin(totalStates), std::end(totalStates), shares.begin());
+		data.SetTotalStates(shares);
+
+		data.Reserve(mNumCores);
+		auto& processors = data.GetProcessors();
+		for (size_t i = 0; i < mNumCores; i++)
+		{
+			processors[i].Online = mLoads[i] >= 0.0;
+			processors[i].Load = processors[i].Online ? mLoads[i] : 0.0;
+			for (int state = 0; state < CpuState_Count; state++) {
+				processors[i].States[state] = (float)mStates[state][i];
+			}
+		}
+		data.SetCoreSummary(CPUKernels::Summarize(mLoads.data(), mNumCores));
+		return true;
+	}
+
+	bool ProcStatSampler::SampleProcessTimes(uint64_t& wallTime, uint64_t& cpuTime)
+	{
+		timespec now{};
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		wallTime = (uint64_t)now.tv_sec * 10000000 + (uint64_t)now.tv_nsec / 100;
+
+		rusage usage{};
+		if (getrusage(RUSAGE_SELF, &usage) != 0) {
+			return false;
+		}
+
+		const auto toTicks = [](const timeval& time) {
+			return (uint64_t)time.tv_sec * 10000000 + (uint64_t)time.tv_usec * 10;
+		};
+		cpuTime = toTicks(usage.ru_utime) + toTicks(usage.ru_stime);
+		return true;
+	}
+
+	void ProcStatSampler::Resize(const size_t count)
+	{
+		for (auto& arrays : mCores) {
+			for (auto& field : arrays) {
+				field.resize(count);
+			}
+		}
+		mLoads.resize(count);
+		for (auto& state : mStates) {
+			state.resize(count);
+		}
+		mNumCores = count;
+	}
+
+	CoreCounters ProcStatSampler::GetCounters(const FieldArrays& arrays)
+	{
+		CoreCounters counters;
+		for (int field = 0; field < CpuField_Count; field++) {
+			counters.Fields[field] = arrays[field].data();
+		}
+		return counters;
+	}
+
+	CoreStates ProcStatSampler::GetStates(std::array<std::vector<double>, CpuState_Count>& arrays)
+	{
+		CoreStates states;
+		for (int state = 0; state < CpuState_Count; state++) {
+			states.States[state] = arrays[state].data();
+		}
+		return states;
+	}
+
+	double ProcStatSampler::GetLoad(const Counters& last, const Counters& current)
+	{
+		// Counters can step back when a core goes offline and comes back
+		if (current.Total <= last.Total || current.Busy < last.Busy) {
+			return 0.0;
+		}
+
+		const double load = (double)(current.Busy - last.Busy) / (double)(current.Total - last.Total) * 100.0;
+		return load < 100.0 ? load : 100.0;
+	}
+
+}
+
+#endif
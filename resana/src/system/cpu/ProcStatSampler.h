@@ -0,0 +1,57 @@
+#pragma once
+
+#include "CPUSampler.h"
+
+#include <array>
+#include <vector>
+
+namespace RESANA {
+
+	/*
+	 * Linux backend. /proc/stat is read once per sample through a descriptor
+	 * kept open, and the load of each core is the share of non-idle jiffies
+	 * between this sample and the previous one. Per-core counters are kept as
+	 * one array per field so CPUKernels can turn them into loads and state
+	 * shares in bulk; the total line goes through the same kernels as one core.
+	 */
+	class ProcStatSampler final : public CPUSampler
+	{
+	public:
+		ProcStatSampler();
+		~ProcStatSampler() override;
+
+		[[nodiscard]] int GetNumProcessors() const override { return mNumProcessors; }
+
+		bool Sample(LogicalCoreData& data) override;
+		bool SampleProcessTimes(uint64_t& wallTime, uint64_t& cpuTime) override;
+
+	private:
+		struct Counters
+		{
+			uint64_t Busy{};
+			uint64_t Total{};
+		};
+
+		typedef std::array<std::vector<uint64_t>, CpuField_Count> FieldArrays;
+
+		void Resize(size_t count);
+		static CoreCounters GetCounters(const FieldArrays& arrays);
+		static CoreStates GetStates(std::array<std::vector<double>, CpuState_Count>& arrays);
+		static double GetLoad(const Counters& last, const Counters& current);
+
+	private:
+		int mFile = -1;
+		int mNumProcessors{};
+		bool mHasSample = false;
+
+		Counters mTotal{};
+		uint64_t mTotalFields[2][CpuField_Count]{}; // Of the total line, alternating like mCores
+		FieldArrays mCores[2]{}; // Previous and current sample, indexed by core number
+		int mCurrent = 0;
+		size_t mNumCores{};      // Slots in each array, offline cores included
+		std::vector<double> mLoads{};
+		std::array<std::vector<double>, CpuState_Count> mStates{};
+		std::vector<char> mBuffer{};
+	};
+
+}
@@ -1,22 +1,28 @@
 #include "rspch.h"
 #include "MemoryPerformance.h"
 
-#include "core/Application.h"
 #include "core/Core.h"
+#include "system/SelfProfiler.h"
+
+#if defined(RS_PLATFORM_WINDOWS)
+#include <Psapi.h>
+#elif defined(RS_PLATFORM_LINUX)
+#include "helpers/ProcFS.h"
+
+#include <unistd.h>
+#endif
 
 namespace RESANA {
 
 	MemoryPerformance* MemoryPerformance::sInstance = nullptr;
 
 	MemoryPerformance::MemoryPerformance()
-		: mPMC(), mUpdateInterval(TimeTick::Rate::Normal)
+		: mUpdateInterval(TimeTick::Rate::Normal)
 	{
 	}
 
 	MemoryPerformance::~MemoryPerformance()
 	{
-		// Wait for loops to stop
-		Time::Sleep(mUpdateInterval);
 	}
 
 	MemoryPerformance* MemoryPerformance::Get()
@@ -36,11 +42,9 @@ namespace RESANA {
 		{
 			sInstance->mRunning = true;
 
-			const auto& app = Application::Get();
-			auto& threadPool = app.GetThreadPool();
-
-			threadPool.Queue([&] { sInstance->UpdateMemoryInfo(); });
-			threadPool.Queue([&] { sInstance->UpdatePMC(); });
+			// The loop lives as long as the collector, so it doesn't take a pool worker
+			auto* memory = sInstance;
+			memory->mThread.Start([memory] { memory->UpdateMemoryInfo(); });
 		}
 	}
 
@@ -48,6 +52,7 @@ namespace RESANA {
 	{
 		if (sInstance && sInstance->IsRunning()) {
 			sInstance->mRunning = false;
+			sInstance->mThread.Stop();
 		}
 	}
 
@@ -56,49 +61,47 @@ namespace RESANA {
 		if (sInstance)
 		{
 			Stop();
-			auto& app = Application::Get();
-			auto& threadPool = app.GetThreadPool();
-			threadPool.Queue([&] { sInstance->Destroy(); });
+			delete sInstance;
 			sInstance = nullptr;
 		}
 	}
 
-	DWORDLONG MemoryPerformance::GetTotalPhys() const
+	uint64_t MemoryPerformance::GetTotalPhys() const
 	{
-		return mMemoryInfo.ullTotalPhys;
+		return mMemoryInfo.TotalPhys;
 	}
 
-	DWORDLONG MemoryPerformance::GetAvailPhys() const
+	uint64_t MemoryPerformance::GetAvailPhys() const
 	{
-		return mMemoryInfo.ullAvailPhys;
+		return mMemoryInfo.AvailPhys;
 	}
 
-	DWORDLONG MemoryPerformance::GetUsedPhys() const
+	uint64_t MemoryPerformance::GetUsedPhys() const
 	{
-		return mMemoryInfo.ullTotalPhys - mMemoryInfo.ullAvailPhys;
+		return mMemoryInfo.TotalPhys - mMemoryInfo.AvailPhys;
 	}
 
-	SIZE_T MemoryPerformance::GetCurrProcUsagePhys() const
+	uint64_t MemoryPerformance::GetCurrProcUsagePhys() const
 	{
-		return mPMC.WorkingSetSize;
+		return mPMC.WorkingSet;
 	}
 
-	DWORDLONG MemoryPerformance::GetTotalVirtual() const
+	uint64_t MemoryPerformance::GetTotalVirtual() const
 	{
-		return mMemoryInfo.ullTotalPageFile;
+		return mMemoryInfo.TotalCommit;
 	}
 
-	DWORDLONG MemoryPerformance::GetAvailVirtual() const
+	uint64_t MemoryPerformance::GetAvailVirtual() const
 	{
-		return mMemoryInfo.ullAvailVirtual;
+		return mMemoryInfo.AvailVirtual;
 	}
 
-	DWORDLONG MemoryPerformance::GetUsedVirtual() const
+	uint64_t MemoryPerformance::GetUsedVirtual() const
 	{
-		return mMemoryInfo.ullTotalPageFile - mMemoryInfo.ullAvailPageFile;
+		return mMemoryInfo.TotalCommit - mMemoryInfo.AvailCommit;
 	}
 
-	SIZE_T MemoryPerformance::GetCurrProcUsageVirtual() const
+	uint64_t MemoryPerformance::GetCurrProcUsageVirtual() const
 	{
 		return mPMC.PrivateUsage;
 	}
@@ -110,36 +113,109 @@ namespace RESANA {
 
 	void MemoryPerformance::UpdateMemoryInfo()
 	{
-		MEMORYSTATUSEX memInfo{};
-		mMemoryInfo = memInfo;
-		mMemoryInfo.dwLength = sizeof(MEMORYSTATUSEX);
-
 		do
 		{
-			GlobalMemoryStatusEx(&mMemoryInfo);
-		} while (IsRunning() && Time::Sleep(mUpdateInterval));
-		ZeroMemory(&mMemoryInfo, sizeof(MEMORYSTATUSEX));
+			SelfProfiler::Scope scope(Subsystem_Memory);
+			MemoryStatus status;
+			if (ReadMemoryStatus(status)) {
+				mMemoryInfo = status;
+			}
+
+			const float used[MemoryHistory_Count] = {
+				(float)(GetUsedPhys() / BYTES_PER_MB), (float)(GetUsedVirtual() / BYTES_PER_MB)
+			};
+			mHistory.Append(MetricHistory::Clock::now(), used);
+
+			ProcessMemory memory;
+			ReadProcessMemory(memory);
+			mPMC = memory;
+		} while (IsRunning() && mThread.Sleep(mUpdateInterval));
+		mMemoryInfo = {};
+		mPMC = {};
+	}
+
+#if defined(RS_PLATFORM_WINDOWS)
+	bool MemoryPerformance::ReadMemoryStatus(MemoryStatus& status)
+	{
+		MEMORYSTATUSEX memInfo{};
+		memInfo.dwLength = sizeof(MEMORYSTATUSEX);
+		if (!GlobalMemoryStatusEx(&memInfo)) {
+			return false;
+		}
+
+		status.TotalPhys = memInfo.ullTotalPhys;
+		status.AvailPhys = memInfo.ullAvailPhys;
+		status.TotalCommit = memInfo.ullTotalPageFile;
+		status.AvailCommit = memInfo.ullAvailPageFile;
+		status.AvailVirtual = memInfo.ullAvailVirtual;
+		return true;
 	}
 
-	void MemoryPerformance::UpdatePMC()
+	bool MemoryPerformance::ReadProcessMemory(ProcessMemory& memory)
 	{
 		PROCESS_MEMORY_COUNTERS_EX pmc{};
-		mPMC = pmc;
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&pmc, sizeof(pmc))) {
+			return false;
+		}
 
-		const auto hProcess = GetCurrentProcess();
-		do
+		memory.WorkingSet = pmc.WorkingSetSize;
+		memory.PrivateUsage = pmc.PrivateUsage;
+		return true;
+	}
+#elif defined(RS_PLATFORM_LINUX)
+	bool MemoryPerformance::ReadMemoryStatus(MemoryStatus& status)
+	{
+		char buffer[4096];
+		if (ProcFS::ReadFile("/proc/meminfo", buffer, sizeof(buffer)) <= 0) {
+			return false;
+		}
+
+		// Values are in kB; the commit limit only binds under strict overcommit, but is the closest match
+		uint64_t committed = 0;
+		const struct { const char* Key; uint64_t* Value; } fields[] = {
+			{ "MemTotal:", &status.TotalPhys },
+			{ "MemAvailable:", &status.AvailPhys },
+			{ "CommitLimit:", &status.TotalCommit },
+			{ "Committed_AS:", &committed },
+		};
+
+		for (const char* line = buffer; *line; line = ProcFS::NextLine(line))
 		{
-			ZeroMemory(&mPMC, sizeof(PROCESS_MEMORY_COUNTERS_EX));
-			GetProcessMemoryInfo(hProcess, (PROCESS_MEMORY_COUNTERS*)&mPMC, sizeof(mPMC));
-		} while (IsRunning() && Time::Sleep(mUpdateInterval));
+			for (const auto& field : fields)
+			{
+				const size_t length = strlen(field.Key);
+				if (strncmp(line, field.Key, length) == 0)
+				{
+					ProcFS::ParseUInt64(line + length, *field.Value);
+					*field.Value *= 1024;
+					break;
+				}
+			}
+		}
 
-		CloseHandle(hProcess);
-		ZeroMemory(&mPMC, sizeof(PROCESS_MEMORY_COUNTERS_EX));
+		status.AvailCommit = (committed < status.TotalCommit) ? status.TotalCommit - committed : 0;
+		status.AvailVirtual = status.AvailCommit;
+		return status.TotalPhys != 0;
 	}
 
-	void MemoryPerformance::Destroy() const
+	bool MemoryPerformance::ReadProcessMemory(ProcessMemory& memory)
 	{
-		sInstance = nullptr;
-		delete this;
+		// Pages: size resident shared text lib data dirty
+		char buffer[256];
+		if (ProcFS::ReadFile("/proc/self/statm", buffer, sizeof(buffer)) <= 0) {
+			return false;
+		}
+
+		uint64_t size = 0, resident = 0, shared = 0;
+		const char* p = ProcFS::ParseUInt64(buffer, size);
+		p = ProcFS::ParseUInt64(p, resident);
+		ProcFS::ParseUInt64(p, shared);
+
+		// Resident pages not backed by a file stand in for private bytes
+		const uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+		memory.WorkingSet = resident * pageSize;
+		memory.PrivateUsage = (resident > shared ? resident - shared : 0) * pageSize;
+		return true;
 	}
+#endif
 }
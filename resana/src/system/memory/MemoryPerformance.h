@@ -1,15 +1,40 @@
 #pragma once
 
+#include "helpers/MetricHistory.h"
 #include "helpers/Time.h"
+#include "system/ServiceThread.h"
 
-#include <Windows.h>
-#include <Psapi.h>
+#include <cstdint>
 
 namespace RESANA
 {
 
 	constexpr auto BYTES_PER_MB = 1048576;;
 
+	// Series of the memory history, in MB in use
+	enum MemoryHistory
+	{
+		MemoryHistory_Physical = 0,
+		MemoryHistory_Commit,
+		MemoryHistory_Count
+	};
+
+	// Sizes in bytes
+	struct MemoryStatus
+	{
+		uint64_t TotalPhys{};
+		uint64_t AvailPhys{};
+		uint64_t TotalCommit{};  // Commit limit: physical memory plus page file or swap
+		uint64_t AvailCommit{};
+		uint64_t AvailVirtual{}; // Free address space of the process; the commit headroom on Linux
+	};
+
+	struct ProcessMemory
+	{
+		uint64_t WorkingSet{};
+		uint64_t PrivateUsage{};
+	};
+
 	class MemoryPerformance
 	{
 	public:
@@ -20,16 +45,18 @@ namespace RESANA
 		static void Shutdown();
 
 		/* Physical Memory */
-		[[nodiscard]] DWORDLONG GetTotalPhys() const;
-		[[nodiscard]] DWORDLONG GetAvailPhys() const;
-		[[nodiscard]] DWORDLONG GetUsedPhys() const;
-		[[nodiscard]] SIZE_T GetCurrProcUsagePhys() const;
+		[[nodiscard]] uint64_t GetTotalPhys() const;
+		[[nodiscard]] uint64_t GetAvailPhys() const;
+		[[nodiscard]] uint64_t GetUsedPhys() const;
+		[[nodiscard]] uint64_t GetCurrProcUsagePhys() const;
 
 		/* Virtual Memory */
-		[[nodiscard]] DWORDLONG GetTotalVirtual() const;
-		[[nodiscard]] DWORDLONG GetAvailVirtual() const;
-		[[nodiscard]] DWORDLONG GetUsedVirtual() const;
-		[[nodiscard]] SIZE_T GetCurrProcUsageVirtual() const;
+		[[nodiscard]] uint64_t GetTotalVirtual() const;
+		[[nodiscard]] uint64_t GetAvailVirtual() const;
+		[[nodiscard]] uint64_t GetUsedVirtual() const;
+		[[nodiscard]] uint64_t GetCurrProcUsageVirtual() const;
+
+		[[nodiscard]] const MetricHistory& GetHistory() const { return mHistory; }
 
 		[[nodiscard]] bool IsRunning() const { return mRunning; }
 
@@ -39,15 +66,20 @@ namespace RESANA
 		MemoryPerformance();
 		~MemoryPerformance();
 		void UpdateMemoryInfo();
-		void UpdatePMC();
-		void Destroy() const;
+
+		static bool ReadMemoryStatus(MemoryStatus& status);
+		static bool ReadProcessMemory(ProcessMemory& memory);
 
 	private:
-		MEMORYSTATUSEX mMemoryInfo{};
-		PROCESS_MEMORY_COUNTERS_EX mPMC{};
+		MemoryStatus mMemoryInfo{};
+		ProcessMemory mPMC{};
+		MetricHistory mHistory{ MemoryHistory_Count };
 		uint32_t mUpdateInterval{};
 		bool mRunning = false;
 
+		// Declared last, so it is joined before anything it uses is destroyed
+		ServiceThread mThread{ "Memory" };
+
 		static MemoryPerformance* sInstance;
 	};
 
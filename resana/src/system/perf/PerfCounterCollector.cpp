@@ -0,0 +1,455 @@
+#include "rspch.h"
+#include "PerfCounterCollector.h"
+
+#include "core/Core.h"
+#include "helpers/ProcFS.h"
+
+#if defined(RS_PLATFORM_LINUX)
+#include <cerrno>
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace RESANA {
+
+	namespace
+	{
+		constexpr const char* COUNTER_NAMES[PerfCounter_Count] = {
+			"Cycles", "Instructions", "Context switches", "Migrations", "Page faults"
+		};
+	}
+
+	void PerfCounterCollector::WatchCores(const bool watch)
+	{
+		Get()->mWatchCores = watch;
+	}
+
+	void PerfCounterCollector::WatchProcess(const unsigned long procId)
+	{
+		Get()->mWatchedId = procId;
+	}
+
+	bool PerfCounterCollector::GetCores(std::vector<PerfRates>& cores) const
+	{
+		std::scoped_lock lock(mMutex);
+		cores.assign(mCores.begin(), mCores.end());
+		return std::any_of(cores.begin(), cores.end(), [](const PerfRates& core) { return core.Available; });
+	}
+
+	ProcessPerfRates PerfCounterCollector::GetProcess() const
+	{
+		std::scoped_lock lock(mMutex);
+		return mProcess;
+	}
+
+	const char* PerfCounterCollector::GetName(const PerfCounter counter)
+	{
+		return COUNTER_NAMES[counter];
+	}
+
+	bool PerfCounterCollector::IsWanted() const
+	{
+		return mAvailable && ((mWatchCores && mCoresAvailable) || mWatchedId != (unsigned long)-1);
+	}
+
+	void PerfCounterCollector::OnStopped()
+	{
+		// Counters are only held while something shows them
+		Close(mCoreGroups);
+		Close(mThreadGroups);
+		mCoreScratch.clear();
+		mOpenId = (unsigned long)-1;
+
+		std::scoped_lock lock(mMutex);
+		mCores.clear();
+		mProcess = {};
+	}
+
+	bool PerfCounterCollector::IsCounted(const PerfCounter counter) const
+	{
+		if (!mHardware && (counter == PerfCounter_Cycles || counter == PerfCounter_Instructions)) { return false; }
+
+		// Both happen in kernel mode, so excluding the kernel leaves them at zero
+		if (mUserOnly && (counter == PerfCounter_ContextSwitches || counter == PerfCounter_Migrations)) { return false; }
+		return true;
+	}
+
+	bool PerfCounterCollector::HasFdRoom() const
+	{
+		size_t groupSize = 0;
+		for (int counter = 0; counter < PerfCounter_Count; counter++) {
+			groupSize += IsCounted((PerfCounter)counter) ? 1 : 0;
+		}
+		return mOpenFds + groupSize <= mFdBudget;
+	}
+
+	void PerfCounterCollector::Sample()
+	{
+		const auto now = std::chrono::steady_clock::now();
+		const double elapsed = std::chrono::duration<double>(now - mLastSample).count();
+		mLastSample = now;
+
+		if (mWatchCores && mCoresAvailable)
+		{
+			if (mCoreGroups.empty()) {
+				OpenCores();
+			}
+
+			std::fill(mCoreScratch.begin(), mCoreScratch.end(), PerfRates{});
+			for (auto& group : mCoreGroups) {
+				Read(group, elapsed, mCoreScratch[(size_t)group.Target]);
+			}
+		}
+		else if (!mCoreGroups.empty())
+		{
+			Close(mCoreGroups);
+			mCoreScratch.clear();
+		}
+
+		const unsigned long procId = mWatchedId;
+		if (procId != mOpenId)
+		{
+			Close(mThreadGroups);
+			mOpenId = procId;
+			mDenied = false;
+		}
+
+		// Summed over the threads; each group counts for the share of the interval its thread ran
+		ProcessPerfRates process;
+		process.ProcessId = procId;
+		if (procId != (unsigned long)-1)
+		{
+			RefreshThreads(procId);
+			for (auto& group : mThreadGroups)
+			{
+				PerfRates rates;
+				if (!Read(group, elapsed, rates) || !rates.Available) { continue; }
+
+				for (int counter = 0; counter < PerfCounter_Count; counter++)
+				{
+					process.Rates.Rates[counter] += rates.Rates[counter];
+					process.Rates.Counted[counter] |= rates.Counted[counter];
+				}
+				process.Rates.Available = true;
+			}
+			process.Threads = (uint32_t)mThreadGroups.size();
+			process.Truncated = mTruncated;
+			process.Denied = mDenied;
+		}
+
+		std::scoped_lock lock(mMutex);
+		mCores.assign(mCoreScratch.begin(), mCoreScratch.end());
+		mProcess = process;
+	}
+
+	void PerfCounterCollector::Close(std::vector<CounterGroup>& groups)
+	{
+		for (auto& group : groups) {
+			Close(group);
+		}
+		groups.clear();
+	}
+
+#if defined(RS_PLATFORM_LINUX)
+
+	namespace
+	{
+		struct EventType
+		{
+			uint32_t Type;
+			uint64_t Config;
+		};
+
+		constexpr EventType EVENT_TYPES[PerfCounter_Count] = {
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+			{ PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+			{ PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS },
+			{ PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS }
+		};
+
+		int OpenEvent(const PerfCounter counter, const bool userOnly, const int32_t pid, const int32_t cpu, const int leader)
+		{
+			perf_event_attr attr{};
+			attr.size = sizeof(attr);
+			attr.type = EVENT_TYPES[counter].Type;
+			attr.config = EVENT_TYPES[counter].Config;
+			attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			attr.exclude_kernel = userOnly;
+			attr.exclude_hv = userOnly;
+
+			// glibc has no wrapper
+			return (int)syscall(SYS_perf_event_open, &attr, pid, cpu, leader, PERF_FLAG_FD_CLOEXEC);
+		}
+	}
+
+	PerfCounterCollector::PerfCounterCollector()
+		: SampledCollector("Perf counters", Subsystem_PerfCounters, SAMPLE_INTERVAL)
+	{
+		Probe();
+	}
+
+	PerfCounterCollector::~PerfCounterCollector()
+	{
+		Close(mCoreGroups);
+		Close(mThreadGroups);
+	}
+
+	void PerfCounterCollector::Probe()
+	{
+		// Counting kernel events needs perf_event_paranoid below 2, or CAP_PERFMON; page faults
+		// are taken on behalf of user code, so they still count without
+		int fd = OpenEvent(PerfCounter_ContextSwitches, false, 0, -1, -1);
+		if (fd < 0 && (errno == EACCES || errno == EPERM))
+		{
+			mUserOnly = true;
+			fd = OpenEvent(PerfCounter_PageFaults, true, 0, -1, -1);
+			if (fd >= 0) {
+				RS_CORE_INFO("Kernel events may not be counted, context switches and migrations are left out");
+			}
+		}
+		if (fd < 0)
+		{
+			RS_CORE_INFO("Performance counters are not available ({0})", std::strerror(errno));
+			return;
+		}
+		close(fd);
+		mAvailable = true;
+
+		// VMs rarely expose a PMU; opening the cycle counter then fails with ENOENT or EOPNOTSUPP
+		fd = OpenEvent(PerfCounter_Cycles, mUserOnly, 0, -1, -1);
+		mHardware = fd >= 0;
+		if (fd >= 0) {
+			close(fd);
+		} else {
+			RS_CORE_INFO("Hardware performance counters are not exposed, counting software events only");
+		}
+
+		// Whole-CPU counters need perf_event_paranoid of 0 or lower, or CAP_PERFMON
+		fd = OpenEvent(mUserOnly ? PerfCounter_PageFaults : PerfCounter_ContextSwitches, mUserOnly, -1, 0, -1);
+		mCoresAvailable = fd >= 0;
+		if (fd >= 0) {
+			close(fd);
+		}
+
+		// Half the descriptor limit, leaving the rest to the process scan and everything else
+		rlimit limit{};
+		mFdBudget = getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY ? (size_t)limit.rlim_cur / 2 : 4096;
+	}
+
+	void PerfCounterCollector::OpenCores()
+	{
+		// CPU numbers can have holes, with cores offline or left out by maxcpus=
+		std::vector<uint32_t> cpus;
+		char buffer[256];
+		if (ProcFS::ReadFile("/sys/devices/system/cpu/online", buffer, sizeof(buffer)) > 0) {
+			ProcFS::ParseCpuList(buffer, cpus);
+		}
+		if (cpus.empty())
+		{
+			const long online = sysconf(_SC_NPROCESSORS_ONLN);
+			for (uint32_t cpu = 0; cpu < (uint32_t)std::max(online, 1L); cpu++) {
+				cpus.push_back(cpu);
+			}
+		}
+
+		bool limited = false;
+		mCoreScratch.resize(cpus.back() + 1);
+		for (const uint32_t cpu : cpus)
+		{
+			if (!HasFdRoom())
+			{
+				limited = true;
+				break;
+			}
+
+			CounterGroup group;
+			group.Target = (int32_t)cpu;
+			if (Open(group, -1, (int32_t)cpu)) {
+				mCoreGroups.emplace_back(group);
+			}
+		}
+
+		if (limited && !mCoresLimited) {
+			RS_CORE_WARN("Counting {0} of {1} cores, the rest would exceed the descriptor limit", mCoreGroups.size(), cpus.size());
+		}
+		mCoresLimited = limited;
+	}
+
+	bool PerfCounterCollector::Open(CounterGroup& group, const int32_t pid, const int32_t cpu)
+	{
+		// The first counter to open leads the group; one that fails leaves the rest counting
+		group.Size = 0;
+		for (int counter = 0; counter < PerfCounter_Count; counter++)
+		{
+			if (!IsCounted((PerfCounter)counter)) { continue; }
+
+			const int leader = group.Size ? group.Fds[group.Order[0]] : -1;
+			const int fd = OpenEvent((PerfCounter)counter, mUserOnly, pid, cpu, leader);
+			if (fd < 0) { continue; }
+
+			group.Fds[counter] = fd;
+			group.Order[group.Size++] = (PerfCounter)counter;
+			mOpenFds++;
+		}
+
+		return group.Size > 0;
+	}
+
+	bool PerfCounterCollector::Read(CounterGroup& group, const double elapsed, PerfRates& rates) const
+	{
+		if (!group.Size) { return false; }
+
+		// { nr, time_enabled, time_running, value of each member in the order they were opened }
+		uint64_t values[3 + PerfCounter_Count];
+		const ssize_t length = read(group.Fds[group.Order[0]], values, sizeof(values));
+		if (length < (ssize_t)((3 + group.Size) * sizeof(uint64_t)) || values[0] != (uint64_t)group.Size) {
+			return false;
+		}
+
+		const uint64_t enabled = values[1], running = values[2];
+		if (group.HasSample && elapsed > 0.0)
+		{
+			// With more groups than PMU counters the kernel rotates them, so each counted part of the time
+			const uint64_t ran = running - group.LastRunning;
+			const double scale = ran ? (double)(enabled - group.LastEnabled) / (double)ran : 0.0;
+			for (int i = 0; i < group.Size; i++)
+			{
+				const PerfCounter counter = group.Order[i];
+				const uint64_t value = values[3 + i];
+				const uint64_t delta = value >= group.Last[counter] ? value - group.Last[counter] : 0;
+				rates.Rates[counter] = (double)delta * scale / elapsed;
+				rates.Counted[counter] = true;
+			}
+			rates.Available = true;
+		}
+
+		for (int i = 0; i < group.Size; i++) {
+			group.Last[group.Order[i]] = values[3 + i];
+		}
+		group.LastEnabled = enabled;
+		group.LastRunning = running;
+		group.HasSample = true;
+		return true;
+	}
+
+	void PerfCounterCollector::Close(CounterGroup& group)
+	{
+		// Members first, so none counts on as a group of its own once the leader is gone
+		for (int i = group.Size - 1; i >= 0; i--)
+		{
+			const PerfCounter counter = group.Order[i];
+			close(group.Fds[counter]);
+			group.Fds[counter] = -1;
+		}
+		mOpenFds -= (size_t)group.Size;
+		group.Size = 0;
+		group.HasSample = false;
+	}
+
+	void PerfCounterCollector::RefreshThreads(const unsigned long procId)
+	{
+		if (mDenied) { return; }
+
+		char path[32];
+		snprintf(path, sizeof(path), "/proc/%lu/task", procId);
+
+		mThreadIds.clear();
+		DIR* dir = opendir(path);
+		if (!dir)
+		{
+			Close(mThreadGroups);
+			return;
+		}
+		while (const dirent* entry = readdir(dir))
+		{
+			if (ProcFS::IsNumeric(entry->d_name)) {
+				mThreadIds.emplace_back((int32_t)std::strtol(entry->d_name, nullptr, 10));
+			}
+		}
+		closedir(dir);
+		std::sort(mThreadIds.begin(), mThreadIds.end());
+
+		// Exited threads give up their groups
+		for (size_t i = 0; i < mThreadGroups.size();)
+		{
+			if (std::binary_search(mThreadIds.begin(), mThreadIds.end(), mThreadGroups[i].Target)) {
+				i++;
+				continue;
+			}
+			Close(mThreadGroups[i]);
+			mThreadGroups[i] = mThreadGroups.back();
+			mThreadGroups.pop_back();
+		}
+
+		// New ones get theirs, up to the cap
+		mTruncated = false;
+		for (const int32_t threadId : mThreadIds)
+		{
+			const auto found = std::find_if(mThreadGroups.begin(), mThreadGroups.end(), [threadId](const CounterGroup& group) {
+				return group.Target == threadId;
+			});
+			if (found != mThreadGroups.end()) { continue; }
+
+			if (mThreadGroups.size() >= MAX_PROCESS_THREADS || !HasFdRoom())
+			{
+				mTruncated = true;
+				break;
+			}
+
+			CounterGroup group;
+			group.Target = threadId;
+			if (Open(group, threadId, -1)) {
+				mThreadGroups.emplace_back(group);
+			} else if (mThreadGroups.empty() && (errno == EACCES || errno == EPERM)) {
+				// Another user's process without the privilege to trace it; not retried until reselected
+				mDenied = true;
+				return;
+			}
+		}
+	}
+
+#else
+
+	PerfCounterCollector::PerfCounterCollector()
+		: SampledCollector("Perf counters", Subsystem_PerfCounters, SAMPLE_INTERVAL)
+	{
+		// No perf_event_open; the collector stays unavailable
+	}
+
+	PerfCounterCollector::~PerfCounterCollector()
+	{
+	}
+
+	void PerfCounterCollector::Probe()
+	{
+	}
+
+	void PerfCounterCollector::OpenCores()
+	{
+	}
+
+	bool PerfCounterCollector::Open(CounterGroup& group, int32_t pid, int32_t cpu)
+	{
+		return false;
+	}
+
+	bool PerfCounterCollector::Read(CounterGroup& group, double elapsed, PerfRates& rates) const
+	{
+		return false;
+	}
+
+	void PerfCounterCollector::Close(CounterGroup& group)
+	{
+	}
+
+	void PerfCounterCollector::RefreshThreads(unsigned long procId)
+	{
+	}
+
+#endif
+
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "system/SampledCollector.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace RESANA {
+
+	// Hardware counters come first; they are only opened when the PMU is exposed
+	enum PerfCounter
+	{
+		PerfCounter_Cycles = 0,
+		PerfCounter_Instructions,
+		PerfCounter_ContextSwitches,
+		PerfCounter_Migrations,
+		PerfCounter_PageFaults,
+		PerfCounter_Count
+	};
+
+	struct PerfRates
+	{
+		double Rates[PerfCounter_Count]{};   // Per second, scaled up when the PMU multiplexed the group
+		bool Counted[PerfCounter_Count]{};   // Opened for this target
+		bool Available = false;
+	};
+
+	struct ProcessPerfRates
+	{
+		unsigned long ProcessId = (unsigned long)-1;
+		PerfRates Rates{};
+		uint32_t Threads{};                  // Threads with counters attached
+		bool Truncated = false;              // More threads than MAX_PROCESS_THREADS or the descriptor budget
+		bool Denied = false;                 // Not permitted to attach to the process
+	};
+
+	/*
+	 * perf_event_open counters per CPU and for the process selected in the
+	 * process panel. Each target gets one group, led by the cycle counter where
+	 * the PMU is exposed and by the first software counter otherwise (as in most
+	 * VMs), and is read with a single read() per group per tick. Without leave
+	 * to count kernel events, context switches and migrations are left out, as
+	 * the kernel records both in kernel mode and a user-only count reads zero. Process counters
+	 * follow threads, since a group cannot be inherited by new ones; each of the
+	 * selected process's threads gets its own group. The collector only runs
+	 * while a panel draws cores or a process. Every counter is a descriptor, so
+	 * the groups held at once are capped at half of RLIMIT_NOFILE; cores are
+	 * opened first, and threads take what is left.
+	 */
+	class PerfCounterCollector : public SampledCollector<PerfCounterCollector> {
+	public:
+		// Panels state what they draw; the loop ends on its own once neither is wanted
+		static void WatchCores(bool watch);
+		static void WatchProcess(unsigned long procId);
+
+		[[nodiscard]] bool IsAvailable() const { return mAvailable; }
+		[[nodiscard]] bool HasHardware() const { return mHardware; }
+		[[nodiscard]] bool HasCores() const { return mCoresAvailable; }
+		[[nodiscard]] bool IsUserOnly() const { return mUserOnly; } // Kernel events refused; switches and migrations aren't counted
+		[[nodiscard]] bool AreCoresLimited() const { return mCoresLimited; } // Some cores didn't fit the descriptor budget
+
+		// Indexed by CPU number; returns false when no core has counters yet
+		bool GetCores(std::vector<PerfRates>& cores) const;
+		[[nodiscard]] ProcessPerfRates GetProcess() const;
+
+		static const char* GetName(PerfCounter counter);
+
+	public:
+		static constexpr uint32_t SAMPLE_INTERVAL = 1000;
+		static constexpr size_t MAX_PROCESS_THREADS = 128;
+
+	private:
+		struct CounterGroup
+		{
+			int32_t Target = -1;                  // CPU or thread ID
+			int Fds[PerfCounter_Count]{ -1, -1, -1, -1, -1 };
+			PerfCounter Order[PerfCounter_Count]{}; // Counter of each value in a group read
+			int Size = 0;
+
+			uint64_t Last[PerfCounter_Count]{};
+			uint64_t LastEnabled{};
+			uint64_t LastRunning{};
+			bool HasSample = false;
+		};
+
+		friend class SampledCollector<PerfCounterCollector>;
+
+		PerfCounterCollector();
+		~PerfCounterCollector() override;
+
+		[[nodiscard]] bool IsWanted() const override;
+		void Sample() override;
+		void OnStopped() override;
+		void Probe();
+		void OpenCores();
+		[[nodiscard]] bool IsCounted(PerfCounter counter) const;
+		[[nodiscard]] bool HasFdRoom() const;
+		bool Open(CounterGroup& group, int32_t pid, int32_t cpu);
+		bool Read(CounterGroup& group, double elapsed, PerfRates& rates) const;
+		void Close(CounterGroup& group);
+		void Close(std::vector<CounterGroup>& groups);
+		void RefreshThreads(unsigned long procId);
+
+	private:
+		std::atomic<bool> mWatchCores{ false };
+		std::atomic<unsigned long> mWatchedId{ (unsigned long)-1 };
+
+		// Settled once by probing the calling process
+		bool mAvailable = false;
+		bool mHardware = false;
+		bool mCoresAvailable = false;
+		bool mUserOnly = false;
+		size_t mFdBudget = 0;
+
+		// Only touched by the collecting thread
+		std::chrono::steady_clock::time_point mLastSample{};
+		std::vector<CounterGroup> mCoreGroups{};
+		std::vector<CounterGroup> mThreadGroups{};
+		std::vector<int32_t> mThreadIds{};
+		std::vector<PerfRates> mCoreScratch{};
+		unsigned long mOpenId = (unsigned long)-1;
+		size_t mOpenFds = 0;
+		bool mTruncated = false;
+		bool mDenied = false;
+		std::atomic<bool> mCoresLimited{ false };
+
+		mutable std::mutex mMutex{};
+		std::vector<PerfRates> mCores{};
+		ProcessPerfRates mProcess{};
+	};
+
+}
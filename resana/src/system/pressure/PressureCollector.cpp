@@ -0,0 +1,144 @@
+#include "rspch.h"
+#include "PressureCollector.h"
+
+#include "core/Core.h"
+#include "helpers/ProcFS.h"
+
+#include <cinttypes>
+#include <limits>
+
+#if defined(RS_PLATFORM_LINUX)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace RESANA {
+
+	bool PressureCollector::IsAvailable() const
+	{
+		return mFiles[PressureResource_Cpu] >= 0 || mFiles[PressureResource_Memory] >= 0 || mFiles[PressureResource_Io] >= 0;
+	}
+
+	PressureSet PressureCollector::GetStats() const
+	{
+		std::scoped_lock lock(mMutex);
+		return mStats;
+	}
+
+	size_t PressureCollector::GetSeries(const PressureResource resource, const bool full)
+	{
+		return (size_t)resource * 2 + (full ? 1 : 0);
+	}
+
+	bool PressureCollector::Parse(const char* buffer, PressureStats& stats)
+	{
+		// "some avg10=0.12 avg60=0.05 avg300=0.01 total=123456", then the same for "full"
+		bool hasSome = false;
+		for (const char* line = buffer; *line; line = ProcFS::NextLine(line))
+		{
+			const bool full = std::strncmp(line, "full ", 5) == 0;
+			if (!full && std::strncmp(line, "some ", 5) != 0) { continue; }
+
+			auto& target = full ? stats.Full : stats.Some;
+			uint64_t total = 0;
+			if (sscanf(line + 5, "avg10=%f avg60=%f avg300=%f total=%" SCNu64, &target.Avg10, &target.Avg60, &target.Avg300, &total) != 4) {
+				continue;
+			}
+			target.Total = total;
+			hasSome |= !full;
+			stats.HasFull |= full;
+		}
+
+		stats.Available = hasSome;
+		return hasSome;
+	}
+
+#if defined(RS_PLATFORM_LINUX)
+
+	PressureCollector::PressureCollector()
+		: SampledCollector("Pressure", Subsystem_Pressure, SAMPLE_INTERVAL)
+	{
+		const char* paths[PressureResource_Count] = { "/proc/pressure/cpu", "/proc/pressure/memory", "/proc/pressure/io" };
+		for (int resource = 0; resource < PressureResource_Count; resource++)
+		{
+			// With psi=0 the files exist but reads fail with EOPNOTSUPP
+			char buffer[256];
+			const int fd = open(paths[resource], O_RDONLY | O_CLOEXEC);
+			if (fd >= 0 && ProcFS::ReadFile(fd, buffer, sizeof(buffer)) > 0) {
+				mFiles[resource] = fd;
+			} else if (fd >= 0) {
+				close(fd);
+			}
+		}
+
+		if (!IsAvailable()) {
+			RS_CORE_INFO("Pressure stall information is not available");
+		}
+	}
+
+	PressureCollector::~PressureCollector()
+	{
+		for (const int fd : mFiles) {
+			if (fd >= 0) {
+				close(fd);
+			}
+		}
+	}
+
+	void PressureCollector::Sample()
+	{
+		const auto now = std::chrono::steady_clock::now();
+		const double elapsed = std::chrono::duration<double, std::micro>(now - mLastSample).count();
+		mLastSample = now;
+
+		PressureSet stats;
+		float stalled[PressureResource_Count * 2];
+		std::fill(std::begin(stalled), std::end(stalled), std::numeric_limits<float>::quiet_NaN());
+
+		std::scoped_lock lock(mMutex);
+		for (int resource = 0; resource < PressureResource_Count; resource++)
+		{
+			char buffer[256];
+			if (mFiles[resource] < 0 || ProcFS::ReadFile(mFiles[resource], buffer, sizeof(buffer)) <= 0) { continue; }
+			if (!Parse(buffer, stats[resource])) { continue; }
+
+			// The first read only sets the baseline
+			if (!mStats[resource].Available) { continue; }
+
+			// Totals are in microseconds, so the change over the interval is the share of it spent stalled
+			const auto rate = [elapsed](PressureLine& current, const PressureLine& last) {
+				if (current.Total < last.Total || elapsed <= 0.0) { return; }
+				current.Stalled = (float)std::min((double)(current.Total - last.Total) / elapsed * 100.0, 100.0);
+			};
+			rate(stats[resource].Some, mStats[resource].Some);
+			rate(stats[resource].Full, mStats[resource].Full);
+
+			stalled[GetSeries((PressureResource)resource, false)] = stats[resource].Some.Stalled;
+			if (stats[resource].HasFull) {
+				stalled[GetSeries((PressureResource)resource, true)] = stats[resource].Full.Stalled;
+			}
+		}
+
+		mStats = stats;
+		mHistory.Append(now, stalled);
+	}
+
+#else
+
+	PressureCollector::PressureCollector()
+		: SampledCollector("Pressure", Subsystem_Pressure, SAMPLE_INTERVAL)
+	{
+		// No PSI; every file stays closed and the collector unavailable
+	}
+
+	PressureCollector::~PressureCollector()
+	{
+	}
+
+	void PressureCollector::Sample()
+	{
+	}
+
+#endif
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "helpers/MetricHistory.h"
+#include "system/SampledCollector.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace RESANA {
+
+	enum PressureResource
+	{
+		PressureResource_Cpu = 0,
+		PressureResource_Memory,
+		PressureResource_Io,
+		PressureResource_Count
+	};
+
+	// Time tasks spent stalled on a resource: "some" while at least one was, "full" while all non-idle ones were
+	struct PressureLine
+	{
+		float Avg10{};    // Percent, averaged by the kernel
+		float Avg60{};
+		float Avg300{};
+		uint64_t Total{}; // Cumulative stall time, in microseconds
+		float Stalled{};  // Percent of the last sample interval, from the change in Total
+	};
+
+	struct PressureStats
+	{
+		PressureLine Some{};
+		PressureLine Full{};
+		bool Available = false;
+		bool HasFull = false; // Missing for the system-wide CPU before Linux 5.13
+	};
+
+	typedef std::array<PressureStats, PressureResource_Count> PressureSet;
+
+	/*
+	 * Pressure stall information from /proc/pressure. The files are kept open
+	 * and read every SAMPLE_INTERVAL ms, well below the panel's tick, so stalls
+	 * too short to move the kernel's ten second average still show up in the
+	 * change of the stall totals. Kernels without PSI (before 4.20, or booted
+	 * with psi=0) leave the collector unavailable and it never starts.
+	 */
+	class PressureCollector : public SampledCollector<PressureCollector> {
+	public:
+		[[nodiscard]] bool IsAvailable() const;
+
+		[[nodiscard]] PressureSet GetStats() const;
+
+		// Stall percent of each sample, one series per resource and line
+		[[nodiscard]] const MetricHistory& GetHistory() const { return mHistory; }
+		static size_t GetSeries(PressureResource resource, bool full);
+
+		// Parses a pressure file, system-wide or of a cgroup; false when it has no "some" line
+		static bool Parse(const char* buffer, PressureStats& stats);
+
+	public:
+		static constexpr uint32_t SAMPLE_INTERVAL = 250;
+
+	private:
+		friend class SampledCollector<PressureCollector>;
+
+		PressureCollector();
+		~PressureCollector() override;
+
+		[[nodiscard]] bool IsWanted() const override { return IsAvailable(); }
+		void Sample() override;
+
+	private:
+		int mFiles[PressureResource_Count]{ -1, -1, -1 };
+		std::chrono::steady_clock::time_point mLastSample{}; // Only touched by the collecting thread
+
+		mutable std::mutex mMutex{};
+		PressureSet mStats{};
+		MetricHistory mHistory{ PressureResource_Count * 2 };
+	};
+
+}
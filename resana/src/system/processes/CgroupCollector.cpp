@@ -0,0 +1,291 @@
+#include "CgroupCollector.h"
+#include "rspch.h"
+
+#include "core/Core.h"
+#include "helpers/ProcFS.h"
+
+#if defined(RS_PLATFORM_LINUX)
+#include <unistd.h>
+#endif
+
+namespace RESANA {
+
+#if defined(RS_PLATFORM_LINUX)
+
+CgroupCollector::CgroupCollector()
+{
+    // Unified hierarchy, or its mount beside the v1 controllers on hybrid systems
+    for (const char* root : { "/sys/fs/cgroup", "/sys/fs/cgroup/unified" }) {
+        if (access((std::string(root) + "/cgroup.controllers").c_str(), F_OK) == 0) {
+            mRoot = root;
+            break;
+        }
+    }
+
+    const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    mNumProcessors = processors > 0 ? (uint32_t)processors : 1;
+}
+
+StringPool::Id CgroupCollector::Resolve(const ulong procId)
+{
+    if (!IsAvailable()) {
+        return StringPool::Empty;
+    }
+    if (const auto it = mProcessCgroups.find(procId); it != mProcessCgroups.end()) {
+        return it->second;
+    }
+
+    char path[32];
+    snprintf(path, sizeof(path), "/proc/%lu/cgroup", procId);
+
+    char buffer[4096];
+    if (ProcFS::ReadFile(path, buffer, sizeof(buffer)) <= 0) {
+        return StringPool::Empty; // Exited; kernel threads do have a cgroup
+    }
+
+    // The unified hierarchy is the "0::/path" line
+    StringPool::Id cgroup = StringPool::Empty;
+    for (const char* line = buffer; *line; line = ProcFS::NextLine(line)) {
+        if (line[0] == '0' && line[1] == ':' && line[2] == ':') {
+            const char* end = line + 3;
+            while (*end && *end != '\n') {
+                end++;
+            }
+            cgroup = StringPool::Get().Intern(std::string_view(line + 3, (size_t)(end - line - 3)));
+            break;
+        }
+    }
+
+    mProcessCgroups.emplace(procId, cgroup);
+    return cgroup;
+}
+
+void CgroupCollector::Refresh()
+{
+    if (!IsAvailable()) {
+        return;
+    }
+
+    // Every cgroup with processes, and the ancestors that connect it to the root
+    std::unordered_map<StringPool::Id, uint32_t> index;
+    std::vector<CgroupStats> cgroups;
+    const auto add = [&](const StringPool::Id path) -> uint32_t {
+        const auto [it, inserted] = index.try_emplace(path, (uint32_t)cgroups.size());
+        if (inserted) {
+            cgroups.emplace_back().Path = path;
+        }
+        return it->second;
+    };
+
+    for (const auto& [procId, cgroup] : mProcessCgroups) {
+        if (cgroup != StringPool::Empty) {
+            cgroups[add(cgroup)].Processes++;
+        }
+    }
+    for (size_t i = 0; i < cgroups.size(); i++) {
+        const StringPool::Id parent = GetParent(StringPool::Get().View(cgroups[i].Path));
+        cgroups[i].Parent = parent;
+        if (parent != StringPool::Empty) {
+            add(parent); // Appended, so the loop reaches it in turn
+        }
+    }
+
+    // Sorted by path, each parent comes before its children
+    const auto& pool = StringPool::Get();
+    std::sort(cgroups.begin(), cgroups.end(), [&pool](const CgroupStats& a, const CgroupStats& b) {
+        return pool.View(a.Path) < pool.View(b.Path);
+    });
+    index.clear();
+    for (uint32_t i = 0; i < (uint32_t)cgroups.size(); i++) {
+        index.emplace(cgroups[i].Path, i);
+    }
+
+    // Children last, so their counts are complete before being added to the parent
+    for (size_t i = cgroups.size(); i-- > 0;) {
+        auto& cgroup = cgroups[i];
+        cgroup.SubtreeProcesses += cgroup.Processes;
+        if (cgroup.Parent != StringPool::Empty) {
+            cgroups[index[cgroup.Parent]].SubtreeProcesses += cgroup.SubtreeProcesses;
+        }
+    }
+
+    std::unordered_map<StringPool::Id, Sample> samples;
+    samples.reserve(cgroups.size());
+    for (auto& cgroup : cgroups) {
+        ReadCgroup(pool.View(cgroup.Path), cgroup);
+
+        Sample sample { cgroup.CpuUsage, cgroup.IoReadBytes, cgroup.IoWriteBytes, cgroup.Pressure, Clock::now() };
+        if (const auto it = mSamples.find(cgroup.Path); it != mSamples.end()) {
+            const Sample& last = it->second;
+            const double elapsed = std::chrono::duration<double>(sample.Time - last.Time).count();
+            if (elapsed > 0.0) {
+                // Counters only grow; a drop means the cgroup was recreated
+                const auto rate = [elapsed](const uint64_t previous, const uint64_t current) {
+                    return (current >= previous) ? (double)(current - previous) / elapsed : 0.0;
+                };
+                cgroup.CpuLoad = rate(last.CpuUsage, sample.CpuUsage) / 1.0e7 / mNumProcessors * 100.0;
+                cgroup.IoReadRate = rate(last.IoReadBytes, sample.IoReadBytes);
+                cgroup.IoWriteRate = rate(last.IoWriteBytes, sample.IoWriteBytes);
+
+                // Stall totals are in microseconds
+                for (int resource = 0; resource < PressureResource_Count; resource++) {
+                    auto& pressure = cgroup.Pressure[resource];
+                    const auto& previous = last.Pressure[resource];
+                    if (pressure.Available && previous.Available) {
+                        pressure.Some.Stalled = (float)std::min(rate(previous.Some.Total, pressure.Some.Total) / 1.0e4, 100.0);
+                        pressure.Full.Stalled = (float)std::min(rate(previous.Full.Total, pressure.Full.Total) / 1.0e4, 100.0);
+                    }
+                }
+            }
+        }
+        samples.emplace(cgroup.Path, sample);
+    }
+    mSamples = std::move(samples); // Drops cgroups that emptied
+
+    std::scoped_lock lock(mMutex);
+    mCgroups = std::move(cgroups);
+}
+
+bool CgroupCollector::ReadCgroup(const std::string_view path, CgroupStats& stats)
+{
+    std::string directory = mRoot;
+    directory.append(path);
+    if (directory.back() != '/') {
+        directory.push_back('/');
+    }
+    const size_t length = directory.size();
+
+    // Files of controllers that aren't enabled for this cgroup are simply missing
+    directory.append("cpu.stat");
+    if (ProcFS::ReadFile(directory.c_str(), mBuffer) > 0) {
+        for (const char* line = mBuffer.data(); *line; line = ProcFS::NextLine(line)) {
+            const char* value = std::strchr(line, ' ');
+            if (!value || value > ProcFS::NextLine(line)) {
+                break;
+            }
+
+            uint64_t usec = 0;
+            ProcFS::ParseUInt64(value + 1, usec);
+            const std::string_view key(line, (size_t)(value - line));
+            if (key == "usage_usec") {
+                stats.CpuUsage = usec * 10;
+            } else if (key == "throttled_usec") {
+                stats.Throttled = usec * 10;
+            }
+        }
+    }
+
+    directory.resize(length);
+    directory.append("memory.current");
+    if (ProcFS::ReadFile(directory.c_str(), mBuffer) > 0) {
+        ProcFS::ParseUInt64(mBuffer.data(), stats.MemoryCurrent);
+    }
+
+    directory.resize(length);
+    directory.append("memory.stat");
+    if (ProcFS::ReadFile(directory.c_str(), mBuffer) > 0) {
+        for (const char* line = mBuffer.data(); *line; line = ProcFS::NextLine(line)) {
+            const char* value = std::strchr(line, ' ');
+            if (!value) {
+                break;
+            }
+
+            const std::string_view key(line, (size_t)(value - line));
+            if (key == "anon") {
+                ProcFS::ParseUInt64(value + 1, stats.MemoryAnon);
+            } else if (key == "file") {
+                ProcFS::ParseUInt64(value + 1, stats.MemoryFile);
+            }
+        }
+    }
+
+    const char* pressureFiles[PressureResource_Count] = { "cpu.pressure", "memory.pressure", "io.pressure" };
+    for (int resource = 0; resource < PressureResource_Count; resource++) {
+        directory.resize(length);
+        directory.append(pressureFiles[resource]);
+        if (ProcFS::ReadFile(directory.c_str(), mBuffer) > 0) {
+            PressureCollector::Parse(mBuffer.data(), stats.Pressure[resource]);
+        }
+    }
+
+    // One line per device: "8:0 rbytes=1 wbytes=2 rios=3 wios=4 dbytes=5 dios=6"
+    directory.resize(length);
+    directory.append("io.stat");
+    if (ProcFS::ReadFile(directory.c_str(), mBuffer) > 0) {
+        for (const char* line = mBuffer.data(); *line; line = ProcFS::NextLine(line)) {
+            for (const char* p = line; *p && *p != '\n'; p++) {
+                uint64_t value = 0;
+                if (std::strncmp(p, " rbytes=", 8) == 0) {
+                    ProcFS::ParseUInt64(p + 8, value);
+                    stats.IoReadBytes += value;
+                } else if (std::strncmp(p, " wbytes=", 8) == 0) {
+                    ProcFS::ParseUInt64(p + 8, value);
+                    stats.IoWriteBytes += value;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+#else
+
+CgroupCollector::CgroupCollector()
+{
+    // No cgroups; mRoot stays empty and the collector is unavailable
+}
+
+StringPool::Id CgroupCollector::Resolve(const ulong procId)
+{
+    return StringPool::Empty;
+}
+
+void CgroupCollector::Refresh()
+{
+}
+
+bool CgroupCollector::ReadCgroup(const std::string_view path, CgroupStats& stats)
+{
+    return false;
+}
+
+#endif
+
+void CgroupCollector::Forget(const ulong procId)
+{
+    mProcessCgroups.erase(procId);
+}
+
+std::vector<CgroupStats> CgroupCollector::GetCgroups() const
+{
+    std::scoped_lock lock(mMutex);
+    return mCgroups;
+}
+
+void CgroupCollector::MarkStrings(StringPool::LiveSet& live) const
+{
+    for (const auto& [procId, cgroup] : mProcessCgroups) {
+        live.Mark(cgroup);
+    }
+    for (const auto& [path, sample] : mSamples) {
+        live.Mark(path);
+    }
+
+    std::scoped_lock lock(mMutex);
+    for (const auto& cgroup : mCgroups) {
+        live.Mark(cgroup.Path);
+        live.Mark(cgroup.Parent);
+    }
+}
+
+StringPool::Id CgroupCollector::GetParent(const std::string_view path)
+{
+    if (path.size() <= 1) {
+        return StringPool::Empty; // The root
+    }
+
+    const size_t slash = path.find_last_of('/');
+    return StringPool::Get().Intern(slash == 0 ? std::string_view("/") : path.substr(0, slash));
+}
+
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "helpers/StringPool.h"
+#include "system/pressure/PressureCollector.h"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace RESANA {
+
+struct CgroupStats {
+    StringPool::Id Path {};      // Relative to the cgroup root, which is "/"
+    StringPool::Id Parent {};    // Empty for the root
+    double CpuLoad {};           // Percent of the whole machine
+    uint64_t CpuUsage {};        // Total CPU time, in 100ns units
+    uint64_t Throttled {};       // Time spent throttled, in 100ns units
+    uint64_t MemoryCurrent {};   // Bytes
+    uint64_t MemoryAnon {};
+    uint64_t MemoryFile {};      // Page cache
+    uint64_t IoReadBytes {};
+    uint64_t IoWriteBytes {};
+    double IoReadRate {};        // Bytes per second
+    double IoWriteRate {};
+    PressureSet Pressure {};     // Unavailable where the kernel has no PSI or the files can't be read
+    uint32_t Processes {};       // Directly in this cgroup
+    uint32_t SubtreeProcesses {};
+};
+
+/*
+ * Attributes processes to their cgroup (v2) and reads the resource totals of
+ * every cgroup that has live processes, along with its ancestors. The kernel
+ * already accounts a cgroup's files over its whole subtree, so the tree only
+ * has to add up process counts. A process is mapped once, when it is first
+ * seen, since it rarely moves between cgroups.
+ */
+class CgroupCollector {
+    typedef unsigned long ulong;
+    typedef std::chrono::steady_clock Clock;
+
+public:
+    CgroupCollector();
+
+    [[nodiscard]] bool IsAvailable() const { return !mRoot.empty(); }
+
+    // Scan thread only
+    StringPool::Id Resolve(ulong procId);
+    void Forget(ulong procId);
+    void Refresh();
+
+    // Parents come before their children
+    [[nodiscard]] std::vector<CgroupStats> GetCgroups() const;
+
+    // Scan thread only
+    void MarkStrings(StringPool::LiveSet& live) const;
+
+private:
+    struct Sample {
+        uint64_t CpuUsage {};
+        uint64_t IoReadBytes {};
+        uint64_t IoWriteBytes {};
+        PressureSet Pressure {};
+        Clock::time_point Time {};
+    };
+
+    bool ReadCgroup(std::string_view path, CgroupStats& stats);
+    static StringPool::Id GetParent(std::string_view path);
+
+private:
+    std::string mRoot {}; // Mount point of the unified hierarchy
+    uint32_t mNumProcessors = 1;
+
+    std::unordered_map<ulong, StringPool::Id> mProcessCgroups {};
+    std::unordered_map<StringPool::Id, Sample> mSamples {};
+    std::vector<char> mBuffer {};
+
+    mutable std::mutex mMutex {};
+    std::vector<CgroupStats> mCgroups {};
+};
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace RESANA {
+
+// Per-process fields that take one or more system calls to read
+enum DetailField : uint32_t {
+    Detail_None = 0,
+    Detail_CommandLine = 1 << 0,
+    Detail_Io = 1 << 1,
+    Detail_Fd = 1 << 2,
+    Detail_Cgroup = 1 << 3,
+    Detail_Modules = 1 << 4, // The selected process always has its modules read
+};
+
+/*
+ * The fields the process table needs right now. Expensive fields are only
+ * read for the visible rows, unless sorting, filtering or searching needs
+ * them for every process. A value already read is kept, so a row scrolled
+ * out of view shows its last sample when it comes back.
+ */
+struct DetailDemand {
+    std::vector<unsigned long> Visible {}; // Process IDs, sorted
+    uint32_t VisibleFields = Detail_None;
+    uint32_t AllFields = Detail_None;
+
+    [[nodiscard]] uint32_t GetFields(const unsigned long procId) const
+    {
+        if ((VisibleFields & ~AllFields) && std::binary_search(Visible.begin(), Visible.end(), procId)) {
+            return AllFields | VisibleFields;
+        }
+        return AllFields;
+    }
+
+    bool operator==(const DetailDemand& other) const
+    {
+        return VisibleFields == other.VisibleFields && AllFields == other.AllFields && Visible == other.Visible;
+    }
+    bool operator!=(const DetailDemand& other) const { return !(*this == other); }
+};
+
+}
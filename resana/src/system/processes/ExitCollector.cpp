@@ -0,0 +1,336 @@
+#include "ExitCollector.h"
+#include "rspch.h"
+
+#include "core/Core.h"
+#include "helpers/ProcFS.h"
+#include "system/SelfProfiler.h"
+
+#if defined(RS_PLATFORM_LINUX)
+#include <cerrno>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace RESANA {
+
+ExitCollector::~ExitCollector()
+{
+    StopCapture();
+}
+
+bool ExitCollector::SetCapture(const bool enable)
+{
+    if (enable == mCapturing) {
+        return true;
+    }
+
+    if (!enable) {
+        StopCapture();
+        return true;
+    }
+    return StartCapture();
+}
+
+void ExitCollector::OnStart(const ulong procId)
+{
+    std::scoped_lock lock(mMutex);
+
+    // Its exit is recorded from the scan's totals, under the scanned name
+    mExecNames.erase(procId);
+
+    // Already recorded by capture, the scan caught it on its way out
+    if (mReported.count(procId)) {
+        return;
+    }
+    mSeen.insert(procId);
+}
+
+void ExitCollector::OnExit(const ulong procId, const StringPool::Id name, const uint64_t cpuTime, const uint64_t memory)
+{
+    std::scoped_lock lock(mMutex);
+    if (mSeen.erase(procId)) {
+        Record(name, cpuTime, memory, false);
+    }
+}
+
+void ExitCollector::OnScanned(const Clock::time_point start)
+{
+    // Names captured before the scan started belong either to a process it saw, whose exit it
+    // records itself, or to one that is gone and whose exit event was dropped under load
+    std::scoped_lock lock(mMutex);
+    for (auto it = mExecNames.begin(); it != mExecNames.end();) {
+        it = (it->second.Time < start) ? mExecNames.erase(it) : std::next(it);
+    }
+}
+
+void ExitCollector::MarkStrings(StringPool::LiveSet& live) const
+{
+    std::scoped_lock lock(mMutex);
+    for (const auto& [name, group] : mGroups) {
+        live.Mark(name);
+    }
+    for (const auto& [procId, exec] : mExecNames) {
+        live.Mark(exec.Name);
+    }
+}
+
+std::vector<ExitedGroup> ExitCollector::GetGroups() const
+{
+    const auto now = Clock::now();
+
+    std::vector<ExitedGroup> groups;
+    {
+        std::scoped_lock lock(mMutex);
+        groups.reserve(mGroups.size());
+        for (const auto& [name, group] : mGroups) {
+            if (now - group.LastExit > RETENTION) {
+                continue;
+            }
+
+            auto& totals = groups.emplace_back(group.Totals);
+            totals.SpawnRate = (double)std::count_if(group.Recent.begin(), group.Recent.end(), [&](const Clock::time_point time) {
+                return now - time <= RATE_WINDOW;
+            }) * (60.0 / (double)RATE_WINDOW.count());
+            totals.SecondsAgo = std::chrono::duration<double>(now - group.LastExit).count();
+        }
+    }
+
+    std::sort(groups.begin(), groups.end(), [](const ExitedGroup& a, const ExitedGroup& b) {
+        return a.SecondsAgo < b.SecondsAgo;
+    });
+    return groups;
+}
+
+void ExitCollector::Record(const StringPool::Id name, const uint64_t cpuTime, const uint64_t memory, const bool unseen)
+{
+    const auto now = Clock::now();
+
+    auto& group = mGroups[name];
+    group.Totals.Name = name;
+    group.Totals.Count++;
+    group.Totals.Unseen += unseen ? 1 : 0;
+    group.Totals.CpuTime += cpuTime;
+    group.Totals.PeakMemory = std::max(group.Totals.PeakMemory, memory);
+    group.Recent.emplace_back(now);
+    group.LastExit = now;
+
+    // Bursts of exits would otherwise grow the windows without bound
+    if (now - mLastPrune >= std::chrono::seconds(1)) {
+        Prune(now);
+        mLastPrune = now;
+    }
+}
+
+void ExitCollector::Prune(const Clock::time_point now)
+{
+    for (auto it = mGroups.begin(); it != mGroups.end();) {
+        auto& recent = it->second.Recent;
+        while (!recent.empty() && now - recent.front() > RATE_WINDOW) {
+            recent.pop_front();
+        }
+        it = (now - it->second.LastExit > RETENTION) ? mGroups.erase(it) : std::next(it);
+    }
+
+    for (auto it = mReported.begin(); it != mReported.end();) {
+        it = (now - it->second > REPORTED_WINDOW) ? mReported.erase(it) : std::next(it);
+    }
+}
+
+#if defined(RS_PLATFORM_LINUX)
+
+bool ExitCollector::StartCapture()
+{
+    StopCapture();
+
+    // The proc connector multicasts fork, exec and exit events to root listeners
+    const int sock = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_CONNECTOR);
+    if (sock < 0) {
+        return false;
+    }
+
+    sockaddr_nl address {};
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = CN_IDX_PROC;
+    if (bind(sock, (sockaddr*)&address, sizeof(address)) < 0) {
+        close(sock);
+        return false;
+    }
+
+    // Wake up regularly so the thread notices when capture stops
+    timeval timeout { 0, 250000 };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    alignas(nlmsghdr) char buffer[NLMSG_SPACE(sizeof(cn_msg) + sizeof(proc_cn_mcast_op))] {};
+    auto* header = (nlmsghdr*)buffer;
+    header->nlmsg_len = NLMSG_LENGTH(sizeof(cn_msg) + sizeof(proc_cn_mcast_op));
+    header->nlmsg_type = NLMSG_DONE;
+    auto* message = (cn_msg*)NLMSG_DATA(header);
+    message->id.idx = CN_IDX_PROC;
+    message->id.val = CN_VAL_PROC;
+    message->len = sizeof(proc_cn_mcast_op);
+    *(proc_cn_mcast_op*)message->data = PROC_CN_MCAST_LISTEN;
+
+    if (send(sock, buffer, header->nlmsg_len, 0) < 0) {
+        close(sock);
+        return false;
+    }
+
+    mSocket = sock;
+    mCapturing = true;
+    mCaptureThread = std::thread(&ExitCollector::CaptureThread, this);
+    return true;
+}
+
+void ExitCollector::StopCapture()
+{
+    // The thread may also have stopped by itself, if the socket failed
+    mCapturing = false;
+    if (mCaptureThread.joinable()) {
+        mCaptureThread.join();
+    }
+    if (mSocket >= 0) {
+        close(mSocket);
+        mSocket = -1;
+    }
+
+    std::scoped_lock lock(mMutex);
+    mExecNames.clear();
+}
+
+void ExitCollector::CaptureThread()
+{
+    SelfProfiler::NameThread("Exit capture");
+
+    alignas(nlmsghdr) char buffer[16 * 1024];
+    while (mCapturing) {
+        // Charged per receive, the thread lives as long as the capture
+        SelfProfiler::Scope scope(Subsystem_ExitCapture);
+        const ssize_t length = recv(mSocket, buffer, sizeof(buffer), 0);
+        if (length <= 0) {
+            // Timeouts just re-check the flag; ENOBUFS means events were dropped under load
+            if (length < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR || errno == ENOBUFS)) {
+                continue;
+            }
+            break;
+        }
+
+        int remaining = (int)length;
+        for (auto* header = (nlmsghdr*)buffer; NLMSG_OK(header, remaining); header = NLMSG_NEXT(header, remaining)) {
+            if (header->nlmsg_type == NLMSG_ERROR || header->nlmsg_type == NLMSG_NOOP) {
+                continue;
+            }
+
+            const auto* message = (const cn_msg*)NLMSG_DATA(header);
+            if (message->id.idx != CN_IDX_PROC || message->id.val != CN_VAL_PROC) {
+                continue;
+            }
+
+            // Only whole processes; thread group leaders have pid == tgid
+            const auto* event = (const proc_event*)message->data;
+            if (event->what == proc_event::PROC_EVENT_EXEC && event->event_data.exec.process_pid == event->event_data.exec.process_tgid) {
+                OnCapturedExec((ulong)event->event_data.exec.process_pid);
+            } else if (event->what == proc_event::PROC_EVENT_EXIT && event->event_data.exit.process_pid == event->event_data.exit.process_tgid) {
+                OnCapturedExit((ulong)event->event_data.exit.process_pid);
+            }
+        }
+    }
+    mCapturing = false;
+}
+
+void ExitCollector::OnCapturedExec(const ulong procId)
+{
+    // The name is taken now, the process may be reaped before its exit is read
+    char path[32];
+    snprintf(path, sizeof(path), "/proc/%lu/exe", procId);
+
+    StringPool::Id name = StringPool::Empty;
+    char target[4096];
+    const ssize_t length = readlink(path, target, sizeof(target) - 1);
+    if (length > 0) {
+        const std::string_view exe(target, (size_t)length);
+        name = StringPool::Get().Intern(exe.substr(exe.find_last_of('/') + 1));
+    } else {
+        snprintf(path, sizeof(path), "/proc/%lu/comm", procId);
+        char comm[64];
+        const long read = ProcFS::ReadFile(path, comm, sizeof(comm));
+        if (read > 0) {
+            name = StringPool::Get().Intern(std::string_view(comm, (size_t)read - (comm[read - 1] == '\n' ? 1 : 0)));
+        }
+    }
+
+    if (name != StringPool::Empty) {
+        std::scoped_lock lock(mMutex);
+        mExecNames[procId] = { name, Clock::now() };
+    }
+}
+
+void ExitCollector::OnCapturedExit(const ulong procId)
+{
+    // The exiting process lingers as a zombie until reaped; read its totals while it does
+    char path[32];
+    snprintf(path, sizeof(path), "/proc/%lu/stat", procId);
+
+    char buffer[1024];
+    uint64_t cpuTime = 0;
+    StringPool::Id name = StringPool::Empty;
+    if (ProcFS::ReadFile(path, buffer, sizeof(buffer)) > 0) {
+        // "pid (comm) state ..." -- utime and stime are fields 14 and 15
+        uint64_t utime = 0, stime = 0;
+        const char* p = ProcFS::SkipFields(ProcFS::SkipComm(buffer), 11);
+        p = ProcFS::ParseUInt64(p, utime);
+        ProcFS::ParseUInt64(ProcFS::SkipSpaces(p), stime);
+        cpuTime = ProcFS::TicksTo100ns(utime + stime);
+
+        const char* open = std::strchr(buffer, '(');
+        const char* close = std::strrchr(buffer, ')');
+        if (open && close > open) {
+            name = StringPool::Get().Intern(std::string_view(open + 1, (size_t)(close - open - 1)));
+        }
+    }
+
+    std::scoped_lock lock(mMutex);
+    if (const auto it = mExecNames.find(procId); it != mExecNames.end()) {
+        name = it->second.Name;
+        mExecNames.erase(it);
+    }
+    if (name == StringPool::Empty) {
+        return; // Gone before anything could be read
+    }
+
+    // Processes the scan has seen are recorded with its totals when it drops them
+    if (mSeen.count(procId)) {
+        return;
+    }
+    Record(name, cpuTime, 0, true);
+    mReported[procId] = Clock::now();
+}
+
+#else
+
+bool ExitCollector::StartCapture()
+{
+    return false; // Only scanned processes are recorded
+}
+
+void ExitCollector::StopCapture()
+{
+}
+
+void ExitCollector::CaptureThread()
+{
+}
+
+void ExitCollector::OnCapturedExec(const ulong procId)
+{
+}
+
+void ExitCollector::OnCapturedExit(const ulong procId)
+{
+}
+
+#endif
+
+}
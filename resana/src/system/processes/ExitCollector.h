@@ -0,0 +1,98 @@
+#pragma once
+
+#include "helpers/StringPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace RESANA {
+
+struct ExitedGroup {
+    StringPool::Id Name {};
+    uint64_t Count {};      // Exits recorded
+    uint64_t Unseen {};     // Of which exited before any scan saw them
+    uint64_t CpuTime {};    // Cumulative, in 100ns units
+    uint64_t PeakMemory {}; // Largest final working set
+    double SpawnRate {};    // Exits per minute, over the last minute
+    double SecondsAgo {};   // Since the last exit
+};
+
+/*
+ * Records processes as they exit, grouped by executable name. Processes seen
+ * by a scan are reported with their final totals when the scan drops them.
+ * With capture on, the Linux proc connector also reports processes that
+ * start and exit between two scans, which the walk alone never sees (build
+ * hosts spawn thousands of them). Capture needs CAP_NET_ADMIN; without it only
+ * scanned processes are recorded.
+ */
+class ExitCollector {
+    typedef unsigned long ulong;
+
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    ~ExitCollector();
+
+    // Returns false if capture isn't available on this system
+    bool SetCapture(bool enable);
+    [[nodiscard]] bool IsCapturing() const { return mCapturing; }
+
+    // Called by the scan when a process first appears and when it is dropped
+    void OnStart(ulong procId);
+    void OnExit(ulong procId, StringPool::Id name, uint64_t cpuTime, uint64_t memory);
+
+    // Called by the scan once it has visited every process that existed when it started
+    void OnScanned(Clock::time_point start);
+
+    // Groups with an exit within the retention window, most recent first
+    [[nodiscard]] std::vector<ExitedGroup> GetGroups() const;
+
+    void MarkStrings(StringPool::LiveSet& live) const;
+
+private:
+    struct Group {
+        ExitedGroup Totals {};
+        std::deque<Clock::time_point> Recent {}; // Exits within the rate window
+        Clock::time_point LastExit {};
+    };
+
+    struct ExecName {
+        StringPool::Id Name {};
+        Clock::time_point Time {};
+    };
+
+    void Record(StringPool::Id name, uint64_t cpuTime, uint64_t memory, bool unseen);
+    void Prune(Clock::time_point now);
+
+    bool StartCapture();
+    void StopCapture();
+    void CaptureThread();
+    void OnCapturedExec(ulong procId);
+    void OnCapturedExit(ulong procId);
+
+private:
+    const std::chrono::seconds RATE_WINDOW { 60 };
+    const std::chrono::seconds RETENTION { 600 };
+    const std::chrono::seconds REPORTED_WINDOW { 10 };
+
+    mutable std::mutex mMutex {};
+    std::unordered_map<StringPool::Id, Group> mGroups {};
+    std::unordered_set<ulong> mSeen {};                          // Alive in the scanned map
+    std::unordered_map<ulong, Clock::time_point> mReported {};   // Exits already recorded by capture
+    std::unordered_map<ulong, ExecName> mExecNames {};           // Names captured at exec, until the exit or a scan
+    Clock::time_point mLastPrune {};
+
+    // Capture, Linux only
+    std::atomic<bool> mCapturing = false;
+    std::thread mCaptureThread {};
+    int mSocket = -1;
+};
+
+}
@@ -0,0 +1,190 @@
+#include "FdCollector.h"
+#include "rspch.h"
+
+#include "core/Core.h"
+
+#if defined(RS_PLATFORM_LINUX)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace RESANA {
+
+void FdCollector::SetSelected(const ulong procId)
+{
+    std::scoped_lock lock(mMutex);
+    mSelected = procId;
+}
+
+void FdCollector::Forget(const ulong procId)
+{
+    mHistory.erase(procId);
+}
+
+bool FdCollector::GetBreakdown(const ulong procId, FdBreakdown& breakdown) const
+{
+    std::scoped_lock lock(mMutex);
+    if (procId != mBreakdownId) {
+        return false;
+    }
+
+    breakdown = mBreakdown;
+    return true;
+}
+
+bool FdCollector::Sample(const ulong procId, FdStats& stats)
+{
+    ulong selected;
+    {
+        std::scoped_lock lock(mMutex);
+        selected = mSelected;
+    }
+
+    auto& history = mHistory[procId];
+    const auto now = Clock::now();
+    const bool isSelected = HAS_BREAKDOWN && procId == selected;
+
+    // The selected process keeps its breakdown fresh, but no more often than the fastest schedule
+    const auto due = isSelected ? history.LastSample + MIN_INTERVAL : history.NextSample;
+    if (history.Denied || now < due) {
+        stats = history.Stats;
+        return history.Valid;
+    }
+
+    FdBreakdown breakdown;
+    bool denied = false;
+    const long count = CountDescriptors(procId, isSelected ? &breakdown : nullptr, denied);
+    if (count < 0) {
+        history.Valid = false;
+        history.Denied = denied; // Remembered until the process exits
+        return false;
+    }
+
+    if (history.Valid) {
+        const double minutes = std::chrono::duration<double, std::ratio<60>>(now - history.LastSample).count();
+        if (minutes > 0.0) {
+            const double rate = ((double)count - (double)history.Stats.Count) / minutes;
+            history.Stats.Trend = 0.5 * history.Stats.Trend + 0.5 * rate;
+        }
+
+        // Growing counts are followed closely, stable ones back off
+        if ((uint32_t)count > history.Stats.Count) {
+            history.Interval = MIN_INTERVAL;
+        } else if ((uint32_t)count == history.Stats.Count) {
+            history.Interval = std::min(history.Interval * 2, MAX_INTERVAL);
+        }
+    } else {
+        history.Interval = MIN_INTERVAL;
+    }
+
+    history.Stats.Count = (uint32_t)count;
+    history.Valid = true;
+    history.LastSample = now;
+    history.NextSample = now + history.Interval;
+
+    if (isSelected) {
+        std::scoped_lock lock(mMutex);
+        mBreakdownId = procId;
+        mBreakdown = breakdown;
+    }
+
+    stats = history.Stats;
+    return true;
+}
+
+#if defined(RS_PLATFORM_WINDOWS)
+
+long FdCollector::CountDescriptors(const ulong procId, FdBreakdown* breakdown, bool& denied)
+{
+    HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, procId);
+    if (!hProcess) {
+        denied = GetLastError() == ERROR_ACCESS_DENIED;
+        return -1;
+    }
+
+    DWORD handleCount = 0;
+    const bool success = GetProcessHandleCount(hProcess, &handleCount);
+    CloseHandle(hProcess);
+    return success ? (long)handleCount : -1;
+}
+
+#elif defined(RS_PLATFORM_LINUX)
+
+long FdCollector::CountDescriptors(const ulong procId, FdBreakdown* breakdown, bool& denied)
+{
+    // Same layout as struct linux_dirent64; glibc only exposes getdents64() from 2.30
+    struct DirEntry {
+        uint64_t Inode;
+        int64_t Offset;
+        unsigned short Length;
+        unsigned char Type;
+        char Name[1];
+    };
+
+    char path[32];
+    snprintf(path, sizeof(path), "/proc/%lu/fd", procId);
+
+    const int dirFd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd < 0) {
+        denied = errno == EACCES || errno == EPERM;
+        return -1;
+    }
+
+    if (breakdown) {
+        *breakdown = {};
+    }
+
+    long count = 0;
+    long length;
+    while ((length = syscall(SYS_getdents64, dirFd, mBuffer, sizeof(mBuffer))) > 0) {
+        for (long offset = 0; offset < length;) {
+            const auto* entry = (const DirEntry*)(mBuffer + offset);
+            offset += entry->Length;
+
+            if (entry->Name[0] == '.') {
+                continue; // "." and ".."
+            }
+            count++;
+
+            if (!breakdown) {
+                continue;
+            }
+
+            // The link target names the type: "socket:[123]", "pipe:[456]", "anon_inode:[eventfd]", or a path
+            char target[64];
+            const ssize_t targetLength = readlinkat(dirFd, entry->Name, target, sizeof(target) - 1);
+            if (targetLength <= 0) {
+                continue; // Closed while walking
+            }
+            target[targetLength] = '\0';
+
+            if (target[0] == '/') {
+                breakdown->Files++;
+            } else if (std::strncmp(target, "socket:", 7) == 0) {
+                breakdown->Sockets++;
+            } else if (std::strncmp(target, "pipe:", 5) == 0) {
+                breakdown->Pipes++;
+            } else if (std::strncmp(target, "anon_inode:", 11) == 0) {
+                breakdown->AnonInodes++;
+            } else {
+                breakdown->Other++;
+            }
+        }
+    }
+
+    close(dirFd);
+    return (length < 0) ? -1 : count;
+}
+
+#else
+
+long FdCollector::CountDescriptors(const ulong procId, FdBreakdown* breakdown, bool& denied)
+{
+    return -1;
+}
+
+#endif
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "core/Core.h"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+namespace RESANA {
+
+struct FdStats {
+    uint32_t Count {}; // Open descriptors (handles on Windows)
+    double Trend {};   // Smoothed growth, in descriptors per minute
+};
+
+struct FdBreakdown {
+    uint32_t Files {};
+    uint32_t Sockets {};
+    uint32_t Pipes {};
+    uint32_t AnonInodes {};
+    uint32_t Other {};
+};
+
+/*
+ * Counts open file descriptors per process during the process walk. Counting
+ * only needs the directory entries of /proc/[pid]/fd, never a stat per entry.
+ * Processes with a stable count are sampled less and less often, while a
+ * growing count (the usual sign of a leak) is followed closely; this schedule
+ * is the collector's own, so the scan asks for a sample on every walk. The
+ * slower breakdown by type is only gathered for the selected process.
+ */
+class FdCollector {
+    typedef unsigned long ulong;
+    typedef std::chrono::steady_clock Clock;
+
+public:
+    // Windows only has a handle count, the types would take a system-wide handle walk
+#if defined(RS_PLATFORM_LINUX)
+    static constexpr bool HAS_BREAKDOWN = true;
+#else
+    static constexpr bool HAS_BREAKDOWN = false;
+#endif
+
+    void SetSelected(ulong procId);
+
+    // Samples the process if it's due, otherwise returns the last sample.
+    // Returns false if the count is unavailable (denied or exited).
+    bool Sample(ulong procId, FdStats& stats);
+    void Forget(ulong procId);
+
+    // Returns false unless a breakdown of the given process is available
+    bool GetBreakdown(ulong procId, FdBreakdown& breakdown) const;
+
+private:
+    struct FdHistory {
+        FdStats Stats {};
+        bool Valid = false;
+        bool Denied = false;
+        Clock::time_point LastSample {};
+        Clock::time_point NextSample {};
+        std::chrono::milliseconds Interval { 0 };
+    };
+
+    long CountDescriptors(ulong procId, FdBreakdown* breakdown, bool& denied);
+
+private:
+    const std::chrono::milliseconds MIN_INTERVAL { 1000 };
+    const std::chrono::milliseconds MAX_INTERVAL { 30000 };
+
+    std::unordered_map<ulong, FdHistory> mHistory {}; // Only touched from the scan thread
+
+    mutable std::mutex mMutex {};
+    ulong mSelected = (ulong)-1;
+    ulong mBreakdownId = (ulong)-1;
+    FdBreakdown mBreakdown {};
+
+    char mBuffer[16 * 1024] {}; // Directory entries, scan thread only
+};
+
+}
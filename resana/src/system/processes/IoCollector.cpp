@@ -0,0 +1,120 @@
+#include "IoCollector.h"
+#include "rspch.h"
+
+#include "core/Core.h"
+#include "helpers/ProcFS.h"
+
+#if defined(RS_PLATFORM_LINUX)
+#include <cerrno>
+#endif
+
+namespace RESANA {
+
+void IoCollector::Forget(const ulong procId)
+{
+    mDenied.erase(procId);
+}
+
+IoRates IoCollector::CalcRates(const IoCounters& previous, const IoCounters& current, const double elapsed)
+{
+    if (elapsed <= 0.0) {
+        return {};
+    }
+
+    // Counters only grow; a drop means the pid was reused
+    const auto rate = [elapsed](const uint64_t last, const uint64_t now) {
+        return (now >= last) ? (double)(now - last) / elapsed : 0.0;
+    };
+
+    return {
+        rate(previous.ReadBytes, current.ReadBytes),
+        rate(previous.WriteBytes, current.WriteBytes),
+        rate(previous.ReadOps, current.ReadOps),
+        rate(previous.WriteOps, current.WriteOps),
+    };
+}
+
+#if defined(RS_PLATFORM_WINDOWS)
+
+bool IoCollector::Sample(const ulong procId, IoCounters& counters)
+{
+    if (IsDenied(procId)) {
+        return false;
+    }
+
+    HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, procId);
+    if (!hProcess) {
+        if (GetLastError() == ERROR_ACCESS_DENIED) {
+            mDenied.insert(procId);
+        }
+        return false;
+    }
+
+    // Windows counts all I/O, not only storage, and doesn't track cancelled writes
+    IO_COUNTERS io {};
+    const bool success = GetProcessIoCounters(hProcess, &io);
+    CloseHandle(hProcess);
+
+    if (success) {
+        counters.ReadBytes = io.ReadTransferCount;
+        counters.WriteBytes = io.WriteTransferCount;
+        counters.ReadOps = io.ReadOperationCount;
+        counters.WriteOps = io.WriteOperationCount;
+        counters.CancelledWriteBytes = 0;
+    }
+    return success;
+}
+
+#elif defined(RS_PLATFORM_LINUX)
+
+bool IoCollector::Sample(const ulong procId, IoCounters& counters)
+{
+    if (IsDenied(procId)) {
+        return false;
+    }
+
+    char path[32];
+    snprintf(path, sizeof(path), "/proc/%lu/io", procId);
+
+    char buffer[512];
+    if (ProcFS::ReadFile(path, buffer, sizeof(buffer)) <= 0) {
+        // Reading io needs ptrace access; anything else means the process exited
+        if (errno == EACCES || errno == EPERM) {
+            mDenied.insert(procId);
+        }
+        return false;
+    }
+
+    // "key: value" lines -- rchar, wchar, syscr, syscw, read_bytes, write_bytes, cancelled_write_bytes
+    for (const char* line = buffer; *line; line = ProcFS::NextLine(line)) {
+        const char* value = std::strchr(line, ':');
+        if (!value) {
+            break;
+        }
+
+        const std::string_view key(line, (size_t)(value - line));
+        if (key == "syscr") {
+            ProcFS::ParseUInt64(value + 1, counters.ReadOps);
+        } else if (key == "syscw") {
+            ProcFS::ParseUInt64(value + 1, counters.WriteOps);
+        } else if (key == "read_bytes") {
+            ProcFS::ParseUInt64(value + 1, counters.ReadBytes);
+        } else if (key == "write_bytes") {
+            ProcFS::ParseUInt64(value + 1, counters.WriteBytes);
+        } else if (key == "cancelled_write_bytes") {
+            ProcFS::ParseUInt64(value + 1, counters.CancelledWriteBytes);
+        }
+    }
+    return true;
+}
+
+#else
+
+bool IoCollector::Sample(const ulong procId, IoCounters& counters)
+{
+    return false;
+}
+
+#endif
+
+}
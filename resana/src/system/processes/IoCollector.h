@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_set>
+
+namespace RESANA {
+
+struct IoCounters {
+    uint64_t ReadBytes {};  // Bytes fetched from storage
+    uint64_t WriteBytes {}; // Bytes sent to storage
+    uint64_t ReadOps {};    // Read syscalls
+    uint64_t WriteOps {};   // Write syscalls
+    uint64_t CancelledWriteBytes {};
+};
+
+struct IoRates {
+    double ReadBytes {};  // Per second
+    double WriteBytes {};
+    double ReadOps {};
+    double WriteOps {};
+};
+
+/*
+ * Reads per-process I/O counters during the process walk. Most processes of
+ * other users can't be read without privileges, so a denial is remembered
+ * until the process exits instead of being retried every tick.
+ */
+class IoCollector {
+    typedef unsigned long ulong;
+
+public:
+    // Returns false if the counters are unavailable (denied or exited)
+    bool Sample(ulong procId, IoCounters& counters);
+
+    // Drops any cached state of an exited process
+    void Forget(ulong procId);
+
+    [[nodiscard]] bool IsDenied(ulong procId) const { return mDenied.count(procId) != 0; }
+
+    static IoRates CalcRates(const IoCounters& previous, const IoCounters& current, double elapsed);
+
+private:
+    std::unordered_set<ulong> mDenied {}; // Only touched from the scan thread
+};
+
+}
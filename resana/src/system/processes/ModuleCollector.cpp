@@ -0,0 +1,225 @@
+#include "ModuleCollector.h"
+#include "rspch.h"
+
+#include "core/Core.h"
+#include "helpers/ProcFS.h"
+
+#if defined(RS_PLATFORM_WINDOWS)
+#include <TlHelp32.h>
+#endif
+
+namespace RESANA {
+
+void ModuleCollector::SetSelected(const ulong procId)
+{
+    std::scoped_lock lock(mMutex);
+    if (mSelected != procId) {
+        mSelected = procId;
+        if (const auto it = mModules.find(procId); it != mModules.end()) {
+            it->second.LastRefresh = {}; // Gather resident sizes right away
+        }
+    }
+}
+
+void ModuleCollector::SetRefreshInterval(const uint32_t interval_ms)
+{
+    std::scoped_lock lock(mMutex);
+    mRefreshInterval = std::chrono::milliseconds(interval_ms);
+}
+
+void ModuleCollector::Refresh(const std::vector<ulong>& procIds, const DetailDemand& demand)
+{
+    std::vector<std::pair<ulong, ModuleList>> due;
+    ulong selected;
+    {
+        std::scoped_lock lock(mMutex);
+        const auto now = Clock::now();
+        selected = mSelected;
+
+        // Forget processes that have exited
+        const std::unordered_set<ulong> running(procIds.begin(), procIds.end());
+        for (auto it = mModules.begin(); it != mModules.end();) {
+            if (running.count(it->first) == 0) {
+                it = mModules.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        // The selected process keeps up with the update interval, the rest are swept
+        // slowly and a few at a time so a first pass doesn't stall the thread. Only
+        // rows that show or sort by their module count are swept at all, as a module
+        // snapshot per process is costly on Windows; the others keep their last count.
+        if (running.count(selected)) {
+            if (const auto& list = mModules[selected]; now - list.LastRefresh >= mRefreshInterval) {
+                due.emplace_back(selected, list);
+            }
+        }
+
+        for (const auto procId : procIds) {
+            if (due.size() >= MAX_READS_PER_SWEEP) {
+                break;
+            }
+            if (procId == selected || !(demand.GetFields(procId) & Detail_Modules)) {
+                continue;
+            }
+            if (const auto& list = mModules[procId]; now - list.LastRefresh >= SWEEP_INTERVAL) {
+                due.emplace_back(procId, list);
+            }
+        }
+    }
+
+    // Read outside the lock, then swap the results in
+    for (auto& [procId, list] : due) {
+        const bool success = ReadModules(procId, list, procId == selected);
+        list.LastRefresh = Clock::now();
+
+        std::scoped_lock lock(mMutex);
+        if (const auto it = mModules.find(procId); it != mModules.end()) {
+            if (!success) {
+                list.Modules.clear(); // Access denied or exited
+            }
+            it->second = std::move(list);
+        }
+    }
+}
+
+std::vector<ModuleEntry> ModuleCollector::GetModules(const ulong procId) const
+{
+    std::scoped_lock lock(mMutex);
+    const auto it = mModules.find(procId);
+    return it != mModules.end() ? it->second.Modules : std::vector<ModuleEntry> {};
+}
+
+uint32_t ModuleCollector::GetModuleCount(const ulong procId) const
+{
+    std::scoped_lock lock(mMutex);
+    const auto it = mModules.find(procId);
+    return it != mModules.end() ? (uint32_t)it->second.Modules.size() : 0;
+}
+
+void ModuleCollector::MarkStrings(StringPool::LiveSet& live) const
+{
+    std::scoped_lock lock(mMutex);
+    for (const auto& [procId, list] : mModules) {
+        for (const auto& module : list.Modules) {
+            live.Mark(module.PathId);
+        }
+    }
+}
+
+#if defined(RS_PLATFORM_WINDOWS)
+
+bool ModuleCollector::ReadModules(const ulong procId, ModuleList& list, const bool resident)
+{
+    // Take a snapshot of all modules in the specified process
+    HANDLE hModuleSnap = CreateToolhelp32Snapshot(TH32CS_SNAPMODULE | TH32CS_SNAPMODULE32, procId);
+    if (hModuleSnap == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    MODULEENTRY32 me32 {};
+    me32.dwSize = sizeof(MODULEENTRY32);
+
+    if (!Module32First(hModuleSnap, &me32)) {
+        CloseHandle(hModuleSnap);
+        return false;
+    }
+
+    std::vector<ModuleEntry> modules;
+    uint64_t checksum = 0;
+    do {
+        const uint64_t base = (uint64_t)(uintptr_t)me32.modBaseAddr;
+        checksum = checksum * 31 + (base ^ me32.modBaseSize);
+        modules.push_back({ StringPool::Get().Intern(me32.szExePath), me32.modBaseSize, 0, 1 });
+    } while (Module32Next(hModuleSnap, &me32));
+
+    CloseHandle(hModuleSnap);
+
+    // Resident sizes per module would need a working set walk, not worth it here
+    if (checksum != list.Checksum) {
+        list.Modules = std::move(modules);
+        list.Checksum = checksum;
+    }
+    list.HasResident = false;
+    return true;
+}
+
+#elif defined(RS_PLATFORM_LINUX)
+
+bool ModuleCollector::ReadModules(const ulong procId, ModuleList& list, const bool resident)
+{
+    // smaps carries per-mapping resident sizes but is much more expensive to
+    // produce, so it is only read for the selected process.
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%lu/%s", procId, resident ? "smaps" : "maps");
+
+    const long length = ProcFS::ReadFile(path, mBuffer);
+    if (length < 0) {
+        return false;
+    }
+
+    // procfs doesn't update mtime when mappings change, so compare contents instead
+    const uint64_t checksum = ProcFS::Checksum(mBuffer.data(), (size_t)length);
+    if (!resident && !list.HasResident && checksum == list.Checksum) {
+        return true; // Unchanged; skip parsing and interning
+    }
+
+    std::vector<ModuleEntry> modules;
+    std::unordered_map<StringPool::Id, size_t> moduleIndex;
+    ModuleEntry* current = nullptr;
+
+    for (const char* line = mBuffer.data(); *line; line = ProcFS::NextLine(line)) {
+        // smaps attribute lines ("Rss:   12 kB") start with an upper case key
+        if (*line >= 'A' && *line <= 'Z') {
+            if (current && std::strncmp(line, "Rss:", 4) == 0) {
+                uint64_t rss;
+                ProcFS::ParseUInt64(line + 4, rss);
+                current->Resident += rss * 1024;
+            }
+            continue;
+        }
+
+        // "start-end perms offset dev inode pathname"
+        char* cursor;
+        const uint64_t start = std::strtoull(line, &cursor, 16);
+        const uint64_t end = (*cursor == '-') ? std::strtoull(cursor + 1, &cursor, 16) : start;
+        const char* name = ProcFS::SkipFields(cursor, 4);
+
+        current = nullptr;
+        if (*name != '/') {
+            continue; // Anonymous, [heap], [stack], [vdso], ...
+        }
+
+        const char* nameEnd = name;
+        while (*nameEnd && *nameEnd != '\n') {
+            ++nameEnd;
+        }
+
+        const StringPool::Id pathId = StringPool::Get().Intern(std::string_view(name, (size_t)(nameEnd - name)));
+        auto [it, inserted] = moduleIndex.try_emplace(pathId, modules.size());
+        if (inserted) {
+            modules.push_back({ pathId, 0, 0, 0 });
+        }
+
+        current = &modules[it->second];
+        current->Size += end - start;
+        current->MappingCount++;
+    }
+
+    list.Modules = std::move(modules);
+    list.Checksum = resident ? 0 : checksum;
+    list.HasResident = resident;
+    return true;
+}
+
+#else
+
+bool ModuleCollector::ReadModules(const ulong procId, ModuleList& list, const bool resident)
+{
+    return false;
+}
+
+#endif
+
+}
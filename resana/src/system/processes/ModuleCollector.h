@@ -0,0 +1,59 @@
+#pragma once
+
+#include "DetailDemand.h"
+#include "helpers/StringPool.h"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace RESANA {
+
+struct ModuleEntry {
+    StringPool::Id PathId {}; // Interned, shared by every process mapping the module
+    uint64_t Size {};         // Total mapped size, in bytes
+    uint64_t Resident {};     // Resident bytes, only gathered for the selected process
+    uint32_t MappingCount {};
+};
+
+class ModuleCollector {
+    typedef unsigned long ulong;
+    typedef std::chrono::steady_clock Clock;
+
+public:
+    void SetSelected(ulong procId);
+    void SetRefreshInterval(uint32_t interval_ms);
+
+    // Sweeps the listed processes the demand asks modules for, forgetting any that are no longer listed
+    void Refresh(const std::vector<ulong>& procIds, const DetailDemand& demand);
+
+    [[nodiscard]] std::vector<ModuleEntry> GetModules(ulong procId) const;
+    [[nodiscard]] uint32_t GetModuleCount(ulong procId) const;
+
+    void MarkStrings(StringPool::LiveSet& live) const;
+
+private:
+    struct ModuleList {
+        std::vector<ModuleEntry> Modules {};
+        uint64_t Checksum {};
+        bool HasResident = false;
+        Clock::time_point LastRefresh {};
+    };
+
+    bool ReadModules(ulong procId, ModuleList& list, bool resident);
+
+private:
+    const std::chrono::milliseconds SWEEP_INTERVAL { 5000 };
+    const size_t MAX_READS_PER_SWEEP = 64;
+
+    mutable std::mutex mMutex {};
+    std::unordered_map<ulong, ModuleList> mModules {};
+
+    std::vector<char> mBuffer {}; // Only used from the collector thread
+    ulong mSelected = (ulong)-1;
+    std::chrono::milliseconds mRefreshInterval { 1000 };
+};
+
+}
@@ -9,6 +9,8 @@ ProcessContainer::ProcessContainer() = default;
 
 ProcessContainer::ProcessContainer(const ProcessContainer* other)
     : mEntries(other->mEntries)
+    , mIndex(other->mIndex)
+    , mTree(other->mTree)
     , mSelectedEntry(other->GetSelectedEntry())
 {
 }
@@ -23,6 +25,12 @@ int ProcessContainer::GetNumEntries() const
     return (int)mEntries.size();
 }
 
+const ProcessTree& ProcessContainer::GetTree() const
+{
+    static const ProcessTree sEmptyTree;
+    return mTree ? *mTree : sEmptyTree;
+}
+
 std::mutex& ProcessContainer::GetMutex()
 {
     return mMutex;
@@ -48,18 +56,14 @@ ProcessEntry* ProcessContainer::FindEntry(const ProcessEntry* entry) const
 
 ProcessEntry* ProcessContainer::FindEntry(uint32_t procId) const
 {
-    for (auto* proc : mEntries) {
-        if (proc->GetProcessId() == procId) {
-            return proc;
-        }
-    }
-
-    return nullptr;
+    const auto it = mIndex.find(procId);
+    return it != mIndex.end() ? it->second : nullptr;
 }
 
 void ProcessContainer::AddEntry(ProcessEntry* entry)
 {
     mEntries.emplace_back(entry);
+    mIndex[entry->GetProcessId()] = entry;
     SetDirty();
 }
 
@@ -104,13 +108,20 @@ void ProcessContainer::EraseEntry(const ProcessEntry* entry)
         return;
     }
 
-    for (auto it = mEntries.begin(); it != mEntries.end(); ++it) {
-        if (auto proc = mEntries.at(reinterpret_cast<std::vector<ProcessEntry*>::size_type>(&it));
-            proc->GetProcessId() == entry->GetProcessId()) {
-            delete proc;
-            proc = nullptr;
-            break;
+    const auto procId = entry->GetProcessId();
+    if (auto* proc = FindEntry(procId)) {
+        if (mSelectedEntry == proc) {
+            mSelectedEntry = nullptr;
         }
+        mEntries.erase(std::remove(mEntries.begin(), mEntries.end(), proc), mEntries.end());
+        mIndex.erase(procId);
+        if (mTree && mTree->Find(procId)) {
+            // Other containers may share the tree, so erase from a copy
+            auto tree = std::make_shared<ProcessTree>(*mTree);
+            tree->Remove(procId);
+            mTree = std::move(tree);
+        }
+        delete proc;
     }
 
     SetDirty();
@@ -122,14 +133,35 @@ void ProcessContainer::Copy(ProcessContainer* other)
         return;
     }
 
-    Clear(mMutex);
-    mSelectedEntry = nullptr;
-
     std::scoped_lock lock1(mMutex);
     std::scoped_lock lock2(other->GetMutex());
 
+    // The previous entries are kept until the copy is done, so rows that didn't
+    // change keep their filter result and only the others are evaluated again
+    std::vector<ProcessEntry*> previous;
+    std::unordered_map<uint32_t, ProcessEntry*> previousIndex;
+    previous.swap(mEntries);
+    previousIndex.swap(mIndex);
+    mChangedEntries.clear();
+    mSelectedEntry = nullptr;
+
+    mEntries.reserve(other->GetEntries().size());
+    mIndex.reserve(other->GetEntries().size());
     for (const auto* entry : other->GetEntries()) {
-        mEntries.emplace_back(new ProcessEntry(entry));
+        auto* copy = new ProcessEntry(entry);
+        if (const auto it = previousIndex.find(copy->GetProcessId()); it != previousIndex.end() && copy->HasSameColumns(it->second)) {
+            copy->SetFilterResult(it->second->mFilterGeneration, it->second->mFilterPassed);
+        }
+        if (copy->mFilterGeneration == 0) {
+            mChangedEntries.emplace_back(copy); // Also catches rows a skipped evaluation left behind
+        }
+        mEntries.emplace_back(copy);
+        mIndex[copy->GetProcessId()] = copy;
+    }
+    mTree = other->mTree;
+
+    for (auto* entry : previous) {
+        delete entry;
     }
 
     SetDirty();
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <memory>
 #include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #include "ProcessEntry.h"
+#include "ProcessTree.h"
 
 namespace RESANA {
 class ProcessEntry;
@@ -18,6 +21,8 @@ public:
     [[nodiscard]] int GetNumEntries() const;
 
     std::vector<ProcessEntry*>& GetEntries();
+    // Entries of the last Copy without a filter result carried over from the copy before
+    [[nodiscard]] const std::vector<ProcessEntry*>& GetChangedEntries() const { return mChangedEntries; }
     [[nodiscard]] ProcessEntry* GetSelectedEntry() const;
     [[nodiscard]] ProcessEntry* FindEntry(const ProcessEntry* entry) const;
     [[nodiscard]] ProcessEntry* FindEntry(uint32_t procId) const;
@@ -28,6 +33,10 @@ public:
     void EraseEntry(const ProcessEntry* entry);
     void Copy(ProcessContainer* other);
 
+    // The tree is never modified once published, so copies of the container share it
+    void SetTree(std::shared_ptr<const ProcessTree> tree) { mTree = std::move(tree); }
+    [[nodiscard]] const ProcessTree& GetTree() const;
+
     void SetClean() { mDirty = false; }
     void SetDirty() { mDirty = true; }
     bool IsDirty() const { return mDirty; }
@@ -38,6 +47,9 @@ public:
 private:
     std::mutex mMutex {};
     std::vector<ProcessEntry*> mEntries {};
+    std::unordered_map<uint32_t, ProcessEntry*> mIndex {};
+    std::vector<ProcessEntry*> mChangedEntries {};
+    std::shared_ptr<const ProcessTree> mTree {};
     bool mDirty = false;
 
     ProcessEntry* mSelectedEntry = nullptr;
@@ -53,6 +65,9 @@ void ProcessContainer::Clear(_MutTy& mutex)
     }
 
     mEntries.clear();
+    mIndex.clear();
+    mChangedEntries.clear();
+    mTree.reset();
 }
 
 }
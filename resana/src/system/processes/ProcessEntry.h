@@ -1,11 +1,14 @@
 #pragma once
 
 #include "ProcessContainer.h"
+#include "ProcessTree.h"
+#include "IoCollector.h"
+#include "FdCollector.h"
+#include "ProcessWalker.h"
+#include "helpers/StringPool.h"
 
 #include <mutex>
-#include <string>
-
-#include <TlHelp32.h>
+#include <string_view>
 
 namespace RESANA {
 
@@ -13,46 +16,63 @@ class ProcessEntry {
     typedef unsigned long ulong;
 
     struct Process {
-        std::string Name {};
+        StringPool::Id Name {};
+        StringPool::Id CommandLine {};
+        StringPool::Id Cgroup {}; // Path in the unified hierarchy, Linux only
         ulong ProcessId {};
         ulong ParentProcessId {};
-        ulong ModuleId {};
-        ulong MemoryUsage {};
+        ulong ModuleCount {};
+        uint64_t MemoryUsage {}; // Working set, in bytes
         ulong ThreadCount {};
-        ulong PriorityClass {};
+        long PriorityClass {};
         ulong Flags {};
-
-        explicit Process(const PROCESSENTRY32& pe32)
+        uint64_t CpuTime {}; // Kernel + user time, in 100ns units
+        double CpuLoad {};
+        IoCounters Io {};
+        IoRates IoRate {};
+        bool HasIo = false; // Io holds a valid sample
+        uint64_t IoTime {}; // When Io was sampled; only kept by the scan
+        FdStats Fd {};
+        bool HasFd = false;
+
+        explicit Process(const ProcessRecord& record)
         {
-            Name.assign(pe32.szExeFile);
-            ProcessId = pe32.th32ProcessID;
-            ParentProcessId = pe32.th32ParentProcessID;
-            ModuleId = pe32.th32ModuleID;
-            MemoryUsage = pe32.cntUsage;
-            ThreadCount = pe32.cntThreads;
-            PriorityClass = pe32.pcPriClassBase;
-            Flags = pe32.dwFlags;
+            Name = StringPool::Get().Intern(record.Name);
+            ProcessId = record.ProcessId;
+            ParentProcessId = record.ParentProcessId;
+            ThreadCount = record.ThreadCount;
+            PriorityClass = record.PriorityClass;
+            Flags = record.Flags;
         }
 
         explicit Process(const ProcessEntry* other)
         {
-            Name.assign(other->GetName());
+            Name = other->GetNameId();
+            CommandLine = other->GetCommandLineId();
+            Cgroup = other->GetCgroupId();
             ProcessId = other->GetProcessId();
             ParentProcessId = other->GetParentProcessId();
-            ModuleId = other->GetModuleId();
+            ModuleCount = other->GetModuleCount();
             MemoryUsage = other->GetMemoryUsage();
             ThreadCount = other->GetThreadCount();
             PriorityClass = other->GetPriorityClass();
             Flags = other->GetFlags();
+            CpuTime = other->GetCpuTime();
+            CpuLoad = other->GetCpuLoad();
+            Io = other->GetIoCounters();
+            IoRate = other->GetIoRates();
+            HasIo = other->HasIoCounters();
+            Fd = other->GetFdStats();
+            HasFd = other->HasFdStats();
         }
     };
 
 public:
-    explicit ProcessEntry(const PROCESSENTRY32& pe32)
-        : mProcess(pe32)
+    explicit ProcessEntry(const ProcessRecord& record)
+        : mProcess(record)
         , mLock(mMutex, std::defer_lock)
     {
-        this->operator=(pe32);
+        this->operator=(record);
     }
 
     explicit ProcessEntry(const ProcessEntry* entry)
@@ -68,14 +88,50 @@ public:
         std::scoped_lock lock(mMutex);
     }
 
-    [[nodiscard]] ulong GetMemoryUsage() const { return mProcess.MemoryUsage; }
+    [[nodiscard]] uint64_t GetMemoryUsage() const { return mProcess.MemoryUsage; }
     [[nodiscard]] ulong GetProcessId() const { return mProcess.ProcessId; }
-    [[nodiscard]] ulong GetModuleId() const { return mProcess.ModuleId; }
+    [[nodiscard]] ulong GetModuleCount() const { return mProcess.ModuleCount; }
     [[nodiscard]] ulong GetThreadCount() const { return mProcess.ThreadCount; }
     [[nodiscard]] ulong GetParentProcessId() const { return mProcess.ParentProcessId; }
     [[nodiscard]] ulong GetFlags() const { return mProcess.Flags; }
-    [[nodiscard]] std::string GetName() const { return mProcess.Name; }
-    [[nodiscard]] ulong GetPriorityClass() const { return mProcess.PriorityClass; }
+    [[nodiscard]] const char* GetName() const { return StringPool::Get().CStr(mProcess.Name); }
+    [[nodiscard]] const char* GetCommandLine() const { return StringPool::Get().CStr(mProcess.CommandLine); }
+    [[nodiscard]] StringPool::Id GetNameId() const { return mProcess.Name; }
+    [[nodiscard]] StringPool::Id GetCommandLineId() const { return mProcess.CommandLine; }
+    [[nodiscard]] StringPool::Id GetCgroupId() const { return mProcess.Cgroup; }
+    [[nodiscard]] long GetPriorityClass() const { return mProcess.PriorityClass; }
+    [[nodiscard]] uint64_t GetCpuTime() const { return mProcess.CpuTime; }
+    [[nodiscard]] double GetCpuLoad() const { return mProcess.CpuLoad; }
+    [[nodiscard]] const IoCounters& GetIoCounters() const { return mProcess.Io; }
+    [[nodiscard]] const IoRates& GetIoRates() const { return mProcess.IoRate; }
+    [[nodiscard]] bool HasIoCounters() const { return mProcess.HasIo; }
+    [[nodiscard]] const FdStats& GetFdStats() const { return mProcess.Fd; }
+    [[nodiscard]] bool HasFdStats() const { return mProcess.HasFd; }
+
+    [[nodiscard]] ProcessTotals GetTotals() const
+    {
+        return { mProcess.CpuLoad, mProcess.MemoryUsage, mProcess.ThreadCount };
+    }
+
+    // Every column shows the same value, so results derived from the row still hold
+    [[nodiscard]] bool HasSameColumns(const ProcessEntry* other) const
+    {
+        const auto& a = mProcess;
+        const auto& b = other->mProcess;
+        return a.Name == b.Name && a.CommandLine == b.CommandLine && a.ProcessId == b.ProcessId &&
+            a.ParentProcessId == b.ParentProcessId && a.ModuleCount == b.ModuleCount && a.MemoryUsage == b.MemoryUsage &&
+            a.ThreadCount == b.ThreadCount && a.PriorityClass == b.PriorityClass && a.CpuLoad == b.CpuLoad &&
+            a.IoRate.ReadBytes == b.IoRate.ReadBytes && a.IoRate.WriteBytes == b.IoRate.WriteBytes && a.Fd.Count == b.Fd.Count;
+    }
+
+    // Result of the panel's filter, valid while the filter is at the same generation
+    [[nodiscard]] bool PassesFilter(const uint32_t generation) const { return mFilterGeneration == generation && mFilterPassed; }
+    [[nodiscard]] uint32_t GetFilterGeneration() const { return mFilterGeneration; }
+    void SetFilterResult(const uint32_t generation, const bool passed)
+    {
+        mFilterGeneration = generation;
+        mFilterPassed = passed;
+    }
 
     void Free() { this->~ProcessEntry(); }
 
@@ -86,56 +142,66 @@ public:
     // Overloads
     ProcessEntry& operator=(const ProcessEntry* entry)
     {
-        mProcess.Name.assign(entry->GetName());
+        mProcess.Name = entry->GetNameId();
+        mProcess.CommandLine = entry->GetCommandLineId();
+        mProcess.Cgroup = entry->GetCgroupId();
         mProcess.ProcessId = entry->GetProcessId();
         mProcess.ParentProcessId = entry->GetParentProcessId();
-        mProcess.ModuleId = entry->GetModuleId();
+        mProcess.ModuleCount = entry->GetModuleCount();
         mProcess.MemoryUsage = entry->GetMemoryUsage();
         mProcess.ThreadCount = entry->GetThreadCount();
         mProcess.PriorityClass = entry->GetPriorityClass();
         mProcess.Flags = entry->GetFlags();
+        mProcess.CpuTime = entry->GetCpuTime();
+        mProcess.CpuLoad = entry->GetCpuLoad();
+        mProcess.Io = entry->GetIoCounters();
+        mProcess.IoRate = entry->GetIoRates();
+        mProcess.HasIo = entry->HasIoCounters();
+        mProcess.Fd = entry->GetFdStats();
+        mProcess.HasFd = entry->HasFdStats();
         mSelected = entry->IsSelected();
         return *this;
     }
 
-    ProcessEntry& operator=(const PROCESSENTRY32& pe32)
+    ProcessEntry& operator=(const ProcessRecord& record)
     {
-        mProcess.Name.assign(pe32.szExeFile);
-        mProcess.ProcessId = pe32.th32ProcessID;
-        mProcess.ParentProcessId = pe32.th32ParentProcessID;
-        mProcess.ModuleId = pe32.th32ModuleID;
-        mProcess.MemoryUsage = pe32.cntUsage;
-        mProcess.ThreadCount = pe32.cntThreads;
-        mProcess.PriorityClass = pe32.pcPriClassBase;
-        mProcess.Flags = pe32.dwFlags;
+        if (!HasName(record.Name)) {
+            mProcess.Name = StringPool::Get().Intern(record.Name);
+        }
+        mProcess.ProcessId = record.ProcessId;
+        mProcess.ParentProcessId = record.ParentProcessId;
+        mProcess.ThreadCount = record.ThreadCount;
+        mProcess.PriorityClass = record.PriorityClass;
+        mProcess.Flags = record.Flags;
         return *this;
     }
 
-    bool operator==(const PROCESSENTRY32 pe32) const
+    bool operator==(const ProcessRecord& record) const
     {
-    	return mProcess.Name == pe32.szExeFile ||
-			mProcess.ProcessId == pe32.th32ProcessID ||
-			mProcess.ParentProcessId == pe32.th32ParentProcessID ||
-			mProcess.ModuleId == pe32.th32ModuleID ||
-			mProcess.MemoryUsage == pe32.cntUsage ||
-			mProcess.ThreadCount == pe32.cntThreads ||
-			mProcess.PriorityClass == pe32.pcPriClassBase ||
-			mProcess.Flags == pe32.dwFlags;
+    	return HasName(record.Name) ||
+			mProcess.ProcessId == record.ProcessId ||
+			mProcess.ParentProcessId == record.ParentProcessId ||
+			mProcess.ThreadCount == record.ThreadCount ||
+			mProcess.PriorityClass == record.PriorityClass ||
+			mProcess.Flags == record.Flags;
     }
 
-    bool operator!=(const PROCESSENTRY32& pe32) const
+    bool operator!=(const ProcessRecord& record) const
     {
-    	return mProcess.Name != pe32.szExeFile ||
-			mProcess.ProcessId != pe32.th32ProcessID ||
-			mProcess.ParentProcessId != pe32.th32ParentProcessID ||
-			mProcess.ModuleId != pe32.th32ModuleID ||
-			mProcess.MemoryUsage != pe32.cntUsage ||
-			mProcess.ThreadCount != pe32.cntThreads ||
-			mProcess.PriorityClass != pe32.pcPriClassBase ||
-			mProcess.Flags != pe32.dwFlags;
+    	return !HasName(record.Name) ||
+			mProcess.ProcessId != record.ProcessId ||
+			mProcess.ParentProcessId != record.ParentProcessId ||
+			mProcess.ThreadCount != record.ThreadCount ||
+			mProcess.PriorityClass != record.PriorityClass ||
+			mProcess.Flags != record.Flags;
     }
 
 private:
+    [[nodiscard]] bool HasName(const std::string_view name) const
+    {
+        return StringPool::Get().View(mProcess.Name) == name;
+    }
+
     void Select() { mSelected = true; }
     void Deselect() { mSelected = false; }
 
@@ -145,6 +211,8 @@ private:
     std::unique_lock<std::mutex> mLock {};
     bool mRunning = true;
     bool mSelected = false;
+    uint32_t mFilterGeneration = 0; // Never evaluated
+    bool mFilterPassed = false;
 
     friend class ProcessManager;
     friend class ProcessContainer;
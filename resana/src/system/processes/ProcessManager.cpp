@@ -3,14 +3,7 @@
 
 #include "core/Core.h"
 
-#include "helpers/FileUtils.h"
-#include "helpers/WinFuncs.h"
-
-#include <ProcessSnapshot.h>
-#include <TlHelp32.h>
-#include <Windows.h>
-
-#include "core/Application.h"
+#include "system/SelfProfiler.h"
 
 namespace RESANA {
 
@@ -19,16 +12,16 @@ ProcessManager* ProcessManager::sInstance = nullptr;
 ProcessManager::ProcessManager()
     : ConcurrentProcess("ProcessManager")
     , mUpdateInterval(TimeTick::Rate::Normal)
+    , mNumProcessors(std::max(1u, std::thread::hardware_concurrency()))
     , mDataReady(false)
     , mDataBusy(false)
 {
     mProcessContainer.reset(new ProcessContainer);
+    mThreadCollector.SetRefreshInterval(mUpdateInterval);
 }
 
 ProcessManager::~ProcessManager()
 {
-    Time::Sleep(mUpdateInterval); // Let detached threads finish before
-
     std::mutex mutex;
     std::unique_lock<std::mutex> lock(mutex);
 
@@ -38,12 +31,6 @@ ProcessManager::~ProcessManager()
     }
 }
 
-void ProcessManager::Destroy() const
-{
-    sInstance = nullptr;
-    delete this;
-}
-
 ProcessManager* ProcessManager::Get()
 {
     if (!sInstance) {
@@ -74,9 +61,70 @@ void ProcessManager::ReleaseData()
     lc.NotifyAll();
 }
 
+void ProcessManager::WatchThreads(const std::vector<unsigned long>& procIds)
+{
+    mThreadCollector.Watch(procIds);
+}
+
+std::vector<ThreadEntry> ProcessManager::GetThreads(const unsigned long procId) const
+{
+    return mThreadCollector.GetThreads(procId);
+}
+
+void ProcessManager::SelectProcess(const unsigned long procId)
+{
+    mModuleCollector.SetSelected(procId);
+    mFdCollector.SetSelected(procId);
+    mSelectedId = procId;
+}
+
+std::vector<ModuleEntry> ProcessManager::GetModules(const unsigned long procId) const
+{
+    return mModuleCollector.GetModules(procId);
+}
+
+bool ProcessManager::GetFdBreakdown(const unsigned long procId, FdBreakdown& breakdown) const
+{
+    return mFdCollector.GetBreakdown(procId, breakdown);
+}
+
+void ProcessManager::SetDetailDemand(DetailDemand demand)
+{
+    std::scoped_lock lock(mDemandMutex);
+    mDetailDemand = std::move(demand);
+}
+
+bool ProcessManager::SetExitCapture(const bool enable)
+{
+    return mExitCollector.SetCapture(enable);
+}
+
+bool ProcessManager::IsCapturingExits() const
+{
+    return mExitCollector.IsCapturing();
+}
+
+std::vector<ExitedGroup> ProcessManager::GetExitedGroups() const
+{
+    return mExitCollector.GetGroups();
+}
+
+std::vector<CgroupStats> ProcessManager::GetCgroups() const
+{
+    return mCgroupCollector.GetCgroups();
+}
+
+std::vector<TopEntry> ProcessManager::GetTopConsumers(const TopMetric metric, const size_t k) const
+{
+    return mTopConsumers.Get(metric, k);
+}
+
 void ProcessManager::SetUpdateInterval(Timestep interval)
 {
     mUpdateInterval = interval;
+    mScanScheduler.SetBaseInterval(mUpdateInterval);
+    mThreadCollector.SetRefreshInterval(mUpdateInterval);
+    mModuleCollector.SetRefreshInterval(mUpdateInterval);
 }
 
 uint32_t ProcessManager::GetUpdateSpeed() const
@@ -84,6 +132,16 @@ uint32_t ProcessManager::GetUpdateSpeed() const
     return mUpdateInterval;
 }
 
+void ProcessManager::SetScanBounds(const uint32_t min_ms, const uint32_t max_ms)
+{
+    mScanScheduler.SetBounds(min_ms, max_ms);
+}
+
+ScanStats ProcessManager::GetScanStats() const
+{
+    return mScanScheduler.GetStats();
+}
+
 bool ProcessManager::IsRunning() const
 {
     return mRunning;
@@ -103,11 +161,11 @@ void ProcessManager::Run()
     if (!sInstance->IsRunning()) {
         sInstance->mRunning = true;
 
-        auto& app = Application::Get();
-        auto& threadPool = app.GetThreadPool();
-
-        threadPool.Queue([&] { sInstance->PrepareDataThread(); });
-        threadPool.Queue([&] { sInstance->ProcessDataThread(); });
+        // Each loop runs for as long as the manager, so none of them takes a pool worker
+        auto* manager = sInstance;
+        manager->mScanThread.Start([manager] { manager->PrepareDataThread(); });
+        manager->mPublishThread.Start([manager] { manager->ProcessDataThread(); });
+        manager->mDetailThread.Start([manager] { manager->DetailDataThread(); });
     }
 }
 
@@ -117,6 +175,11 @@ void ProcessManager::Stop()
         sInstance->mRunning = false;
         auto& lc = sInstance->GetLockContainer();
         lc.NotifyAll();
+
+        // Returns once the loops are done, so a quick Run can't start a second set
+        sInstance->mScanThread.Stop();
+        sInstance->mPublishThread.Stop();
+        sInstance->mDetailThread.Stop();
     }
 }
 
@@ -124,10 +187,7 @@ void ProcessManager::Shutdown()
 {
     if (sInstance) {
         Stop();
-
-        auto& app = Application::Get();
-        auto& threadPool = app.GetThreadPool();
-        threadPool.Queue([&]() { sInstance->Destroy(); });
+        delete sInstance;
         sInstance = nullptr;
     }
 }
@@ -137,113 +197,147 @@ void ProcessManager::PrepareDataThread()
     auto& lc = GetLockContainer();
 
     while (IsRunning()) {
+        SelfProfiler::Scope scope(Subsystem_Processes);
         if (PrepareData()) {
             // Notify waiting threads
             mDataPrepared = true;
             lc.NotifyAll();
         }
-        Time::Sleep(mUpdateInterval);
+        mScanThread.Sleep(mScanScheduler.GetInterval());
     }
 }
 
 void ProcessManager::ProcessDataThread()
 {
     while (IsRunning()) {
+        SelfProfiler::Scope scope(Subsystem_Processes);
         auto* data = GetPreparedData();
         SetData(data);
     }
 }
 
-bool ProcessManager::PrepareData()
+void ProcessManager::DetailDataThread()
 {
-    HANDLE hProcessSnap {};
-    PROCESSENTRY32 processEntry {};
-    processEntry.dwSize = sizeof(PROCESSENTRY32);
-
-    bool error = false;
-    bool snapshotReady = false;
-    bool processDone = false;
-    bool walkingDone = false;
-
-    auto& app = Application::Get();
-    auto& threadPool = app.GetThreadPool();
-
-    threadPool.Queue([&] {
-        snapshotReady = false;
-        // Take a snapshot of all processes in the system.
-        hProcessSnap = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-        if (hProcessSnap == INVALID_HANDLE_VALUE) {
-            PrintWin32Error("CreateToolhelp32Snapshot (of processes)");
-            error = true;
+    std::vector<unsigned long> procIds;
+    DetailDemand demand;
+    auto lastModulePoll = std::chrono::steady_clock::time_point {};
+
+    // Newly watched processes are picked up within one poll, but each
+    // process is only re-read once per update interval.
+    do {
+        SelfProfiler::Scope scope(Subsystem_ProcessDetails);
+        mThreadCollector.Refresh();
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now - lastModulePoll >= std::chrono::milliseconds(MODULE_POLL_INTERVAL)) {
+            lastModulePoll = now;
+            procIds.clear();
+            {
+                std::lock_guard lock(mProcessMap.GetMutex());
+                for (const auto& [id, entry] : mProcessMap) {
+                    procIds.emplace_back(id);
+                }
+            }
+            {
+                std::scoped_lock lock(mDemandMutex);
+                demand = mDetailDemand;
+            }
+            mModuleCollector.Refresh(procIds, demand);
         }
-        snapshotReady = true;
-    });
+    } while (IsRunning() && mDetailThread.Sleep(THREAD_POLL_INTERVAL));
+}
 
-    while (!snapshotReady) {
-        Time::Sleep(1);
-        if (error || !IsRunning()) {
-            return false;
-        }
+bool ProcessManager::PrepareData()
+{
+    typedef std::chrono::steady_clock Clock;
+    std::chrono::duration<double, std::milli> snapshotCost {}, walkCost {}, expensiveCost {};
+    uint32_t added = 0;
+
+    // Expensive per-process fields keep to the base interval, and only where they're needed
+    const bool expensive = mScanScheduler.IsExpensiveDue();
+    DetailDemand demand;
+    {
+        std::scoped_lock lock(mDemandMutex);
+        demand = mDetailDemand;
     }
+    const unsigned long selectedId = mSelectedId;
 
-    threadPool.Queue([&] {
-        processDone = false;
-        if (!Process32First(hProcessSnap, &processEntry)) {
-            PrintWin32Error("Process32First");
-            CloseHandle(hProcessSnap); // clean the snapshot object
-            error = true;
-        }
-        processDone = true;
-    });
+    const auto snapshotStart = Clock::now();
+    if (!mProcessWalker.Begin()) {
+        return false;
+    }
+    snapshotCost = Clock::now() - snapshotStart;
 
     ResetAllRunningStatus();
 
-    // Now walk the snapshot of processes, and
-    // get information about each process in turn
+    // Time elapsed since the last walk, used for per-process CPU load
+    const uint64_t now = ProcessWalker::GetTime();
+    const uint64_t elapsed = mLastScanTime ? now - mLastScanTime : 0;
+    mLastScanTime = now;
+
+    // Now walk the processes, and get information about each process in turn
+    const auto walkStart = Clock::now();
+    ProcessRecord record;
+    while (IsRunning() && mProcessWalker.Next(record)) {
+        std::lock_guard lock(mProcessMap.GetMutex());
+
+        // Set process running status to true and
+        //	update process, if applicable
+        if (!UpdateProcess(record)) {
+            // Otherwise, add new process
+            mProcessMap.Emplace(new ProcessEntry(record));
+            mExitCollector.OnStart(record.ProcessId);
+            added++;
+        }
 
-    while (!processDone) {
-        Time::Sleep(1);
-        if (error || !IsRunning()) {
-            return false;
+        auto* proc = mProcessMap.Find(record.ProcessId);
+        const uint32_t fields = (proc->GetProcessId() == selectedId) ? ~0u : demand.GetFields(proc->GetProcessId());
+        const auto counterStart = Clock::now();
+        UpdateProcessCounters(proc, record, now, elapsed, expensive, fields);
+        if (fields != Detail_None) {
+            expensiveCost += Clock::now() - counterStart;
         }
-    }
 
-    threadPool.Queue([&, this] {
-        walkingDone = false;
-        do {
-            {
-                std::lock_guard lock2(mProcessMap.GetMutex());
+        // Only the path from this process to its root is touched
+        mProcessTree.Update(proc->GetProcessId(), proc->GetParentProcessId(), proc->GetTotals());
+        mSearchIndex.Set(proc->GetProcessId(), proc->GetNameId(), proc->GetCommandLineId());
+        mTopConsumers.Set(proc->GetProcessId(), { proc->GetCpuLoad(), (double)proc->GetMemoryUsage(),
+                                                    proc->GetIoRates().ReadBytes, proc->GetIoRates().WriteBytes });
 
-                // Set process running status to true and
-                //	update process, if applicable
-                if (!UpdateProcess(processEntry)) {
-                    // Otherwise, add new process
-                    mProcessMap.Emplace(new ProcessEntry(processEntry));
-                }
-            }
+        // Threads and modules are listed by their collectors
+    }
+    mProcessWalker.End();
+    walkCost = Clock::now() - walkStart;
 
-            /* TODO: Implement these features
-            // List the modules and threads associated with this process
-            ListProcessModules(procEntry.th32ProcessID);
-            ListProcessThreads(procEntry.th32ProcessID);
-            */
+    // A walk cut short would make the processes not yet seen look exited
+    if (!IsRunning()) {
+        return false;
+    }
 
-        } while (Process32Next(hProcessSnap, &processEntry));
+    // Parents still awaited weren't listed, so they exited before the walk
+    mProcessTree.ForgetOrphans();
 
-        walkingDone = true;
+    // Remove any processes not currently running
+    const auto cleanStart = Clock::now();
+    const uint32_t removed = CleanMap();
+    const std::chrono::duration<double, std::milli> cleanCost = Clock::now() - cleanStart;
+    mExitCollector.OnScanned(snapshotStart);
+
+    if (cleanStart - mLastCompact >= STRING_COMPACT_INTERVAL) {
+        mLastCompact = cleanStart;
+        CompactStrings();
+    }
 
-        CloseHandle(hProcessSnap);
-    });
+    const double cheapCost = (snapshotCost + walkCost + cleanCost - expensiveCost).count();
 
-    while (!walkingDone) {
-        Time::Sleep(1);
-        if (error || !IsRunning()) {
-            return false;
-        }
+    // Cgroup totals only when grouping by them
+    if (expensive && (demand.AllFields & Detail_Cgroup)) {
+        const auto cgroupStart = Clock::now();
+        mCgroupCollector.Refresh();
+        expensiveCost += Clock::now() - cgroupStart;
     }
 
-    // Remove any processes not currently running
-    CleanMap();
+    mScanScheduler.OnScan((uint32_t)mProcessMap.Size(), added, removed, cheapCost, expensiveCost.count(), expensive);
 
     return true;
 }
@@ -253,12 +347,13 @@ ProcessContainer* ProcessManager::GetPreparedData()
     std::mutex mutex;
     std::unique_lock<std::mutex> lock(mutex);
 
+    // Bounded, as the notify of a Stop can fall between the check and the wait
     auto& lc = GetLockContainer();
     while (!mDataPrepared) {
         if (!IsRunning()) {
             return nullptr;
         }
-        lc.Wait(lock);
+        lc.WaitFor(lock, std::chrono::milliseconds(THREAD_POLL_INTERVAL));
     }
 
     ProcessContainer* data = nullptr;
@@ -274,6 +369,7 @@ ProcessContainer* ProcessManager::GetPreparedData()
             auto* copy = new ProcessEntry(entry);
             data->AddEntry(copy);
         }
+        data->SetTree(std::make_shared<const ProcessTree>(mProcessTree));
     }
     // Unset the flag
     mDataPrepared = false;
@@ -294,9 +390,10 @@ void ProcessManager::SetData(ProcessContainer* data)
 
     while (mDataBusy) {
         if (!IsRunning()) {
+            delete data;
             return;
         }
-        lc.Wait(lock);
+        lc.WaitFor(lock, std::chrono::milliseconds(THREAD_POLL_INTERVAL));
     }
     lock.unlock();
 
@@ -336,17 +433,17 @@ bool ProcessManager::UpdateProcess(const ProcessEntry* entry) const
     return false;
 }
 
-bool ProcessManager::UpdateProcess(const PROCESSENTRY32& pe32) const
+bool ProcessManager::UpdateProcess(const ProcessRecord& record) const
 {
-    if (const auto& proc = mProcessMap.Find(pe32.th32ProcessID)) {
+    if (const auto& proc = mProcessMap.Find(record.ProcessId)) {
         std::mutex mutex;
         std::lock(mutex, proc->Mutex());
         {
             std::lock_guard lock(mutex, std::adopt_lock);
             std::lock_guard lock2(proc->Mutex(), std::adopt_lock);
 
-            if (proc->operator!=(pe32)) { // Don't update if there's no change
-                proc->operator=(pe32);
+            if (proc->operator!=(record)) { // Don't update if there's no change
+                proc->operator=(record);
             }
 
             proc->Running() = true;
@@ -357,8 +454,109 @@ bool ProcessManager::UpdateProcess(const PROCESSENTRY32& pe32) const
     return false;
 }
 
-void ProcessManager::CleanMap()
+void ProcessManager::UpdateProcessCounters(ProcessEntry* entry, const ProcessRecord& record, const uint64_t now, const uint64_t elapsed, const bool expensive, const uint32_t fields)
+{
+    if (!entry) {
+        return;
+    }
+
+    // Demanded fields are refreshed at the base interval, or straight away if never read.
+    // Denials are cached by the collectors, so retrying those costs nothing.
+    if ((fields & Detail_Io) && (expensive || !entry->HasIoCounters())) {
+        UpdateIoCounters(entry, now);
+    }
+
+    // A process rarely changes cgroup, so it is only looked up once
+    if ((fields & Detail_Cgroup) && entry->GetCgroupId() == StringPool::Empty) {
+        const StringPool::Id cgroup = mCgroupCollector.Resolve(entry->GetProcessId());
+
+        std::scoped_lock lock(entry->Mutex());
+        entry->mProcess.Cgroup = cgroup;
+    }
+
+    // Not held to the expensive interval; the collector spaces out samples of each process itself
+    if (fields & Detail_Fd) {
+        FdStats fdStats;
+        const bool hasFd = mFdCollector.Sample(entry->GetProcessId(), fdStats);
+
+        std::scoped_lock lock(entry->Mutex());
+        entry->mProcess.Fd = fdStats;
+        entry->mProcess.HasFd = hasFd;
+    }
+
+    {
+        std::scoped_lock lock(entry->Mutex());
+        entry->mProcess.ModuleCount = mModuleCollector.GetModuleCount(entry->GetProcessId());
+    }
+
+    // Only the scan thread writes entries, so reading without the lock is fine
+    const bool needsCommandLine = (fields & Detail_CommandLine) && entry->GetCommandLineId() == StringPool::Empty;
+
+    ProcessUsage usage;
+    if (!mProcessWalker.ReadUsage(record, needsCommandLine, usage)) {
+        return; // Protected and system processes deny access
+    }
+
+    std::scoped_lock lock(entry->Mutex());
+    auto& process = entry->mProcess;
+    if (usage.CommandLine != StringPool::Empty) {
+        process.CommandLine = usage.CommandLine;
+    }
+
+    // The first sample of a process has nothing to compare against
+    if (process.CpuTime && elapsed && usage.CpuTime >= process.CpuTime) {
+        process.CpuLoad = (double)(usage.CpuTime - process.CpuTime) / (double)elapsed / mNumProcessors * 100.0;
+    }
+    process.CpuTime = usage.CpuTime;
+    process.MemoryUsage = usage.MemoryUsage;
+}
+
+void ProcessManager::UpdateIoCounters(ProcessEntry* entry, const uint64_t now)
 {
+    IoCounters counters;
+    const bool success = mIoCollector.Sample(entry->GetProcessId(), counters);
+
+    std::scoped_lock lock(entry->Mutex());
+    auto& process = entry->mProcess;
+    if (!success) {
+        process.HasIo = false;
+        process.IoRate = {};
+        return;
+    }
+
+    // The first sample of a process has nothing to compare against
+    if (process.HasIo && now > process.IoTime) {
+        process.IoRate = IoCollector::CalcRates(process.Io, counters, (double)(now - process.IoTime) / 1.0e7);
+    }
+    process.Io = counters;
+    process.IoTime = now;
+    process.HasIo = true;
+}
+
+void ProcessManager::CompactStrings()
+{
+    auto& pool = StringPool::Get();
+    auto live = pool.BeginCompact();
+    {
+        std::lock_guard lock(mProcessMap.GetMutex());
+        for (const auto& [id, entry] : mProcessMap) {
+            live.Mark(entry->GetNameId());
+            live.Mark(entry->GetCommandLineId());
+            live.Mark(entry->GetCgroupId());
+        }
+    }
+    mThreadCollector.MarkStrings(live);
+    mModuleCollector.MarkStrings(live);
+    mExitCollector.MarkStrings(live);
+    mCgroupCollector.MarkStrings(live);
+
+    pool.Compact(live);
+}
+
+uint32_t ProcessManager::CleanMap()
+{
+    uint32_t removed = 0;
+
     std::mutex mutex;
     std::lock(mutex, mProcessMap.GetMutex());
     {
@@ -368,11 +566,21 @@ void ProcessManager::CleanMap()
         // Remove any processes not currently running
         for (auto it = mProcessMap.begin(); it != mProcessMap.end(); ++it) {
             if (!it->second->Running()) {
+                const auto* entry = it->second;
+                mExitCollector.OnExit(it->first, entry->GetNameId(), entry->GetCpuTime(), entry->GetMemoryUsage());
+                mProcessTree.Remove(it->first);
+                mIoCollector.Forget(it->first);
+                mFdCollector.Forget(it->first);
+                mCgroupCollector.Forget(it->first);
+                mTopConsumers.Remove(it->first);
+                mSearchIndex.Remove(it->first);
                 mProcessMap.Erase(it->second);
                 it = mProcessMap.begin(); // Reset iterator!
+                removed++;
             }
         }
     }
+    return removed;
 }
 
 void ProcessManager::ResetAllRunningStatus()
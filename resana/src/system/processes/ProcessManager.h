@@ -1,10 +1,23 @@
 #pragma once
 
 #include "system/base/ConcurrentProcess.h"
+#include "system/ServiceThread.h"
 
 #include "ProcessMap.h"
 #include "ProcessEntry.h"
 #include "ProcessContainer.h"
+#include "ProcessTree.h"
+#include "ProcessWalker.h"
+#include "ThreadCollector.h"
+#include "ModuleCollector.h"
+#include "IoCollector.h"
+#include "FdCollector.h"
+#include "SearchIndex.h"
+#include "ScanScheduler.h"
+#include "DetailDemand.h"
+#include "ExitCollector.h"
+#include "CgroupCollector.h"
+#include "TopConsumers.h"
 
 #include "helpers/Time.h"
 
@@ -25,39 +38,102 @@ namespace RESANA {
 
 		void ReleaseData();
 
+		// Threads are only enumerated for watched processes
+		void WatchThreads(const std::vector<unsigned long>& procIds);
+		[[nodiscard]] std::vector<ThreadEntry> GetThreads(unsigned long procId) const;
+
+		// Modules are swept for every process, resident sizes only for the selected one
+		void SelectProcess(unsigned long procId);
+		[[nodiscard]] std::vector<ModuleEntry> GetModules(unsigned long procId) const;
+		bool GetFdBreakdown(unsigned long procId, FdBreakdown& breakdown) const;
+
+		// Kept up to date by the process walk
+		SearchIndex& GetSearchIndex() { return mSearchIndex; }
+
+		// Expensive fields are only read where the table needs them; the selected process gets them all
+		void SetDetailDemand(DetailDemand demand);
+
+		// Exited processes by executable; capture also catches those that never lived through a scan
+		bool SetExitCapture(bool enable);
+		[[nodiscard]] bool IsCapturingExits() const;
+		[[nodiscard]] std::vector<ExitedGroup> GetExitedGroups() const;
+
+		// Read while some view demands Detail_Cgroup for every process
+		[[nodiscard]] bool HasCgroups() const { return mCgroupCollector.IsAvailable(); }
+		[[nodiscard]] std::vector<CgroupStats> GetCgroups() const;
+
+		// Ranked as the scan goes, so reading them never sorts the whole table
+		[[nodiscard]] std::vector<TopEntry> GetTopConsumers(TopMetric metric, size_t k) const;
+
 		void SetUpdateInterval(Timestep interval = TimeTick::Rate::Normal);
 		uint32_t GetUpdateSpeed() const;
 
+		// The scan interval adapts around the update interval, within these bounds
+		void SetScanBounds(uint32_t min_ms, uint32_t max_ms);
+		[[nodiscard]] ScanStats GetScanStats() const;
+
 		bool IsRunning() const;
 
 	private:
 		ProcessManager();
 		~ProcessManager() override;
 
-		void Destroy() const;
-
 		void PrepareDataThread();
 		void ProcessDataThread();
+		void DetailDataThread();
 
 		bool PrepareData();
 		ProcessContainer* GetPreparedData();
 		void SetData(ProcessContainer* data);
 
 		bool UpdateProcess(const ProcessEntry* entry) const;
-		bool UpdateProcess(const PROCESSENTRY32& pe32) const;
+		bool UpdateProcess(const ProcessRecord& record) const;
 
-		void CleanMap();
+		void UpdateProcessCounters(ProcessEntry* entry, const ProcessRecord& record, uint64_t now, uint64_t elapsed, bool expensive, uint32_t fields);
+		void UpdateIoCounters(ProcessEntry* entry, uint64_t now);
+
+		uint32_t CleanMap();
 		void ResetAllRunningStatus();
+
+		// Drops interned strings nothing refers to anymore
+		void CompactStrings();
 	private:
+		const uint32_t THREAD_POLL_INTERVAL = 100;
+		const uint32_t MODULE_POLL_INTERVAL = 250;
+		const std::chrono::seconds STRING_COMPACT_INTERVAL{ 60 };
+
 		ProcessMap mProcessMap{};
+		ProcessWalker mProcessWalker{}; // Only used from the scan thread
+		ProcessTree mProcessTree{}; // Guarded by mProcessMap's mutex
+		ThreadCollector mThreadCollector{};
+		ModuleCollector mModuleCollector{};
+		IoCollector mIoCollector{}; // Only used from the scan thread
+		FdCollector mFdCollector{};
+		SearchIndex mSearchIndex{};
+		ScanScheduler mScanScheduler{};
+		ExitCollector mExitCollector{};
+		CgroupCollector mCgroupCollector{}; // Refreshed by the scan thread
+		TopConsumers mTopConsumers{};
 		std::shared_ptr<ProcessContainer> mProcessContainer{};
 
+		mutable std::mutex mDemandMutex{};
+		DetailDemand mDetailDemand{};
+		std::atomic<unsigned long> mSelectedId{ (unsigned long)-1 };
+
 		bool mRunning = false;
 		uint32_t mUpdateInterval{};
+		uint32_t mNumProcessors{};
+		uint64_t mLastScanTime{};
+		std::chrono::steady_clock::time_point mLastCompact{}; // Of the string pool
 		std::atomic<bool> mDataPrepared;
 		std::atomic<bool> mDataReady;
 		std::atomic<bool> mDataBusy;
 
+		// Declared last, so they are joined before anything they use is destroyed
+		ServiceThread mScanThread{ "Process scan" };
+		ServiceThread mPublishThread{ "Process publish" };
+		ServiceThread mDetailThread{ "Process details" };
+
 		static ProcessManager* sInstance;
 
 	};
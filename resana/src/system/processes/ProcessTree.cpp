@@ -0,0 +1,191 @@
+#include "ProcessTree.h"
+#include "rspch.h"
+
+namespace RESANA {
+
+void ProcessTree::Add(const ulong procId, const ulong parentId, const ProcessTotals& totals)
+{
+    if (Contains(procId)) {
+        Update(procId, parentId, totals);
+        return;
+    }
+
+    auto& node = mNodes[procId];
+    node.ProcessId = procId;
+    node.ParentProcessId = parentId;
+    node.Self = totals;
+    node.Subtree = totals;
+    Attach(node);
+
+    // Adopt any children that were added before this process
+    if (auto it = mOrphans.find(procId); it != mOrphans.end()) {
+        const auto children = std::move(it->second);
+        mOrphans.erase(it);
+
+        for (const auto childId : children) {
+            if (auto child = mNodes.find(childId); child != mNodes.end()) {
+                mRoots.erase(childId);
+                Attach(child->second);
+            }
+        }
+    }
+}
+
+void ProcessTree::Update(const ulong procId, const ulong parentId, const ProcessTotals& totals)
+{
+    const auto it = mNodes.find(procId);
+    if (it == mNodes.end()) {
+        Add(procId, parentId, totals);
+        return;
+    }
+
+    auto& node = it->second;
+    if (node.ParentProcessId != parentId) {
+        // Re-parented (i.e. the parent exited), so move the whole subtree
+        Detach(node);
+        node.ParentProcessId = parentId;
+        node.Subtree -= node.Self;
+        node.Self = totals;
+        node.Subtree += totals;
+        Attach(node);
+        return;
+    }
+
+    if (node.Self == totals) {
+        return; // Nothing changed on this path
+    }
+
+    ProcessTotals delta = totals;
+    delta -= node.Self;
+    node.Self = totals;
+    node.Subtree += delta;
+
+    if (node.Attached) {
+        Propagate(node.ParentProcessId, delta, false);
+    }
+}
+
+void ProcessTree::Remove(const ulong procId)
+{
+    const auto it = mNodes.find(procId);
+    if (it == mNodes.end()) {
+        return;
+    }
+
+    auto& node = it->second;
+    Detach(node);
+
+    // The children's totals left with this subtree; they become roots
+    for (const auto childId : node.Children) {
+        if (auto child = mNodes.find(childId); child != mNodes.end()) {
+            child->second.Attached = false;
+            mRoots.insert(childId);
+        }
+    }
+
+    mOrphans.erase(procId);
+    mNodes.erase(it);
+}
+
+void ProcessTree::ForgetOrphans()
+{
+    // The children stay roots; nothing else refers to these entries
+    mOrphans.clear();
+}
+
+void ProcessTree::Clear()
+{
+    mNodes.clear();
+    mRoots.clear();
+    mOrphans.clear();
+}
+
+const ProcessTree::Node* ProcessTree::Find(const ulong procId) const
+{
+    const auto it = mNodes.find(procId);
+    return it != mNodes.end() ? &it->second : nullptr;
+}
+
+void ProcessTree::Attach(Node& node)
+{
+    const auto parentId = node.ParentProcessId;
+    const auto parent = mNodes.find(parentId);
+
+    // PIDs get reused, so a stale parent id can point into our own subtree
+    if (parentId == node.ProcessId || parent == mNodes.end() || IsAncestor(node.ProcessId, parentId)) {
+        node.Attached = false;
+        mRoots.insert(node.ProcessId);
+
+        if (parent == mNodes.end() && parentId != 0 && parentId != node.ProcessId) {
+            mOrphans[parentId].push_back(node.ProcessId);
+        }
+        return;
+    }
+
+    parent->second.Children.push_back(node.ProcessId);
+    node.Attached = true;
+    Propagate(parentId, node.Subtree, false);
+}
+
+void ProcessTree::Detach(Node& node)
+{
+    if (!node.Attached) {
+        mRoots.erase(node.ProcessId);
+
+        if (auto it = mOrphans.find(node.ParentProcessId); it != mOrphans.end()) {
+            auto& waiting = it->second;
+            waiting.erase(std::remove(waiting.begin(), waiting.end(), node.ProcessId), waiting.end());
+            if (waiting.empty()) {
+                mOrphans.erase(it);
+            }
+        }
+        return;
+    }
+
+    if (auto parent = mNodes.find(node.ParentProcessId); parent != mNodes.end()) {
+        auto& siblings = parent->second.Children;
+        if (auto it = std::find(siblings.begin(), siblings.end(), node.ProcessId); it != siblings.end()) {
+            // Order is irrelevant, the panel sorts children itself
+            *it = siblings.back();
+            siblings.pop_back();
+        }
+        Propagate(node.ParentProcessId, node.Subtree, true);
+    }
+
+    node.Attached = false;
+}
+
+void ProcessTree::Propagate(ulong parentId, const ProcessTotals& delta, const bool subtract)
+{
+    // Walk up towards the root, touching only the changed path
+    for (auto it = mNodes.find(parentId); it != mNodes.end(); it = mNodes.find(parentId)) {
+        auto& node = it->second;
+        if (subtract) {
+            node.Subtree -= delta;
+        } else {
+            node.Subtree += delta;
+        }
+
+        if (!node.Attached) {
+            break;
+        }
+        parentId = node.ParentProcessId;
+    }
+}
+
+bool ProcessTree::IsAncestor(const ulong ancestorId, ulong procId) const
+{
+    for (auto it = mNodes.find(procId); it != mNodes.end(); it = mNodes.find(procId)) {
+        if (it->first == ancestorId) {
+            return true;
+        }
+        if (!it->second.Attached) {
+            break;
+        }
+        procId = it->second.ParentProcessId;
+    }
+
+    return false;
+}
+
+}
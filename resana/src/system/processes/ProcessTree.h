@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace RESANA {
+
+struct ProcessTotals {
+    double CpuLoad {};
+    uint64_t MemoryUsage {};
+    uint64_t ThreadCount {};
+
+    ProcessTotals& operator+=(const ProcessTotals& rhs)
+    {
+        CpuLoad += rhs.CpuLoad;
+        MemoryUsage += rhs.MemoryUsage;
+        ThreadCount += rhs.ThreadCount;
+        return *this;
+    }
+
+    ProcessTotals& operator-=(const ProcessTotals& rhs)
+    {
+        CpuLoad -= rhs.CpuLoad;
+        MemoryUsage -= rhs.MemoryUsage;
+        ThreadCount -= rhs.ThreadCount;
+        return *this;
+    }
+
+    bool operator==(const ProcessTotals& rhs) const
+    {
+        return CpuLoad == rhs.CpuLoad && MemoryUsage == rhs.MemoryUsage && ThreadCount == rhs.ThreadCount;
+    }
+
+    bool operator!=(const ProcessTotals& rhs) const { return !(*this == rhs); }
+};
+
+/*
+ * Parent -> children index over the running processes. Each node keeps the
+ * totals of its own process and of its whole subtree. Subtree totals are only
+ * touched along the path from a changed node to its root, so a tick where a
+ * handful of processes change costs O(changes * depth) instead of O(n).
+ */
+class ProcessTree {
+    typedef unsigned long ulong;
+
+public:
+    struct Node {
+        ulong ProcessId {};
+        ulong ParentProcessId {};
+        bool Attached = false; // Linked into the parent's children list
+        std::vector<ulong> Children {};
+        ProcessTotals Self {};
+        ProcessTotals Subtree {};
+    };
+
+public:
+    void Add(ulong procId, ulong parentId, const ProcessTotals& totals);
+    void Update(ulong procId, ulong parentId, const ProcessTotals& totals);
+    void Remove(ulong procId);
+    void Clear();
+
+    // Called once a walk has listed every process: a parent it didn't list has exited, and
+    // a later process given its reused PID must not adopt the children still waiting for it
+    void ForgetOrphans();
+
+    [[nodiscard]] const Node* Find(ulong procId) const;
+    [[nodiscard]] const std::unordered_set<ulong>& GetRoots() const { return mRoots; }
+    [[nodiscard]] bool Contains(ulong procId) const { return mNodes.count(procId) > 0; }
+    [[nodiscard]] int Size() const { return (int)mNodes.size(); }
+
+private:
+    void Attach(Node& node);
+    void Detach(Node& node);
+    void Propagate(ulong parentId, const ProcessTotals& delta, bool subtract);
+    [[nodiscard]] bool IsAncestor(ulong ancestorId, ulong procId) const;
+
+private:
+    std::unordered_map<ulong, Node> mNodes {};
+    std::unordered_set<ulong> mRoots {};
+
+    // Children seen before their parent (snapshot order is arbitrary),
+    // keyed by the parent they are waiting for; only kept for one walk.
+    std::unordered_map<ulong, std::vector<ulong>> mOrphans {};
+};
+
+}
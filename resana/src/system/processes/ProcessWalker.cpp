@@ -0,0 +1,262 @@
+#include "ProcessWalker.h"
+#include "rspch.h"
+
+#include "helpers/ProcFS.h"
+
+#if defined(RS_PLATFORM_WINDOWS)
+#include "helpers/WinFuncs.h"
+
+#include <Psapi.h>
+#include <winternl.h>
+#elif defined(RS_PLATFORM_LINUX)
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace RESANA {
+
+// Very long command lines are truncated so generated ones can't bloat the pool
+static constexpr int MAX_COMMAND_LINE = 4096;
+
+ProcessWalker::~ProcessWalker()
+{
+    End();
+}
+
+#if defined(RS_PLATFORM_WINDOWS)
+
+// Command lines rarely change, so they are read once per process and interned.
+static StringPool::Id ReadCommandLine(HANDLE hProcess)
+{
+    typedef NTSTATUS(NTAPI * NtQueryInformationProcessFn)(HANDLE, ULONG, PVOID, ULONG, PULONG);
+    static const auto sNtQueryInformationProcess = (NtQueryInformationProcessFn)GetProcAddress(
+        GetModuleHandleW(L"ntdll.dll"), "NtQueryInformationProcess");
+
+    const ULONG PROCESS_COMMAND_LINE_INFORMATION = 60; // Windows 8.1 and later
+
+    if (!sNtQueryInformationProcess) {
+        return StringPool::Empty;
+    }
+
+    ULONG size = 0;
+    sNtQueryInformationProcess(hProcess, PROCESS_COMMAND_LINE_INFORMATION, nullptr, 0, &size);
+    if (size < sizeof(UNICODE_STRING)) {
+        return StringPool::Empty;
+    }
+
+    std::vector<char> buffer(size);
+    if (!NT_SUCCESS(sNtQueryInformationProcess(hProcess, PROCESS_COMMAND_LINE_INFORMATION, buffer.data(), size, &size))) {
+        return StringPool::Empty;
+    }
+
+    const auto* commandLine = (const UNICODE_STRING*)buffer.data();
+    const int length = std::min<int>(commandLine->Length / sizeof(WCHAR), MAX_COMMAND_LINE);
+
+    std::string utf8(length * 3, '\0');
+    const int bytes = WideCharToMultiByte(CP_UTF8, 0, commandLine->Buffer, length, utf8.data(), (int)utf8.size(), nullptr, nullptr);
+    return (bytes > 0) ? StringPool::Get().Intern(std::string_view(utf8.data(), bytes)) : StringPool::Empty;
+}
+
+bool ProcessWalker::Begin()
+{
+    End();
+
+    // Take a snapshot of all processes in the system.
+    mSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+    if (mSnapshot == INVALID_HANDLE_VALUE) {
+        PrintWin32Error("CreateToolhelp32Snapshot (of processes)");
+        return false;
+    }
+
+    mEntry = {};
+    mEntry.dwSize = sizeof(PROCESSENTRY32);
+    if (!Process32First(mSnapshot, &mEntry)) {
+        PrintWin32Error("Process32First");
+        End();
+        return false;
+    }
+
+    mHasEntry = true;
+    return true;
+}
+
+bool ProcessWalker::Next(ProcessRecord& record)
+{
+    if (mSnapshot == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    if (!mHasEntry && !Process32Next(mSnapshot, &mEntry)) {
+        return false;
+    }
+    mHasEntry = false;
+
+    record = {};
+    record.Name = mEntry.szExeFile;
+    record.ProcessId = mEntry.th32ProcessID;
+    record.ParentProcessId = mEntry.th32ParentProcessID;
+    record.ThreadCount = mEntry.cntThreads;
+    record.PriorityClass = mEntry.pcPriClassBase;
+    record.Flags = mEntry.dwFlags;
+    return true;
+}
+
+void ProcessWalker::End()
+{
+    if (mSnapshot != INVALID_HANDLE_VALUE) {
+        CloseHandle(mSnapshot);
+        mSnapshot = INVALID_HANDLE_VALUE;
+    }
+    mHasEntry = false;
+}
+
+bool ProcessWalker::ReadUsage(const ProcessRecord& record, const bool commandLine, ProcessUsage& usage) const
+{
+    HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, record.ProcessId);
+    if (!hProcess) {
+        return false; // Protected and system processes deny access
+    }
+
+    if (commandLine) {
+        usage.CommandLine = ReadCommandLine(hProcess);
+    }
+
+    FILETIME ftCreation, ftExit, ftKernel, ftUser;
+    if (GetProcessTimes(hProcess, &ftCreation, &ftExit, &ftKernel, &ftUser)) {
+        const uint64_t kernel = ((uint64_t)ftKernel.dwHighDateTime << 32) | ftKernel.dwLowDateTime;
+        const uint64_t user = ((uint64_t)ftUser.dwHighDateTime << 32) | ftUser.dwLowDateTime;
+        usage.CpuTime = kernel + user;
+    }
+
+    PROCESS_MEMORY_COUNTERS pmc {};
+    if (GetProcessMemoryInfo(hProcess, &pmc, sizeof(pmc))) {
+        usage.MemoryUsage = pmc.WorkingSetSize;
+    }
+
+    CloseHandle(hProcess);
+    return true;
+}
+
+uint64_t ProcessWalker::GetTime()
+{
+    FILETIME ftime;
+    GetSystemTimeAsFileTime(&ftime);
+    return ((uint64_t)ftime.dwHighDateTime << 32) | ftime.dwLowDateTime;
+}
+
+#elif defined(RS_PLATFORM_LINUX)
+
+bool ProcessWalker::Begin()
+{
+    End();
+
+    mDir = opendir("/proc");
+    if (!mDir) {
+        RS_CORE_ERROR("Could not open /proc");
+        return false;
+    }
+    return true;
+}
+
+bool ProcessWalker::Next(ProcessRecord& record)
+{
+    if (!mDir) {
+        return false;
+    }
+
+    static const uint64_t sPageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+
+    while (const dirent* entry = readdir(mDir)) {
+        if (!ProcFS::IsNumeric(entry->d_name)) {
+            continue;
+        }
+
+        char path[32];
+        snprintf(path, sizeof(path), "/proc/%s/stat", entry->d_name);
+        if (ProcFS::ReadFile(path, mBuffer, sizeof(mBuffer)) <= 0) {
+            continue; // Exited since the directory was listed
+        }
+
+        // pid (comm) state ppid pgrp session tty_nr tpgid flags minflt cminflt majflt cmajflt
+        // utime stime cutime cstime priority nice num_threads itrealvalue starttime vsize rss
+        const char* open = std::strchr(mBuffer, '(');
+        const char* close = std::strrchr(mBuffer, ')');
+        if (!open || !close || close < open) {
+            continue;
+        }
+
+        const size_t length = std::min<size_t>((size_t)(close - open - 1), sizeof(mName) - 1);
+        std::memcpy(mName, open + 1, length);
+        mName[length] = '\0';
+
+        uint64_t processId = 0, parentId = 0, flags = 0, user = 0, system = 0, threads = 0, rss = 0;
+        int64_t priority = 0;
+        ProcFS::ParseUInt64(mBuffer, processId);
+        const char* p = ProcFS::SkipComm(mBuffer);
+        p = ProcFS::ParseUInt64(ProcFS::SkipFields(p, 1), parentId);
+        p = ProcFS::ParseUInt64(ProcFS::SkipFields(p, 4), flags);
+        p = ProcFS::ParseUInt64(ProcFS::SkipFields(p, 4), user);
+        p = ProcFS::ParseUInt64(p, system);
+        p = ProcFS::ParseInt64(ProcFS::SkipFields(p, 2), priority);
+        p = ProcFS::ParseUInt64(ProcFS::SkipFields(p, 1), threads);
+        ProcFS::ParseUInt64(ProcFS::SkipFields(p, 3), rss);
+
+        record = {};
+        record.Name = mName;
+        record.ProcessId = (ulong)processId;
+        record.ParentProcessId = (ulong)parentId;
+        record.ThreadCount = (ulong)threads;
+        record.PriorityClass = (long)priority;
+        record.Flags = (ulong)flags;
+        record.CpuTime = ProcFS::TicksTo100ns(user + system);
+        record.MemoryUsage = rss * sPageSize;
+        return true;
+    }
+
+    return false;
+}
+
+void ProcessWalker::End()
+{
+    if (mDir) {
+        closedir(mDir);
+        mDir = nullptr;
+    }
+}
+
+bool ProcessWalker::ReadUsage(const ProcessRecord& record, const bool commandLine, ProcessUsage& usage) const
+{
+    usage.CpuTime = record.CpuTime;
+    usage.MemoryUsage = record.MemoryUsage;
+    if (!commandLine) {
+        return true;
+    }
+
+    char path[32];
+    snprintf(path, sizeof(path), "/proc/%lu/cmdline", record.ProcessId);
+
+    // Arguments are separated by NULs; kernel threads have none
+    char buffer[MAX_COMMAND_LINE + 1];
+    long length = ProcFS::ReadFile(path, buffer, sizeof(buffer));
+    while (length > 0 && buffer[length - 1] == '\0') {
+        length--;
+    }
+    if (length <= 0) {
+        return true;
+    }
+
+    std::replace(buffer, buffer + length, '\0', ' ');
+    usage.CommandLine = StringPool::Get().Intern(std::string_view(buffer, (size_t)length));
+    return true;
+}
+
+uint64_t ProcessWalker::GetTime()
+{
+    timespec time {};
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 10000000 + (uint64_t)time.tv_nsec / 100;
+}
+
+#endif
+
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "core/Core.h"
+#include "helpers/StringPool.h"
+
+#include <cstdint>
+#include <string_view>
+
+#if defined(RS_PLATFORM_WINDOWS)
+#include <Windows.h>
+#include <TlHelp32.h>
+#elif defined(RS_PLATFORM_LINUX)
+#include <dirent.h>
+#endif
+
+namespace RESANA {
+
+// A process as listed by the walk
+struct ProcessRecord {
+    std::string_view Name {}; // Valid until the next record
+    unsigned long ProcessId {};
+    unsigned long ParentProcessId {};
+    unsigned long ThreadCount {};
+    long PriorityClass {}; // Base priority on Windows, scheduler priority on Linux
+    unsigned long Flags {};
+    uint64_t CpuTime {};     // Linux only, read with the rest of the record
+    uint64_t MemoryUsage {}; // Linux only
+};
+
+struct ProcessUsage {
+    uint64_t CpuTime {};     // Kernel + user time, in 100ns units
+    uint64_t MemoryUsage {}; // Working set, in bytes
+    StringPool::Id CommandLine = StringPool::Empty;
+};
+
+/*
+ * Lists the running processes: a Toolhelp snapshot on Windows, the numeric
+ * entries of /proc on Linux. Linux records come with their CPU time and
+ * resident size, as /proc/<pid>/stat holds them anyway; on Windows these
+ * take a handle to the process. Only used from the scan thread.
+ */
+class ProcessWalker {
+    typedef unsigned long ulong;
+
+public:
+    ProcessWalker() = default;
+    ~ProcessWalker();
+
+    ProcessWalker(const ProcessWalker&) = delete;
+    ProcessWalker& operator=(const ProcessWalker&) = delete;
+
+    // Returns false if the processes can't be listed at all
+    bool Begin();
+    bool Next(ProcessRecord& record);
+    void End();
+
+    // Returns false if the process denies access; the command line is only read if asked for
+    bool ReadUsage(const ProcessRecord& record, bool commandLine, ProcessUsage& usage) const;
+
+    // Time base of the CPU load, in 100ns units
+    static uint64_t GetTime();
+
+private:
+#if defined(RS_PLATFORM_WINDOWS)
+    HANDLE mSnapshot = INVALID_HANDLE_VALUE;
+    PROCESSENTRY32 mEntry {};
+    bool mHasEntry = false; // Process32First's entry is still to be handed out
+#elif defined(RS_PLATFORM_LINUX)
+    DIR* mDir = nullptr;
+    char mBuffer[1024] {}; // One stat line
+    char mName[64] {};
+#endif
+};
+
+}
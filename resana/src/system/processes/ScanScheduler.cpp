@@ -0,0 +1,100 @@
+#include "ScanScheduler.h"
+#include "rspch.h"
+
+namespace RESANA {
+
+ScanScheduler::ScanScheduler()
+{
+    ResetBounds();
+}
+
+void ScanScheduler::SetBaseInterval(const uint32_t interval_ms)
+{
+    std::scoped_lock lock(mMutex);
+    if (interval_ms == mBaseInterval || interval_ms == 0) {
+        return;
+    }
+
+    mBaseInterval = interval_ms;
+    mInterval = interval_ms;
+    if (!mCustomBounds) {
+        ResetBounds();
+    }
+}
+
+void ScanScheduler::SetBounds(const uint32_t min_ms, const uint32_t max_ms)
+{
+    std::scoped_lock lock(mMutex);
+    mMinInterval = std::min(min_ms, max_ms);
+    mMaxInterval = std::max(min_ms, max_ms);
+    mCustomBounds = true;
+    mInterval = std::clamp(mInterval, (double)mMinInterval, (double)mMaxInterval);
+}
+
+void ScanScheduler::ResetBounds()
+{
+    mMinInterval = std::max(mBaseInterval / 4, 100u);
+    mMaxInterval = mBaseInterval * 4;
+}
+
+bool ScanScheduler::IsExpensiveDue() const
+{
+    std::scoped_lock lock(mMutex);
+    return Clock::now() - mLastExpensive >= std::chrono::milliseconds(mBaseInterval);
+}
+
+void ScanScheduler::OnScan(const uint32_t processCount, const uint32_t added, const uint32_t removed,
+    const double cheapCost, const double expensiveCost, const bool expensive)
+{
+    std::scoped_lock lock(mMutex);
+
+    const double churn = (double)added + (double)removed;
+    mChurn += (churn - mChurn) * SMOOTHING;
+    mCheapCost += (cheapCost - mCheapCost) * SMOOTHING;
+    mExpensivePerScan += (expensiveCost - mExpensivePerScan) * SMOOTHING;
+    if (expensive) {
+        mExpensiveCost += (expensiveCost - mExpensiveCost) * SMOOTHING;
+        mLastExpensive = Clock::now();
+    }
+
+    // React to the raw churn of this scan so a burst is caught straight away
+    const double burst = std::max(8.0, processCount * 0.01);
+    double target;
+    if (churn >= burst) {
+        mQuietScans = 0;
+        target = mInterval / 2.0;
+    } else if (churn == 0.0 && ++mQuietScans >= QUIET_SCANS) {
+        target = mInterval * 1.5;
+    } else {
+        if (churn > 0.0) {
+            mQuietScans = 0;
+        }
+        target = mInterval + (mBaseInterval - mInterval) / 2.0; // Drift back to the base
+    }
+
+    // Scanning must stay cheap relative to the interval
+    target = std::max(target, (mCheapCost + mExpensivePerScan) / MAX_OVERHEAD);
+    mInterval = std::clamp(target, (double)mMinInterval, (double)mMaxInterval);
+}
+
+uint32_t ScanScheduler::GetInterval() const
+{
+    std::scoped_lock lock(mMutex);
+    return (uint32_t)mInterval;
+}
+
+ScanStats ScanScheduler::GetStats() const
+{
+    std::scoped_lock lock(mMutex);
+
+    ScanStats stats;
+    stats.BaseInterval = mBaseInterval;
+    stats.EffectiveInterval = (uint32_t)mInterval;
+    stats.Churn = mChurn;
+    stats.ScanCost = mCheapCost + mExpensivePerScan;
+    stats.Overhead = stats.ScanCost / mInterval * 100.0;
+    stats.FixedOverhead = (mCheapCost + mExpensiveCost) / mBaseInterval * 100.0;
+    return stats;
+}
+
+}
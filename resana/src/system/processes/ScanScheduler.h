@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace RESANA {
+
+struct ScanStats {
+    uint32_t BaseInterval {};      // Requested interval, in ms
+    uint32_t EffectiveInterval {}; // Interval currently in use, in ms
+    double Churn {};               // Processes added + removed per scan, smoothed
+    double ScanCost {};            // Time per scan, in ms, smoothed
+    double Overhead {};            // Percent of one core spent scanning
+    double FixedOverhead {};       // The same, were every field rescanned at the base interval
+};
+
+/*
+ * Picks the interval between process scans. Bursts of processes starting and
+ * exiting shorten it so short-lived processes are caught, a quiet system
+ * lengthens it, and it never drops so low that scanning takes more than a
+ * small share of a core. Expensive per-process fields (I/O, descriptors) keep
+ * to the base interval however often the cheap walk runs.
+ */
+class ScanScheduler {
+    typedef std::chrono::steady_clock Clock;
+
+public:
+    ScanScheduler();
+
+    void SetBaseInterval(uint32_t interval_ms);
+    void SetBounds(uint32_t min_ms, uint32_t max_ms);
+
+    [[nodiscard]] bool IsExpensiveDue() const;
+
+    // Reports a finished scan; costs are in ms
+    void OnScan(uint32_t processCount, uint32_t added, uint32_t removed, double cheapCost, double expensiveCost, bool expensive);
+
+    [[nodiscard]] uint32_t GetInterval() const;
+    [[nodiscard]] ScanStats GetStats() const;
+
+private:
+    void ResetBounds();
+
+private:
+    const double SMOOTHING = 0.2;
+    const double MAX_OVERHEAD = 0.05; // Of one core
+    const uint32_t QUIET_SCANS = 3;   // Before backing off
+
+    mutable std::mutex mMutex {};
+    uint32_t mBaseInterval = 1000;
+    uint32_t mMinInterval = 250;
+    uint32_t mMaxInterval = 4000;
+    bool mCustomBounds = false;
+    double mInterval = 1000.0;
+    uint32_t mQuietScans = 0;
+
+    double mChurn = 0.0;
+    double mCheapCost = 0.0;
+    double mExpensiveCost = 0.0;        // Per scan that refreshed the expensive fields
+    double mExpensivePerScan = 0.0;     // Averaged over all scans
+    Clock::time_point mLastExpensive {};
+};
+
+}
@@ -0,0 +1,316 @@
+#include "SearchIndex.h"
+#include "rspch.h"
+
+#include <cctype>
+
+namespace RESANA {
+
+// Only the start of very long command lines is searchable
+static constexpr size_t MAX_INDEXED_LENGTH = 1024;
+
+static char ToLower(const char c)
+{
+    return (char)std::tolower((unsigned char)c);
+}
+
+static bool StartsWithNoCase(const std::string_view text, const std::string_view prefix)
+{
+    if (text.size() < prefix.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < prefix.size(); i++) {
+        if (ToLower(text[i]) != prefix[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool ContainsNoCase(const std::string_view text, const std::string_view needle)
+{
+    if (text.size() < needle.size()) {
+        return false;
+    }
+    for (size_t i = 0; i + needle.size() <= text.size(); i++) {
+        if (ToLower(text[i]) == needle[0] && StartsWithNoCase(text.substr(i), needle)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Trigrams use the low 24 bits, prefixes of one or two characters are tagged above them
+static uint32_t MakeTrigram(const char a, const char b, const char c)
+{
+    return ((uint32_t)(unsigned char)a << 16) | ((uint32_t)(unsigned char)b << 8) | (uint32_t)(unsigned char)c;
+}
+
+static uint32_t MakePrefix(const std::string_view text)
+{
+    return (text.size() == 1) ? (1u << 24) | (unsigned char)text[0]
+                              : (2u << 24) | ((uint32_t)(unsigned char)text[0] << 8) | (unsigned char)text[1];
+}
+
+static void CollectFieldKeys(std::string_view text, std::vector<uint32_t>& keys)
+{
+    text = text.substr(0, MAX_INDEXED_LENGTH);
+    if (text.empty()) {
+        return;
+    }
+
+    char lower[MAX_INDEXED_LENGTH];
+    for (size_t i = 0; i < text.size(); i++) {
+        lower[i] = ToLower(text[i]);
+    }
+
+    keys.emplace_back(MakePrefix({ lower, 1 }));
+    if (text.size() >= 2) {
+        keys.emplace_back(MakePrefix({ lower, 2 }));
+    }
+    for (size_t i = 0; i + 3 <= text.size(); i++) {
+        keys.emplace_back(MakeTrigram(lower[i], lower[i + 1], lower[i + 2]));
+    }
+}
+
+void SearchIndex::CollectKeys(const Document& document, std::vector<Key>& keys)
+{
+    auto& pool = StringPool::Get();
+
+    char procId[16];
+    snprintf(procId, sizeof(procId), "%lu", document.ProcessId);
+
+    keys.clear();
+    CollectFieldKeys(pool.View(document.Name), keys);
+    CollectFieldKeys(procId, keys);
+    CollectFieldKeys(pool.View(document.CommandLine), keys);
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+}
+
+void SearchIndex::CollectQueryKeys(const std::string_view query, std::vector<Key>& keys)
+{
+    // Short queries match the start of a field, longer ones anywhere in it
+    keys.clear();
+    if (query.size() < 3) {
+        keys.emplace_back(MakePrefix(query));
+        return;
+    }
+
+    for (size_t i = 0; i + 3 <= query.size(); i++) {
+        keys.emplace_back(MakeTrigram(query[i], query[i + 1], query[i + 2]));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+}
+
+bool SearchIndex::MatchesQuery(const Document& document, const std::string_view query)
+{
+    auto& pool = StringPool::Get();
+
+    char procId[16];
+    snprintf(procId, sizeof(procId), "%lu", document.ProcessId);
+
+    const std::string_view fields[] = {
+        pool.View(document.Name),
+        procId,
+        pool.View(document.CommandLine).substr(0, MAX_INDEXED_LENGTH),
+    };
+
+    for (const auto& field : fields) {
+        if ((query.size() < 3) ? StartsWithNoCase(field, query) : ContainsNoCase(field, query)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SearchIndex::Set(const ulong procId, const StringPool::Id name, const StringPool::Id commandLine)
+{
+    std::scoped_lock lock(mMutex);
+
+    if (const auto it = mSlots.find(procId); it != mSlots.end()) {
+        const auto& document = mDocuments[it->second];
+        if (document.Name == name && document.CommandLine == commandLine) {
+            return; // Unchanged
+        }
+
+        const Document previous = document;
+        mDocuments.erase(it->second);
+        Erase(previous);
+        mSlots.erase(it);
+    }
+
+    const uint32_t slot = mNextSlot++;
+    const Document document { procId, name, commandLine };
+    mDocuments.emplace(slot, document);
+    mSlots.emplace(procId, slot);
+    Insert(slot, document);
+
+    // The candidates of an active query were taken before this process was indexed
+    if (!mQuery.empty() && MatchesQuery(document, mQuery)) {
+        AddResult(procId);
+    }
+}
+
+void SearchIndex::Remove(const ulong procId)
+{
+    std::scoped_lock lock(mMutex);
+
+    const auto it = mSlots.find(procId);
+    if (it == mSlots.end()) {
+        return;
+    }
+
+    const Document document = mDocuments[it->second];
+    mDocuments.erase(it->second);
+    Erase(document);
+    mSlots.erase(it);
+
+    if (mResultSet.erase(procId)) {
+        mResults.erase(std::find(mResults.begin(), mResults.end(), procId));
+        mEpoch++; // Pollers have to start over
+    }
+}
+
+void SearchIndex::Insert(const uint32_t slot, const Document& document)
+{
+    CollectKeys(document, mKeyBuffer);
+    for (const auto key : mKeyBuffer) {
+        mPostings[key].Slots.emplace_back(slot);
+    }
+}
+
+void SearchIndex::Erase(const Document& document)
+{
+    CollectKeys(document, mKeyBuffer);
+    for (const auto key : mKeyBuffer) {
+        const auto it = mPostings.find(key);
+        if (it == mPostings.end()) {
+            continue;
+        }
+
+        // Erasing from the middle of a list shared by most processes is what
+        // makes removal expensive, so dead slots are swept in bulk instead.
+        auto& list = it->second;
+        if (++list.Dead * 2 < list.Slots.size()) {
+            continue;
+        }
+
+        auto& slots = list.Slots;
+        slots.erase(std::remove_if(slots.begin(), slots.end(), [this](const uint32_t s) { return mDocuments.count(s) == 0; }), slots.end());
+        list.Dead = 0;
+        if (slots.empty()) {
+            mPostings.erase(it);
+        }
+    }
+}
+
+void SearchIndex::SetQuery(const std::string_view query)
+{
+    std::scoped_lock lock(mMutex);
+
+    mQuery.resize(query.size());
+    std::transform(query.begin(), query.end(), mQuery.begin(), ToLower);
+    StartQuery();
+}
+
+void SearchIndex::StartQuery()
+{
+    mCandidates.clear();
+    mCandidateIndex = 0;
+    mResults.clear();
+    mResultSet.clear();
+    mEpoch++;
+
+    if (mQuery.empty()) {
+        return;
+    }
+
+    // Every match is in the shortest posting list, so only that one is walked.
+    // Lists are compared by their live slots, as dead ones are skipped anyway.
+    CollectQueryKeys(mQuery, mQueryKeys);
+    const PostingList* shortest = nullptr;
+    for (const auto key : mQueryKeys) {
+        const auto it = mPostings.find(key);
+        if (it == mPostings.end()) {
+            return; // Nothing can match
+        }
+        if (!shortest || it->second.GetLiveCount() < shortest->GetLiveCount()) {
+            shortest = &it->second;
+        }
+    }
+
+    mCandidates = shortest->Slots;
+}
+
+bool SearchIndex::Step(const std::chrono::microseconds budget)
+{
+    std::scoped_lock lock(mMutex);
+
+    const auto start = std::chrono::steady_clock::now();
+    while (mCandidateIndex < mCandidates.size()) {
+        const uint32_t slot = mCandidates[mCandidateIndex++];
+
+        const auto document = mDocuments.find(slot);
+        if (document == mDocuments.end()) {
+            continue; // Removed or reindexed since the query started
+        }
+
+        // The trigrams only narrow the candidates down, the text decides
+        const bool hasAllKeys = std::all_of(mQueryKeys.begin(), mQueryKeys.end(), [&](const Key key) {
+            const auto it = mPostings.find(key);
+            return it != mPostings.end() && std::binary_search(it->second.Slots.begin(), it->second.Slots.end(), slot);
+        });
+        if (hasAllKeys && MatchesQuery(document->second, mQuery)) {
+            AddResult(document->second.ProcessId);
+        }
+
+        if ((mCandidateIndex & 15) == 0 && std::chrono::steady_clock::now() - start >= budget) {
+            break;
+        }
+    }
+
+    return mCandidateIndex >= mCandidates.size();
+}
+
+void SearchIndex::AddResult(const ulong procId)
+{
+    if (mResultSet.insert(procId).second) {
+        mResults.emplace_back(procId);
+    }
+}
+
+bool SearchIndex::PollResults(SearchCursor& cursor, std::unordered_set<ulong>& results) const
+{
+    std::scoped_lock lock(mMutex);
+
+    bool changed = false;
+    if (cursor.Epoch != mEpoch) {
+        results.clear();
+        cursor.Epoch = mEpoch;
+        cursor.Count = 0;
+        changed = true;
+    }
+
+    if (cursor.Count < mResults.size()) {
+        results.insert(mResults.begin() + (ptrdiff_t)cursor.Count, mResults.end());
+        cursor.Count = mResults.size();
+        changed = true;
+    }
+    return changed;
+}
+
+bool SearchIndex::IsSearching() const
+{
+    std::scoped_lock lock(mMutex);
+    return !mQuery.empty();
+}
+
+size_t SearchIndex::Size() const
+{
+    std::scoped_lock lock(mMutex);
+    return mDocuments.size();
+}
+
+}
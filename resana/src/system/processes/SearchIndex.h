@@ -0,0 +1,98 @@
+#pragma once
+
+#include "helpers/StringPool.h"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace RESANA {
+
+struct SearchCursor {
+    uint64_t Epoch = (uint64_t)-1;
+    size_t Count = 0;
+};
+
+/*
+ * Case-insensitive search over the name, PID and command line of every
+ * process. Each process is indexed by the trigrams of its fields (and the
+ * first one or two characters, for short queries) when it appears, and taken
+ * out again when it exits, so the index is never rebuilt.
+ *
+ * A query first narrows the candidates to the shortest posting list, then
+ * checks them in budgeted steps, so a search over 100k processes never stalls
+ * a frame. Processes added while a query is active are matched right away.
+ */
+class SearchIndex {
+    typedef unsigned long ulong;
+    typedef uint32_t Key;
+
+public:
+    // Indexes a new process, or reindexes one whose name or command line changed
+    void Set(ulong procId, StringPool::Id name, StringPool::Id commandLine);
+    void Remove(ulong procId);
+
+    // Starts a new search; an empty query clears it
+    void SetQuery(std::string_view query);
+
+    // Checks candidates until the budget is spent; returns true once the search is complete
+    bool Step(std::chrono::microseconds budget);
+
+    // Copies the results gathered since the last poll. Returns true if the results changed.
+    bool PollResults(SearchCursor& cursor, std::unordered_set<ulong>& results) const;
+
+    [[nodiscard]] bool IsSearching() const;
+    [[nodiscard]] size_t Size() const;
+
+private:
+    struct Document {
+        ulong ProcessId {};
+        StringPool::Id Name {};
+        StringPool::Id CommandLine {};
+    };
+
+    // Removed slots are left in place and swept once they make up half the list
+    struct PostingList {
+        std::vector<uint32_t> Slots {};
+        size_t Dead = 0;
+
+        [[nodiscard]] size_t GetLiveCount() const { return Slots.size() - Dead; }
+    };
+
+    static void CollectKeys(const Document& document, std::vector<Key>& keys);
+    static void CollectQueryKeys(std::string_view query, std::vector<Key>& keys);
+    static bool MatchesQuery(const Document& document, std::string_view query);
+
+    void Insert(uint32_t slot, const Document& document);
+    // The document's slot must already be gone from mDocuments
+    void Erase(const Document& document);
+    void StartQuery();
+    void AddResult(ulong procId);
+
+private:
+    mutable std::mutex mMutex {};
+
+    // Slots only ever grow, so posting lists stay sorted by appending
+    std::unordered_map<uint32_t, Document> mDocuments {};
+    std::unordered_map<ulong, uint32_t> mSlots {};
+    std::unordered_map<Key, PostingList> mPostings {};
+    uint32_t mNextSlot = 0;
+
+    // Active query
+    std::string mQuery {}; // Lower case
+    std::vector<Key> mQueryKeys {};
+    std::vector<uint32_t> mCandidates {};
+    size_t mCandidateIndex = 0;
+    std::vector<ulong> mResults {};
+    std::unordered_set<ulong> mResultSet {};
+    uint64_t mEpoch = 0;
+
+    std::vector<Key> mKeyBuffer {};
+};
+
+}
@@ -0,0 +1,221 @@
+#include "ThreadCollector.h"
+#include "rspch.h"
+
+#include "core/Core.h"
+#include "helpers/ProcFS.h"
+
+#if defined(RS_PLATFORM_WINDOWS)
+#include <TlHelp32.h>
+#elif defined(RS_PLATFORM_LINUX)
+#include <dirent.h>
+#endif
+
+namespace RESANA {
+
+void ThreadCollector::Watch(const std::vector<ulong>& procIds)
+{
+    std::scoped_lock lock(mMutex);
+    mWatched = procIds;
+}
+
+void ThreadCollector::SetRefreshInterval(const uint32_t interval_ms)
+{
+    std::scoped_lock lock(mMutex);
+    mRefreshInterval = std::chrono::milliseconds(interval_ms);
+}
+
+void ThreadCollector::Refresh()
+{
+    std::vector<ulong> due;
+    {
+        std::scoped_lock lock(mMutex);
+        const auto now = Clock::now();
+
+        // Forget processes that are no longer watched
+        for (auto it = mThreads.begin(); it != mThreads.end();) {
+            if (std::find(mWatched.begin(), mWatched.end(), it->first) == mWatched.end()) {
+                it = mThreads.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        for (const auto procId : mWatched) {
+            if (const auto& list = mThreads[procId]; now - list.LastRefresh >= mRefreshInterval) {
+                due.emplace_back(procId);
+            }
+        }
+    }
+
+    // Read outside the lock so the panel is never blocked by /proc or Toolhelp
+    for (const auto procId : due) {
+        std::vector<ThreadEntry> threads;
+        const auto sampleTime = Clock::now();
+        const bool success = ReadThreads(procId, threads);
+
+        std::scoped_lock lock(mMutex);
+        const auto it = mThreads.find(procId);
+        if (it == mThreads.end()) {
+            continue; // Unwatched in the meantime
+        }
+
+        auto& list = it->second;
+        if (success && list.LastRefresh != Clock::time_point {}) {
+            const double elapsed = std::chrono::duration<double>(sampleTime - list.LastRefresh).count();
+            CalcThreadLoad(list.Threads, threads, elapsed);
+        }
+
+        list.Threads = std::move(threads);
+        list.LastRefresh = sampleTime;
+    }
+}
+
+std::vector<ThreadEntry> ThreadCollector::GetThreads(const ulong procId) const
+{
+    std::scoped_lock lock(mMutex);
+    const auto it = mThreads.find(procId);
+    return it != mThreads.end() ? it->second.Threads : std::vector<ThreadEntry> {};
+}
+
+void ThreadCollector::MarkStrings(StringPool::LiveSet& live) const
+{
+    std::scoped_lock lock(mMutex);
+    for (const auto& [procId, list] : mThreads) {
+        for (const auto& thread : list.Threads) {
+            live.Mark(thread.Name);
+        }
+    }
+}
+
+void ThreadCollector::CalcThreadLoad(const std::vector<ThreadEntry>& previous, std::vector<ThreadEntry>& current, const double elapsed)
+{
+    if (elapsed <= 0.0) {
+        return;
+    }
+
+    std::unordered_map<ulong, uint64_t> lastCpuTime;
+    lastCpuTime.reserve(previous.size());
+    for (const auto& thread : previous) {
+        lastCpuTime[thread.ThreadId] = thread.CpuTime;
+    }
+
+    for (auto& thread : current) {
+        if (const auto it = lastCpuTime.find(thread.ThreadId); it != lastCpuTime.end() && thread.CpuTime >= it->second) {
+            thread.CpuLoad = (double)(thread.CpuTime - it->second) / (elapsed * 1.0e7) * 100.0;
+        }
+    }
+}
+
+#if defined(RS_PLATFORM_WINDOWS)
+
+bool ThreadCollector::ReadThreads(const ulong procId, std::vector<ThreadEntry>& threads)
+{
+    // Take a snapshot of all running threads
+    HANDLE hThreadSnap = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (hThreadSnap == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    THREADENTRY32 te32 {};
+    te32.dwSize = sizeof(THREADENTRY32);
+
+    if (!Thread32First(hThreadSnap, &te32)) {
+        RS_CORE_WARN("Thread32First failed with error {0}", GetLastError());
+        CloseHandle(hThreadSnap);
+        return false;
+    }
+
+    // Walk the thread list, keeping those of the given process
+    do {
+        if (te32.th32OwnerProcessID != procId) {
+            continue;
+        }
+
+        ThreadEntry thread;
+        thread.ThreadId = te32.th32ThreadID;
+        thread.Priority = te32.tpBasePri;
+
+        if (HANDLE hThread = OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE, te32.th32ThreadID)) {
+            FILETIME ftCreation, ftExit, ftKernel, ftUser;
+            if (GetThreadTimes(hThread, &ftCreation, &ftExit, &ftKernel, &ftUser)) {
+                const uint64_t kernel = ((uint64_t)ftKernel.dwHighDateTime << 32) | ftKernel.dwLowDateTime;
+                const uint64_t user = ((uint64_t)ftUser.dwHighDateTime << 32) | ftUser.dwLowDateTime;
+                thread.CpuTime = kernel + user;
+            }
+            CloseHandle(hThread);
+        }
+
+        threads.emplace_back(std::move(thread));
+    } while (Thread32Next(hThreadSnap, &te32));
+
+    CloseHandle(hThreadSnap);
+    return true;
+}
+
+#elif defined(RS_PLATFORM_LINUX)
+
+bool ThreadCollector::ReadThreads(const ulong procId, std::vector<ThreadEntry>& threads)
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%lu/task", procId);
+
+    DIR* dir = opendir(path);
+    if (!dir) {
+        return false; // Process exited
+    }
+
+    char buffer[1024];
+    while (const dirent* taskEntry = readdir(dir)) {
+        if (!ProcFS::IsNumeric(taskEntry->d_name)) {
+            continue;
+        }
+
+        snprintf(path, sizeof(path), "/proc/%lu/task/%s/stat", procId, taskEntry->d_name);
+        if (ProcFS::ReadFile(path, buffer, sizeof(buffer)) <= 0) {
+            continue; // Thread exited while walking
+        }
+
+        ThreadEntry thread;
+        thread.ThreadId = std::strtoul(taskEntry->d_name, nullptr, 10);
+
+        // "tid (comm) state ppid ..." -- see proc(5) for the field numbers
+        const char* nameStart = std::strchr(buffer, '(');
+        const char* nameEnd = std::strrchr(buffer, ')');
+        if (nameStart && nameEnd && nameEnd > nameStart) {
+            thread.Name = StringPool::Get().Intern(std::string_view(nameStart + 1, (size_t)(nameEnd - nameStart - 1)));
+        }
+
+        const char* p = ProcFS::SkipComm(buffer);
+        thread.State = *p ? *p : '?';
+
+        uint64_t utime, stime;
+        int64_t priority, processor;
+        p = ProcFS::SkipFields(p, 11); // (3) state .. (13) majflt
+        p = ProcFS::ParseUInt64(p, utime);
+        p = ProcFS::ParseUInt64(p, stime);
+        p = ProcFS::SkipFields(p, 2); // (16) cutime, (17) cstime
+        p = ProcFS::ParseInt64(p, priority);
+        p = ProcFS::SkipFields(p, 20); // (19) nice .. (38) exit_signal
+        ProcFS::ParseInt64(p, processor);
+
+        thread.CpuTime = ProcFS::TicksTo100ns(utime + stime);
+        thread.Priority = (long)priority;
+        thread.LastCpu = (int)processor;
+
+        threads.emplace_back(std::move(thread));
+    }
+
+    closedir(dir);
+    return true;
+}
+
+#else
+
+bool ThreadCollector::ReadThreads(const ulong procId, std::vector<ThreadEntry>& threads)
+{
+    return false;
+}
+
+#endif
+
+}
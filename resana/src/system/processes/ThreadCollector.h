@@ -0,0 +1,60 @@
+#pragma once
+
+#include "helpers/StringPool.h"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace RESANA {
+
+struct ThreadEntry {
+    unsigned long ThreadId {};
+    StringPool::Id Name {};
+    char State = '?';
+    long Priority {};
+    int LastCpu = -1;     // Processor the thread last ran on, -1 if unknown
+    uint64_t CpuTime {};  // Kernel + user time, in 100ns units
+    double CpuLoad {};    // Percent of one logical processor
+};
+
+/*
+ * Collects per-thread records for a small set of watched processes (the
+ * selected one and any expanded in the tree). Enumerating threads is far more
+ * expensive than the process walk, so it only runs for watched processes and
+ * each one is refreshed at most once per refresh interval.
+ */
+class ThreadCollector {
+    typedef unsigned long ulong;
+    typedef std::chrono::steady_clock Clock;
+
+public:
+    void Watch(const std::vector<ulong>& procIds);
+    void SetRefreshInterval(uint32_t interval_ms);
+
+    // Refreshes any watched process whose data is older than the interval
+    void Refresh();
+
+    [[nodiscard]] std::vector<ThreadEntry> GetThreads(ulong procId) const;
+
+    void MarkStrings(StringPool::LiveSet& live) const;
+
+private:
+    struct ThreadList {
+        std::vector<ThreadEntry> Threads {};
+        Clock::time_point LastRefresh {};
+    };
+
+    static bool ReadThreads(ulong procId, std::vector<ThreadEntry>& threads);
+    static void CalcThreadLoad(const std::vector<ThreadEntry>& previous, std::vector<ThreadEntry>& current, double elapsed);
+
+private:
+    mutable std::mutex mMutex {};
+    std::vector<ulong> mWatched {};
+    std::unordered_map<ulong, ThreadList> mThreads {};
+    std::chrono::milliseconds mRefreshInterval { 1000 };
+};
+
+}
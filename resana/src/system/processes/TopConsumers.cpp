@@ -0,0 +1,161 @@
+#include "TopConsumers.h"
+#include "rspch.h"
+
+#include <queue>
+
+namespace RESANA {
+
+void TopConsumers::Set(const ulong procId, const Values& values)
+{
+    std::scoped_lock lock(mMutex);
+
+    const auto it = mIndex.find(procId);
+    if (it == mIndex.end()) {
+        uint32_t slot;
+        if (!mFreeSlots.empty()) {
+            slot = mFreeSlots.back();
+            mFreeSlots.pop_back();
+        } else {
+            slot = (uint32_t)mSlots.size();
+            mSlots.emplace_back();
+        }
+        mIndex.emplace(procId, slot);
+
+        auto& entry = mSlots[slot];
+        entry.ProcessId = procId;
+        entry.Metrics = values;
+        for (int metric = 0; metric < Top_Count; metric++) {
+            auto& heap = mHeaps[metric];
+            entry.Positions[metric] = (uint32_t)heap.size();
+            heap.emplace_back(slot);
+            SiftUp(metric, entry.Positions[metric]);
+        }
+        return;
+    }
+
+    // Most values barely move from one tick to the next; only changed ones are re-sifted
+    auto& entry = mSlots[it->second];
+    for (int metric = 0; metric < Top_Count; metric++) {
+        const double previous = entry.Metrics[metric];
+        if (values[metric] == previous) {
+            continue;
+        }
+
+        entry.Metrics[metric] = values[metric];
+        if (values[metric] > previous) {
+            SiftUp(metric, entry.Positions[metric]);
+        } else {
+            SiftDown(metric, entry.Positions[metric]);
+        }
+    }
+}
+
+void TopConsumers::Remove(const ulong procId)
+{
+    std::scoped_lock lock(mMutex);
+
+    const auto it = mIndex.find(procId);
+    if (it == mIndex.end()) {
+        return;
+    }
+    const uint32_t slot = it->second;
+    mIndex.erase(it);
+
+    // Move the last node into the hole, then restore the heap from there
+    for (int metric = 0; metric < Top_Count; metric++) {
+        auto& heap = mHeaps[metric];
+        const uint32_t position = mSlots[slot].Positions[metric];
+        const uint32_t last = (uint32_t)heap.size() - 1;
+        if (position != last) {
+            Swap(metric, position, last);
+            heap.pop_back();
+            SiftUp(metric, position);
+            SiftDown(metric, position);
+        } else {
+            heap.pop_back();
+        }
+    }
+    mFreeSlots.emplace_back(slot);
+}
+
+std::vector<TopEntry> TopConsumers::Get(const TopMetric metric, const size_t k) const
+{
+    std::scoped_lock lock(mMutex);
+
+    std::vector<TopEntry> top;
+    const auto& heap = mHeaps[metric];
+    if (heap.empty() || k == 0) {
+        return top;
+    }
+    top.reserve(k);
+
+    // The next largest value is always a child of one already taken
+    const auto less = [&](const uint32_t a, const uint32_t b) {
+        return GetValue(metric, a) < GetValue(metric, b);
+    };
+    std::priority_queue<uint32_t, std::vector<uint32_t>, decltype(less)> frontier(less);
+    frontier.push(0);
+
+    while (!frontier.empty() && top.size() < k) {
+        const uint32_t position = frontier.top();
+        frontier.pop();
+
+        const double value = GetValue(metric, position);
+        if (value <= 0.0) {
+            break; // Everything below is zero too
+        }
+        top.push_back({ mSlots[heap[position]].ProcessId, value });
+
+        for (const uint32_t child : { position * 2 + 1, position * 2 + 2 }) {
+            if (child < heap.size()) {
+                frontier.push(child);
+            }
+        }
+    }
+    return top;
+}
+
+void TopConsumers::SiftUp(const int metric, uint32_t position)
+{
+    while (position > 0) {
+        const uint32_t parent = (position - 1) / 2;
+        if (GetValue(metric, parent) >= GetValue(metric, position)) {
+            break;
+        }
+        Swap(metric, parent, position);
+        position = parent;
+    }
+}
+
+void TopConsumers::SiftDown(const int metric, uint32_t position)
+{
+    const uint32_t size = (uint32_t)mHeaps[metric].size();
+    while (true) {
+        uint32_t largest = position;
+        for (const uint32_t child : { position * 2 + 1, position * 2 + 2 }) {
+            if (child < size && GetValue(metric, child) > GetValue(metric, largest)) {
+                largest = child;
+            }
+        }
+        if (largest == position) {
+            break;
+        }
+        Swap(metric, position, largest);
+        position = largest;
+    }
+}
+
+void TopConsumers::Swap(const int metric, const uint32_t a, const uint32_t b)
+{
+    auto& heap = mHeaps[metric];
+    std::swap(heap[a], heap[b]);
+    mSlots[heap[a]].Positions[metric] = a;
+    mSlots[heap[b]].Positions[metric] = b;
+}
+
+double TopConsumers::GetValue(const int metric, const uint32_t position) const
+{
+    return mSlots[mHeaps[metric][position]].Metrics[metric];
+}
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace RESANA {
+
+enum TopMetric {
+    Top_Cpu = 0,
+    Top_Memory,
+    Top_DiskRead,
+    Top_DiskWrite,
+    Top_Count
+};
+
+struct TopEntry {
+    unsigned long ProcessId {};
+    double Value {};
+};
+
+/*
+ * Keeps every process ranked by each metric as the scan updates it, so the
+ * largest consumers can be read in O(K log K) without sorting the table.
+ * Each metric is an indexed max-heap: a changed value moves its node up or
+ * down in O(log n), an unchanged one costs a comparison, and the top K are
+ * read by walking the heap best-first from the root.
+ */
+class TopConsumers {
+    typedef unsigned long ulong;
+    typedef std::array<double, Top_Count> Values;
+
+public:
+    // Adds the process or updates its values
+    void Set(ulong procId, const Values& values);
+    void Remove(ulong procId);
+
+    // The k largest, in descending order; processes at zero are left out
+    [[nodiscard]] std::vector<TopEntry> Get(TopMetric metric, size_t k) const;
+
+private:
+    struct Slot {
+        ulong ProcessId {};
+        Values Metrics {};
+        std::array<uint32_t, Top_Count> Positions {}; // Of the slot in each heap
+    };
+
+    void SiftUp(int metric, uint32_t position);
+    void SiftDown(int metric, uint32_t position);
+    void Swap(int metric, uint32_t a, uint32_t b);
+    [[nodiscard]] double GetValue(int metric, uint32_t position) const;
+
+private:
+    mutable std::mutex mMutex {};
+    std::vector<Slot> mSlots {};
+    std::vector<uint32_t> mFreeSlots {};
+    std::unordered_map<ulong, uint32_t> mIndex {};
+    std::array<std::vector<uint32_t>, Top_Count> mHeaps {}; // Slots, largest value at the front
+};
+
+}
@@ -0,0 +1,278 @@
+#include "rspch.h"
+#include "SchedulerCollector.h"
+
+#include "core/Core.h"
+#include "helpers/ProcFS.h"
+
+#include <limits>
+
+#if defined(RS_PLATFORM_LINUX)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace RESANA {
+
+	std::mutex SchedulerCollector::sStatMutex;
+	SchedulerCollector::StatSample SchedulerCollector::sSharedStat;
+
+	namespace
+	{
+		constexpr const char* SOFTIRQ_NAMES[SoftirqType_Count] = {
+			"HI", "TIMER", "NET_TX", "NET_RX", "BLOCK", "IRQ_POLL", "TASKLET", "SCHED", "HRTIMER", "RCU"
+		};
+
+		// Matches "name" at p against a prefix followed by a space
+		bool StartsWith(const char* p, const char* name, const size_t length)
+		{
+			return std::strncmp(p, name, length) == 0 && p[length] == ' ';
+		}
+	}
+
+	SchedulerStats SchedulerCollector::GetStats() const
+	{
+		std::scoped_lock lock(mMutex);
+		return mStats;
+	}
+
+	size_t SchedulerCollector::GetCpuSoftirqs(std::vector<double>& rates) const
+	{
+		std::scoped_lock lock(mMutex);
+		rates.assign(mSoftirqRates.begin(), mSoftirqRates.end());
+		return mSoftirqCpus;
+	}
+
+	const char* SchedulerCollector::GetName(const SoftirqType type)
+	{
+		return SOFTIRQ_NAMES[type];
+	}
+
+	void SchedulerCollector::ShareStat(const char* lines, const std::chrono::steady_clock::time_point time)
+	{
+		StatSample stat;
+		ParseStat(lines, stat);
+		stat.Time = time;
+
+		std::scoped_lock lock(sStatMutex);
+		sSharedStat = stat;
+	}
+
+	void SchedulerCollector::Sample()
+	{
+		const auto now = std::chrono::steady_clock::now();
+		const double elapsed = std::chrono::duration<double>(now - mLastSample).count();
+		mLastSample = now;
+
+		StatSample stat;
+		{
+			std::scoped_lock lock(sStatMutex);
+			stat = sSharedStat;
+		}
+		if (now - stat.Time > std::chrono::milliseconds(STAT_MAX_AGE))
+		{
+			if (!Read(File_Stat)) { return; }
+			stat = {};
+			ParseStat(mBuffers[File_Stat].data(), stat);
+			stat.Time = now;
+		}
+
+		SchedulerStats stats;
+		stats.Running = stat.Running;
+		stats.Blocked = stat.Blocked;
+
+		auto& softirqs = mSoftirqCounters[mCurrent ^ 1];
+		const auto& lastSoftirqs = mSoftirqCounters[mCurrent];
+		size_t cpus = 0;
+		if (Read(File_Softirqs)) {
+			ParseSoftirqs(softirqs, cpus);
+		}
+		if (Read(File_LoadAverage)) {
+			ParseLoadAverage(stats);
+		}
+
+		// The first sample only sets the baseline, and counters never run backwards short of a wrap
+		const bool hasRates = mHasSample && elapsed > 0.0;
+		const auto rate = [](const uint64_t current, const uint64_t last, const double seconds) {
+			return current >= last ? (double)(current - last) / seconds : 0.0;
+		};
+
+		std::scoped_lock lock(mMutex);
+
+		// /proc/stat rates run from read to read, and carry over while no new read has come
+		const double statElapsed = std::chrono::duration<double>(stat.Time - mLastStat.Time).count();
+		if (stat.Time == mLastStat.Time)
+		{
+			stats.ContextSwitches = mStats.ContextSwitches;
+			stats.Interrupts = mStats.Interrupts;
+			stats.Forks = mStats.Forks;
+		}
+		else
+		{
+			mHasStatRates = mLastStat.Time != std::chrono::steady_clock::time_point{} && statElapsed > 0.0;
+			if (mHasStatRates)
+			{
+				stats.ContextSwitches = rate(stat.ContextSwitches, mLastStat.ContextSwitches, statElapsed);
+				stats.Interrupts = rate(stat.Interrupts, mLastStat.Interrupts, statElapsed);
+				stats.Forks = rate(stat.Forks, mLastStat.Forks, statElapsed);
+			}
+			mLastStat = stat;
+		}
+
+		// Rates need both samples to cover the same CPUs; the scratch only grows on hotplug
+		const size_t values = cpus * SoftirqType_Count;
+		mSoftirqRates.resize(values);
+		const bool hasSoftirqs = hasRates && lastSoftirqs.size() == values;
+		for (size_t i = 0; i < values; i++)
+		{
+			mSoftirqRates[i] = hasSoftirqs ? rate(softirqs[i], lastSoftirqs[i], elapsed) : 0.0;
+			stats.Softirqs[i % SoftirqType_Count] += mSoftirqRates[i];
+		}
+		mSoftirqCpus = cpus;
+
+		stats.Available = true;
+		mStats = stats;
+		mCurrent ^= 1;
+		mHasSample = true;
+
+		constexpr float none = std::numeric_limits<float>::quiet_NaN();
+		const float history[SchedulerSeries_Count] = {
+			mHasStatRates ? (float)stats.ContextSwitches : none, mHasStatRates ? (float)stats.Interrupts : none,
+			(float)stats.Running, (float)stats.Blocked
+		};
+		mHistory.Append(MetricHistory::Clock::now(), history);
+	}
+
+	bool SchedulerCollector::Read(const File file)
+	{
+		if (mFiles[file] < 0) { return false; }
+
+		// A full buffer may have cut the file short, after CPUs or interrupts were added; grow and read again
+		auto& buffer = mBuffers[file];
+		long length = ProcFS::ReadFile(mFiles[file], buffer.data(), buffer.size());
+		while (length == (long)buffer.size() - 1)
+		{
+			buffer.resize(buffer.size() * 2);
+			length = ProcFS::ReadFile(mFiles[file], buffer.data(), buffer.size());
+		}
+
+		return length > 0;
+	}
+
+	void SchedulerCollector::ParseStat(const char* lines, StatSample& stat)
+	{
+		// The "cpu" lines are the CPU sampler's; of "intr" and "softirq" only the leading total is read
+		uint64_t value = 0;
+		for (const char* line = lines; *line; line = ProcFS::NextLine(line))
+		{
+			if (line[0] == 'c' && line[1] == 'p' && line[2] == 'u') { continue; }
+
+			if (StartsWith(line, "ctxt", 4)) {
+				ProcFS::ParseUInt64(line + 4, stat.ContextSwitches);
+			} else if (StartsWith(line, "intr", 4)) {
+				ProcFS::ParseUInt64(line + 4, stat.Interrupts);
+			} else if (StartsWith(line, "processes", 9)) {
+				ProcFS::ParseUInt64(line + 9, stat.Forks);
+			} else if (StartsWith(line, "procs_running", 13)) {
+				ProcFS::ParseUInt64(line + 13, value);
+				stat.Running = (uint32_t)value;
+			} else if (StartsWith(line, "procs_blocked", 13)) {
+				ProcFS::ParseUInt64(line + 13, value);
+				stat.Blocked = (uint32_t)value;
+			}
+		}
+	}
+
+	void SchedulerCollector::ParseSoftirqs(std::vector<uint64_t>& counters, size_t& cpus) const
+	{
+		// A header of "CPU0 CPU1 ...", then one row per softirq with a count for each CPU
+		const char* line = mBuffers[File_Softirqs].data();
+		cpus = 0;
+		for (const char* p = ProcFS::SkipSpaces(line); *p && *p != '\n'; p = ProcFS::SkipFields(p, 1)) {
+			cpus++;
+		}
+
+		counters.resize(cpus * SoftirqType_Count);
+		std::fill(counters.begin(), counters.end(), 0);
+		for (line = ProcFS::NextLine(line); *line; line = ProcFS::NextLine(line))
+		{
+			const char* name = ProcFS::SkipSpaces(line);
+			const char* colon = name;
+			while (*colon && *colon != ':' && *colon != '\n') { ++colon; }
+			if (*colon != ':') { continue; }
+
+			// BLOCK_IOPOLL was renamed IRQ_POLL in Linux 4.5
+			const size_t length = (size_t)(colon - name);
+			int type = 0;
+			while (type < SoftirqType_Count && (std::strlen(SOFTIRQ_NAMES[type]) != length || std::strncmp(name, SOFTIRQ_NAMES[type], length) != 0)) {
+				type++;
+			}
+			if (type == SoftirqType_Count && length == 12 && std::strncmp(name, "BLOCK_IOPOLL", 12) == 0) {
+				type = SoftirqType_IrqPoll;
+			}
+			if (type == SoftirqType_Count) { continue; }
+
+			const char* p = colon + 1;
+			for (size_t cpu = 0; cpu < cpus; cpu++)
+			{
+				p = ProcFS::SkipSpaces(p);
+				if (*p < '0' || *p > '9') { break; }
+				p = ProcFS::ParseUInt64(p, counters[cpu * SoftirqType_Count + type]);
+			}
+		}
+	}
+
+	void SchedulerCollector::ParseLoadAverage(SchedulerStats& stats) const
+	{
+		// "0.52 0.58 0.59 3/1204 12345": averages, runnable/total entities, last PID
+		unsigned runnable = 0, threads = 0;
+		if (sscanf(mBuffers[File_LoadAverage].data(), "%f %f %f %u/%u", &stats.LoadAverage[0], &stats.LoadAverage[1], &stats.LoadAverage[2], &runnable, &threads) == 5) {
+			stats.Threads = threads;
+		}
+	}
+
+#if defined(RS_PLATFORM_LINUX)
+
+	SchedulerCollector::SchedulerCollector()
+		: SampledCollector("Scheduler", Subsystem_Scheduler, SAMPLE_INTERVAL)
+	{
+		const long configured = sysconf(_SC_NPROCESSORS_CONF);
+		const size_t cores = configured > 0 ? (size_t)configured : 1;
+
+		// Sized like the CPU sampler's; softirqs take up to eleven columns per CPU on each of their rows
+		const char* paths[File_Count] = { "/proc/stat", "/proc/softirqs", "/proc/loadavg" };
+		const size_t sizes[File_Count] = { cores * 256 + 64 * 1024, (cores * 12 + 32) * (SoftirqType_Count + 2), 256 };
+		for (int file = 0; file < File_Count; file++)
+		{
+			mFiles[file] = open(paths[file], O_RDONLY | O_CLOEXEC);
+			mBuffers[file].resize(sizes[file]);
+		}
+
+		if (!IsAvailable()) {
+			RS_CORE_WARN("Failed to open /proc/stat, scheduler activity is not available");
+		}
+	}
+
+	SchedulerCollector::~SchedulerCollector()
+	{
+		for (const int fd : mFiles) {
+			if (fd >= 0) {
+				close(fd);
+			}
+		}
+	}
+
+#else
+
+	SchedulerCollector::SchedulerCollector()
+		: SampledCollector("Scheduler", Subsystem_Scheduler, SAMPLE_INTERVAL)
+	{
+		// No /proc; every file stays closed and the collector unavailable
+	}
+
+	SchedulerCollector::~SchedulerCollector()
+	{
+	}
+
+#endif
+
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "helpers/MetricHistory.h"
+#include "system/SampledCollector.h"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace RESANA {
+
+	// Rows of /proc/softirqs, in the kernel's order
+	enum SoftirqType
+	{
+		SoftirqType_Hi = 0,
+		SoftirqType_Timer,
+		SoftirqType_NetTx,
+		SoftirqType_NetRx,
+		SoftirqType_Block,
+		SoftirqType_IrqPoll,
+		SoftirqType_Tasklet,
+		SoftirqType_Sched,
+		SoftirqType_HrTimer,
+		SoftirqType_Rcu,
+		SoftirqType_Count
+	};
+
+	enum SchedulerSeries
+	{
+		SchedulerSeries_ContextSwitches = 0,
+		SchedulerSeries_Interrupts,
+		SchedulerSeries_Running,
+		SchedulerSeries_Blocked,
+		SchedulerSeries_Count
+	};
+
+	struct SchedulerStats
+	{
+		// Per second, over the last sample interval
+		double ContextSwitches{};
+		double Interrupts{};
+		double Forks{};
+		double Softirqs[SoftirqType_Count]{}; // Summed over all CPUs
+
+		uint32_t Running{};           // Tasks on a run queue right now
+		uint32_t Blocked{};           // Tasks waiting on I/O
+		float LoadAverage[3]{};       // 1, 5 and 15 minutes
+		uint32_t Threads{};           // Scheduling entities in the system
+
+		bool Available = false;
+	};
+
+	/*
+	 * Scheduler activity from /proc/stat, /proc/softirqs and /proc/loadavg:
+	 * context switch, interrupt, fork and softirq rates, and the run and I/O
+	 * wait queues. Each file is kept open and read once per SAMPLE_INTERVAL into
+	 * a buffer sized at startup, and parsed in place. /proc/stat is read by the
+	 * CPU sampler anyway, which hands its reads over through ShareStat; the file
+	 * is only read here when the sampler hasn't for STAT_MAX_AGE. Softirqs are
+	 * also kept per CPU, so a NET_RX or TIMER storm pinned to one core stands out.
+	 */
+	class SchedulerCollector : public SampledCollector<SchedulerCollector> {
+	public:
+		[[nodiscard]] bool IsAvailable() const { return mFiles[File_Stat] >= 0; }
+
+		[[nodiscard]] SchedulerStats GetStats() const;
+
+		// Per second softirq rates, CPU-major with SoftirqType_Count per CPU; returns the CPU count
+		size_t GetCpuSoftirqs(std::vector<double>& rates) const;
+
+		[[nodiscard]] const MetricHistory& GetHistory() const { return mHistory; }
+
+		static const char* GetName(SoftirqType type);
+
+		// Takes the lines after the "cpu" lines of a /proc/stat read at the given time
+		static void ShareStat(const char* lines, std::chrono::steady_clock::time_point time);
+
+	public:
+		static constexpr uint32_t SAMPLE_INTERVAL = 1000;
+		static constexpr uint32_t STAT_MAX_AGE = 2500; // Past the slowest CPU sampling interval
+
+	private:
+		enum File
+		{
+			File_Stat = 0,
+			File_Softirqs,
+			File_LoadAverage,
+			File_Count
+		};
+
+		// The scheduler lines of one /proc/stat read; counters are cumulative
+		struct StatSample
+		{
+			uint64_t ContextSwitches{};
+			uint64_t Interrupts{};
+			uint64_t Forks{};
+			uint32_t Running{};
+			uint32_t Blocked{};
+			std::chrono::steady_clock::time_point Time{}; // Of the read; unset before the first
+		};
+
+		friend class SampledCollector<SchedulerCollector>;
+
+		SchedulerCollector();
+		~SchedulerCollector() override;
+
+		[[nodiscard]] bool IsWanted() const override { return IsAvailable(); }
+		void Sample() override;
+		bool Read(File file);
+		static void ParseStat(const char* lines, StatSample& stat);
+		void ParseSoftirqs(std::vector<uint64_t>& counters, size_t& cpus) const;
+		void ParseLoadAverage(SchedulerStats& stats) const;
+
+	private:
+		int mFiles[File_Count]{ -1, -1, -1 };
+		std::vector<char> mBuffers[File_Count]{};
+
+		// Only touched by the collecting thread
+		std::chrono::steady_clock::time_point mLastSample{};
+		StatSample mLastStat{};
+		std::vector<uint64_t> mSoftirqCounters[2]{};
+		int mCurrent = 0;
+		bool mHasSample = false;
+		bool mHasStatRates = false;
+
+		mutable std::mutex mMutex{};
+		SchedulerStats mStats{};
+		std::vector<double> mSoftirqRates{};
+		size_t mSoftirqCpus = 0;
+		MetricHistory mHistory{ SchedulerSeries_Count };
+
+		// The CPU sampler's latest read, kept whether or not the collector exists
+		static std::mutex sStatMutex;
+		static StatSample sSharedStat;
+	};
+
+}